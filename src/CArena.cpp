@@ -0,0 +1,255 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "CArena.h"
+
+///! Size of one chunk, bigger blocks get their own chunk
+#define ARENA_CHUNK_SIZE (1024 * 1024)
+///! All blocks are aligned to this size
+#define ARENA_ALIGNMENT 16
+///! Blocks up to this size have a class for every multiple of the alignment (2^ARENA_SMALL_POWER)
+#define ARENA_SMALL_SIZE 512
+#define ARENA_SMALL_POWER 9
+///! Count of the classes of small blocks
+#define ARENA_SMALL_CLASSES (ARENA_SMALL_SIZE / ARENA_ALIGNMENT)
+///! Bigger blocks have this count of classes between two powers of two
+#define ARENA_CLASS_STEPS 4
+
+using namespace std;
+
+/********************* TOOLS *******************************/
+
+/*! Rounds the size up to the alignment.
+ * \param size The size.
+ */
+static size_t Align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+/*! Gets the class of the block and rounds its size up to the size of the class, so the freed block
+ * goes back to the same class. Small blocks are rounded to the alignment, bigger ones to a quarter
+ * of their power of two (they lose 25 % at most).
+ * \param size Size of the block, it is changed to the size of the class.
+ * \return Index of the class, classes from ARENA_CLASSES on have no free list.
+ */
+static int GetClass(size_t & size) {
+    if (size <= ARENA_SMALL_SIZE) {
+        size = Align(size ? size : 1);
+        return size / ARENA_ALIGNMENT - 1;
+    }
+    //the size is in (2^power, 2^(power + 1)]
+    int power = 63 - __builtin_clzll(size - 1);
+    size_t step = (size_t) 1 << (power - 2);
+    size_t steps = (size + step - 1) / step;
+    size = steps * step;
+    return ARENA_SMALL_CLASSES + (power - ARENA_SMALL_POWER) * ARENA_CLASS_STEPS + (int) steps - ARENA_CLASS_STEPS - 1;
+}
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty arena, first chunk is allocated with first block.
+ */
+CArena::CArena() {
+    m_chunks = NULL;
+    m_pos = m_end = NULL;
+    for (int i = 0; i < ARENA_CLASSES; i++)
+        m_free[i] = NULL;
+    m_child = NULL;
+    m_next = NULL;
+    m_parent = NULL;
+    m_atoms = NULL;
+    m_index = NULL;
+    m_image = NULL;
+}
+
+/*! Returns all the chunks (and arenas of other threads), no destructors are called.
+ */
+CArena::~CArena() {
+    while (m_chunks) {
+        TChunk * next = m_chunks->m_next;
+        free(m_chunks);
+        m_chunks = next;
+    }
+    while (m_child) {
+        CArena * next = m_child->m_next;
+        delete m_child;
+        m_child = next;
+    }
+}
+
+/*! Allocates a block, freed block of its class is used first.
+ * \param size Size of the block.
+ * \return Pointer to the block (aligned).
+ */
+void * CArena::Alloc(size_t size) {
+    int c = GetClass(size);
+    if (c < ARENA_CLASSES && m_free[c]) {
+        void * p = m_free[c];
+        m_free[c] = *(void **) p;
+        return p;
+    }
+
+    //big blocks get their own chunk
+    size_t header = Align(sizeof (TChunk));
+    if (size > ARENA_CHUNK_SIZE / 4)
+        return (char *) NewChunk(header + size) + header;
+
+    if ((size_t) (m_end - m_pos) < size) {
+        m_pos = (char *) NewChunk(ARENA_CHUNK_SIZE) + header;
+        m_end = m_pos + ARENA_CHUNK_SIZE - header;
+    }
+    void * p = m_pos;
+    m_pos += size;
+    return p;
+}
+
+/*! Gives the block back to the arena, it will be used by next allocations of its class.
+ * The block may come from other arena of the document (they are deleted together).
+ * \param p Pointer to the block.
+ * \param size Size used for allocating the block.
+ */
+void CArena::Free(void * p, size_t size) {
+    if (p == NULL)
+        return;
+    int c = GetClass(size);
+    if (c < ARENA_CLASSES) {
+        *(void **) p = m_free[c];
+        m_free[c] = p;
+    }
+}
+
+/*! Stores the text, so it lives as long as the arena. Texts pointing to the file are not copied.
+ * \param text The text.
+ * \return Text pointing to the file or to the arena.
+ */
+CText CArena::Store(const CText & text) {
+    if (text.IsView())
+        return text;
+    return Copy(text);
+}
+
+/*! Copies the text to the arena, also if it points to the data (which do not stay).
+ * \param text The text.
+ * \return Text pointing to the arena, it is marked as stored, so it can be released.
+ */
+CText CArena::Copy(const CText & text) {
+    if (text.GetLength() == 0)
+        return CText();
+
+    char * data = (char *) Alloc(text.GetLength());
+    memcpy(data, text.GetData(), text.GetLength());
+    CText stored(data, text.GetLength());
+    stored.SetStored();
+    return stored;
+}
+
+/*! Gives the memory of stored text back, if it was copied to an arena of the document.
+ * \param text The text.
+ */
+void CArena::Release(const CText & text) {
+    if (text.IsStored())
+        Free((void *) text.GetData(), text.GetLength());
+}
+
+/*! Allocates memory for an object, which can be freed without knowing its arena.
+ * \param size Size of the object.
+ * \return Pointer to the memory for the object.
+ */
+void * CArena::AllocObject(size_t size) {
+    size += sizeof (TObject);
+    TObject * header = (TObject *) Alloc(size);
+    header->m_arena = this;
+    header->m_size = size;
+    return header + 1;
+}
+
+/*! Frees the object allocated by AllocObject.
+ * \param p Pointer to the object.
+ */
+void CArena::FreeObject(void * p) {
+    if (p == NULL)
+        return;
+    TObject * header = (TObject *) p - 1;
+    header->m_arena->Free(header, header->m_size);
+}
+
+/*! Gets the arena of the object allocated by AllocObject.
+ * \param p Pointer to the object.
+ */
+CArena * CArena::GetOwner(const void * p) {
+    return ((const TObject *) p - 1)->m_arena;
+}
+
+/*! Creates new arena, which can be used by other thread. It shares the names and the titles index
+ * of this arena, but it is deleted by the caller, until it is added by AddChild.
+ * \return Pointer to the new arena.
+ */
+CArena * CArena::CreateChild() {
+    CArena * child = new CArena();
+    child->m_parent = this;
+    return child;
+}
+
+/*! Links the arena created by CreateChild, so it is deleted together with this arena.
+ * \param child Pointer to the arena.
+ */
+void CArena::AddChild(CArena * child) {
+    child->m_next = m_child;
+    m_child = child;
+}
+
+/*! Sets the names of the document, they are not deleted by the arena.
+ * \param atoms Pointer to the atom table.
+ */
+void CArena::SetAtoms(CAtomTable * atoms) {
+    m_atoms = atoms;
+}
+
+/*! Gets the names of the document.
+ */
+CAtomTable * CArena::GetAtoms() const {
+    return m_parent ? m_parent->m_atoms : m_atoms;
+}
+
+/*! Sets the titles index of the document, it is not deleted by the arena.
+ * \param index Pointer to the index, NULL if the document is not indexed.
+ */
+void CArena::SetIndex(CTitleIndex * index) {
+    m_index = index;
+}
+
+/*! Gets the titles index of the document, NULL if the document is not indexed.
+ */
+CTitleIndex * CArena::GetIndex() const {
+    return m_parent ? m_parent->m_index : m_index;
+}
+
+/*! Sets the image of the document, from which unparsed childs are built.
+ * \param image Pointer to the reader of the image.
+ */
+void CArena::SetImage(CImageReader * image) {
+    m_image = image;
+}
+
+/*! Gets the image of the document (of the parent arena).
+ */
+CImageReader * CArena::GetImage() const {
+    return m_parent ? m_parent->m_image : m_image;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Allocates new chunk and inserts it to the list.
+ * \param size Size of the chunk.
+ * \return Pointer to the chunk.
+ */
+CArena::TChunk * CArena::NewChunk(size_t size) {
+    TChunk * chunk = (TChunk *) malloc(size);
+    if (chunk == NULL)
+        throw bad_alloc();
+    chunk->m_size = size;
+    chunk->m_next = m_chunks;
+    m_chunks = chunk;
+    return chunk;
+}
@@ -0,0 +1,92 @@
+#ifndef CARENA_H
+#define	CARENA_H
+
+#include <cstdlib>
+
+#include "CText.h"
+#include "CAtomTable.h"
+
+class CTitleIndex;
+class CImageReader;
+
+using namespace std;
+
+///! Count of free lists (classes of block sizes, see CArena.cpp)
+#define ARENA_CLASSES 248
+
+///! Class, which allocates memory of one document from big chunks. Every block is rounded up to the size
+///! of its class and freed blocks are kept in the free list of the class for next allocations of the same class.
+///! All the memory is returned at once, when the arena is deleted.
+
+class CArena {
+public:
+    CArena();
+    ~CArena();
+
+    //raw memory
+    void * Alloc(size_t size);
+    void Free(void * p, size_t size);
+
+    //texts
+    CText Store(const CText & text);
+    CText Copy(const CText & text);
+    void Release(const CText & text);
+
+    //objects knowing their arena
+    void * AllocObject(size_t size);
+    static void FreeObject(void * p);
+    static CArena * GetOwner(const void * p);
+
+    CArena * CreateChild();
+    void AddChild(CArena * child);
+
+    //names and titles index of the document
+    void SetAtoms(CAtomTable * atoms);
+    CAtomTable * GetAtoms() const;
+    void SetIndex(CTitleIndex * index);
+    CTitleIndex * GetIndex() const;
+    void SetImage(CImageReader * image);
+    CImageReader * GetImage() const;
+protected:
+    ///! Structure at the start of every chunk.
+    struct TChunk {
+        ///! Pointer to the next chunk
+        TChunk * m_next;
+        ///! Size of the chunk (with this structure)
+        size_t m_size;
+    };
+
+    TChunk * NewChunk(size_t size);
+
+    ///! Structure in front of every object, so it can be freed by delete.
+    struct TObject {
+        ///! Pointer to the arena of the object
+        CArena * m_arena;
+        ///! Size of the object (with this structure)
+        size_t m_size;
+    };
+
+    ///! List of all chunks
+    TChunk * m_chunks;
+    ///! Free space in the current chunk
+    char * m_pos;
+    ///! End of the current chunk
+    char * m_end;
+    ///! Free lists of freed blocks, index is the power of two of the block size
+    void * m_free[ARENA_CLASSES];
+    ///! Names of the document, objects of the arena find them here
+    CAtomTable * m_atoms;
+    ///! Titles index of the document, objects of the arena keep it up to date
+    CTitleIndex * m_index;
+    ///! Image of the document, unparsed childs are built from it (NULL if there is none)
+    CImageReader * m_image;
+    ///! Arena, which created this arena (NULL for the arena of the document)
+    CArena * m_parent;
+    ///! List of arenas created for other threads
+    CArena * m_child;
+    ///! Next arena in the list of the parent
+    CArena * m_next;
+};
+
+#endif	/* CARENA_H */
+
@@ -0,0 +1,155 @@
+#include <cstdlib>
+
+#include "CAtomTable.h"
+
+///! Default count of atoms
+#define DEFAULT_ATOMS_SIZE 64
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty table.
+ */
+CAtomTable::CAtomTable() {
+    m_names = new CText [DEFAULT_ATOMS_SIZE];
+    m_hashes = new unsigned int [DEFAULT_ATOMS_SIZE];
+    m_size = DEFAULT_ATOMS_SIZE;
+    m_cnt = 0;
+
+    //slots are kept at most half full
+    m_cntSlots = DEFAULT_ATOMS_SIZE * 2;
+    m_slots = new int [m_cntSlots];
+    for (int i = 0; i < m_cntSlots; i++)
+        m_slots[i] = -1;
+    pthread_mutex_init(&m_lock, NULL);
+}
+
+/*! Deallocates the table.
+ */
+CAtomTable::~CAtomTable() {
+    delete [] m_names;
+    delete [] m_hashes;
+    delete [] m_slots;
+    pthread_mutex_destroy(&m_lock);
+}
+
+/*! Gets the atom of the name, new names get new atom.
+ * \param name The name (it is copied).
+ * \return The atom.
+ */
+int CAtomTable::Add(const CText & name) {
+    unsigned int hash = Hash(name.GetData(), name.GetLength());
+    pthread_mutex_lock(&m_lock);
+    int slot = FindSlot(name.GetData(), name.GetLength(), hash);
+    int atom = m_slots[slot];
+    if (atom < 0) {
+        ReallocAtoms();
+        m_names[m_cnt] = CText(name.GetString());
+        m_hashes[m_cnt] = hash;
+        m_slots[slot] = atom = m_cnt++;
+        if (m_cnt * 2 > m_cntSlots)
+            Rehash();
+    }
+    pthread_mutex_unlock(&m_lock);
+    return atom;
+}
+
+/*! Finds the atom of the name.
+ * \param name The name.
+ * \return The atom, -1 if the name has no atom.
+ */
+int CAtomTable::Find(const CText & name) const {
+    return m_slots[FindSlot(name.GetData(), name.GetLength(), Hash(name.GetData(), name.GetLength()))];
+}
+
+/*! Finds the atom of the name.
+ * \param name The name.
+ * \return The atom, -1 if the name has no atom.
+ */
+int CAtomTable::Find(const string & name) const {
+    return m_slots[FindSlot(name.data(), name.length(), Hash(name.data(), name.length()))];
+}
+
+/*! Gets the name of the atom.
+ * \param atom The atom.
+ */
+const CText & CAtomTable::Get(int atom) const {
+    return m_names[atom];
+}
+
+/*! Gets the count of atoms.
+ */
+int CAtomTable::GetCount() const {
+    return m_cnt;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Counts the FNV-1a hash of the characters.
+ * \param data Pointer to the characters.
+ * \param length Count of characters.
+ */
+unsigned int CAtomTable::Hash(const char * data, size_t length) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*! Finds the slot of the name, or the free slot, where it belongs.
+ * \param data Pointer to the name.
+ * \param length Length of the name.
+ * \param hash Hash of the name.
+ * \return Index of the slot.
+ */
+int CAtomTable::FindSlot(const char * data, size_t length, unsigned int hash) const {
+    int slot = hash & (m_cntSlots - 1);
+    while (m_slots[slot] >= 0) {
+        int atom = m_slots[slot];
+        if (m_hashes[atom] == hash && m_names[atom].Compare(data, length) == 0)
+            break;
+        slot = (slot + 1) & (m_cntSlots - 1);
+    }
+    return slot;
+}
+
+/*! Atoms memory management.
+ */
+void CAtomTable::ReallocAtoms() {
+    if (m_cnt >= m_size) {
+        CText * tmp = new CText [m_size * REALLOC_CONSTANT];
+        unsigned int * tmpHashes = new unsigned int [m_size * REALLOC_CONSTANT];
+        for (int i = 0; i < m_cnt; i++) {
+            tmp[i] = m_names[i];
+            tmpHashes[i] = m_hashes[i];
+        }
+
+        delete [] m_names;
+        delete [] m_hashes;
+        m_names = tmp;
+        m_hashes = tmpHashes;
+        m_size *= REALLOC_CONSTANT;
+    }
+}
+
+/*! Makes the hash table bigger and inserts all the atoms again.
+ */
+void CAtomTable::Rehash() {
+    delete [] m_slots;
+    m_cntSlots *= REALLOC_CONSTANT;
+    m_slots = new int [m_cntSlots];
+    for (int i = 0; i < m_cntSlots; i++)
+        m_slots[i] = -1;
+
+    for (int atom = 0; atom < m_cnt; atom++) {
+        int slot = m_hashes[atom] & (m_cntSlots - 1);
+        while (m_slots[slot] >= 0)
+            slot = (slot + 1) & (m_cntSlots - 1);
+        m_slots[slot] = atom;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CATOMTABLE_H
+#define	CATOMTABLE_H
+
+#include <cstdlib>
+#include <string>
+#include <pthread.h>
+
+#include "CText.h"
+
+using namespace std;
+
+///! Class, which gives small integer ids (atoms) to names, same names get the same id.
+///! Add can be called by more threads at once, other methods must not run at the same time with it.
+
+class CAtomTable {
+public:
+    CAtomTable();
+    ~CAtomTable();
+
+    int Add(const CText & name);
+    int Find(const CText & name) const;
+    int Find(const string & name) const;
+    const CText & Get(int atom) const;
+    int GetCount() const;
+protected:
+    static unsigned int Hash(const char * data, size_t length);
+    int FindSlot(const char * data, size_t length, unsigned int hash) const;
+    void ReallocAtoms();
+    void Rehash();
+
+    ///! Array of names, index is the atom (names are own copies)
+    CText * m_names;
+    ///! Hashes of the names
+    unsigned int * m_hashes;
+    ///! Count of atoms
+    int m_cnt;
+    ///! Current max count of atoms
+    int m_size;
+    ///! Hash table of atoms (-1 is a free slot), its size is a power of two
+    int * m_slots;
+    ///! Count of slots
+    int m_cntSlots;
+    ///! Lock of adding
+    pthread_mutex_t m_lock;
+};
+
+#endif	/* CATOMTABLE_H */
+
@@ -13,48 +13,86 @@ using namespace std;
  * \param name Name of the attribute.
  * \param value Value of the attribute.
  */
-CAttribute::CAttribute(string & name, string & value) {
-    if (IsValidTitle(name))
-        m_name = new string(name);
-    else
-        throw InvalidXMLTitleException(name);
-    m_value = new string(value);
+CAttribute::CAttribute(const CText & name, const CText & value) {
+    if (!IsValidTitle(name))
+        throw InvalidXMLTitleException(name.GetString());
+
+    CArena * arena = CArena::GetOwner(this);
+    m_name = arena->GetAtoms()->Add(name);
+    m_value = arena->Store(value);
 }
 
-/*! Frees the allocated memory for attribute.
+/*! Creates new attribute with checked name.
+ * \param name Atom of the name of the attribute.
+ * \param value Value of the attribute.
+ */
+CAttribute::CAttribute(int name, const CText & value) {
+    m_name = name;
+    m_value = CArena::GetOwner(this)->Store(value);
+}
+
+/*! Gives the value back to the arena.
  */
 CAttribute::~CAttribute() {
-    delete m_name;
-    delete m_value;
+    CArena::GetOwner(this)->Release(m_value);
+}
+
+/*! Allocates the attribute in the arena.
+ * \param size Size of the attribute.
+ * \param arena Pointer to the arena of the document.
+ */
+void * CAttribute::operator new(size_t size, CArena * arena) {
+    return arena->AllocObject(size);
+}
+
+/*! Frees the attribute, which could not be created.
+ * \param p Pointer to the attribute.
+ * \param arena Pointer to the arena of the document.
+ */
+void CAttribute::operator delete(void * p, CArena * arena) {
+    CArena::FreeObject(p);
+}
+
+/*! Gives the memory of the attribute back to its arena.
+ * \param p Pointer to the attribute.
+ */
+void CAttribute::operator delete(void * p) {
+    CArena::FreeObject(p);
 }
 
 
+/*! Gets the atom of attribute name.
+ */
+int CAttribute::GetAtom() const {
+    return m_name;
+}
+
 /*! Gets the name of attribute.
  * \return Name of attribute. 
  */
 string CAttribute::GetName() const {
-    return *m_name;
+    return GetNameText().GetString();
 }
 
 /*! Gets the value of attribute.
  * \return Value of attribute. 
  */
 string CAttribute::GetValue() const {
-    return *m_value;
+    return m_value.GetString();
 }
 
-/*! Gets the pointer to value of attribute.
- * \return Pointer to value of attribute. 
+/*! Gets the name of attribute without copying it.
+ * \return Name of attribute. 
  */
-string * CAttribute::GetValuePointer() const {
-    return m_value;
+const CText & CAttribute::GetNameText() const {
+    return CArena::GetOwner(this)->GetAtoms()->Get(m_name);
 }
 
-/*! Gets the pointer to name of attribute.
- * \return Pointer to name of attribute. 
+/*! Gets the value of attribute without copying it.
+ * \return Value of attribute. 
  */
-string * CAttribute::GetNamePointer() const {
-    return m_name;
+const CText & CAttribute::GetValueText() const {
+    return m_value;
 }
 
 
@@ -62,7 +100,9 @@ string * CAttribute::GetNamePointer() const {
  * \param value Given value to be set.
  */
 void CAttribute::SetValue(string & value) {
-    *m_value = value;
+    CArena * arena = CArena::GetOwner(this);
+    arena->Release(m_value);
+    m_value = arena->Store(value);
 }
 
 /*! Sets the name of attribute and checks its validity.
@@ -70,7 +110,7 @@ void CAttribute::SetValue(string & value) {
  */
 void CAttribute::SetName(string & name) {
     if (IsValidTitle(name))
-        *m_name = name;
+        m_name = CArena::GetOwner(this)->GetAtoms()->Add(name);
     else
         throw InvalidXMLTitleException(name);
 }
@@ -4,27 +4,37 @@
 #include <cstdlib>
 #include <string>
 
+#include "CText.h"
+#include "CArena.h"
+
 using namespace std;
 
 ///! Class for creating and working with XML attributes
 
 class CAttribute {
 public:
-    CAttribute(string & name, string & value);
+    CAttribute(const CText & name, const CText & value);
+    CAttribute(int name, const CText & value);
     ~CAttribute();
+
+    //attributes live in the arena of the document
+    static void * operator new(size_t size, CArena * arena);
+    static void operator delete(void * p, CArena * arena);
+    static void operator delete(void * p);
+
+    int GetAtom() const;
     string GetName() const;
     string GetValue() const;
-
-    string * GetNamePointer() const;
-    string * GetValuePointer() const;
+    const CText & GetNameText() const;
+    const CText & GetValueText() const;
 
     void SetName(string & name);
     void SetValue(string & value);
 protected:
-    ///! Pointer to attribute name
-    string * m_name;
-    ///! Pointer to attribute value
-    string * m_value;
+    ///! Atom of attribute name
+    int m_name;
+    ///! Attribute value
+    CText m_value;
 };
 
 #endif	/* CATTRIBUTE_H */
@@ -0,0 +1,543 @@
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "CBatch.h"
+#include "CException.h"
+#include "CMappedFile.h"
+#include "CWorkPool.h"
+#include "CXMLChecker.h"
+#include "CXMLHandler.h"
+#include "CParser.h"
+#include "CDecoder.h"
+
+///! Default count of files
+#define DEFAULT_FILES_SIZE 64
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+///! Maximal count of threads processing the files
+#define BATCH_MAX_THREADS 64
+///! Maximal length of the counts of the stats command
+#define STATS_LENGTH 256
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates the batch without files.
+ * \param program Name of the program (for messages).
+ */
+CBatch::CBatch(const char * program) {
+    m_program = program;
+    m_command = NULL;
+    m_isValidating = false;
+    m_files = new string [DEFAULT_FILES_SIZE];
+    m_cntFiles = 0;
+    m_sizeFiles = DEFAULT_FILES_SIZE;
+    m_results = NULL;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_done, NULL);
+}
+
+/*! Frees the list of the files.
+ */
+CBatch::~CBatch() {
+    delete [] m_files;
+    pthread_cond_destroy(&m_done);
+    pthread_mutex_destroy(&m_lock);
+}
+
+/*! Runs the command of the command line like "-j 8 query /catalog/cd[2] a.xml feeds/" over the files,
+ * directories are searched for the files with BATCH_SUFFIX (and the compressed suffixes), "-l LIST" adds the paths
+ * listed in a file. Without files the standard input is read. Each file is loaded by its own document, which is freed after it.
+ * More files are processed by a pool of threads (as many as the cores, or given by "-j THREADS").
+ * \param argc Count of the arguments.
+ * \param argv The arguments (the first one is the program).
+ * \return BATCH_OK, BATCH_FAILED if the command failed for some file, BATCH_USAGE if the command line is wrong.
+ */
+int CBatch::Run(int argc, char ** argv) {
+    //options go before the command
+    int threads = 0;
+    bool isFailed = false;
+    bool hasPaths = false;
+    int i = 1;
+    while (i < argc && argv[i][0] == '-' && argv[i][1] != 0) {
+        if (i + 1 >= argc)
+            return PrintUsage();
+        if (strcmp(argv[i], "-j") == 0) {
+            threads = atoi(argv[i + 1]);
+            if (threads < 1)
+                return PrintUsage();
+        } else if (strcmp(argv[i], "-l") == 0) {
+            if (!AddList(argv[i + 1]))
+                isFailed = true;
+            hasPaths = true;
+        } else
+            return PrintUsage();
+        i += 2;
+    }
+    if (i >= argc)
+        return PrintUsage();
+
+    //commands with an argument get it before the files
+    bool hasArgument = false;
+    if (strcmp(argv[i], "validate") == 0)
+        m_isValidating = true;
+    else if (strcmp(argv[i], "print") == 0)
+        m_command = &CBatch::Print;
+    else if (strcmp(argv[i], "minify") == 0)
+        m_command = &CBatch::Minify;
+    else if (strcmp(argv[i], "query") == 0) {
+        m_command = &CBatch::Query;
+        hasArgument = true;
+    } else if (strcmp(argv[i], "filter") == 0) {
+        m_command = &CBatch::Filter;
+        hasArgument = true;
+    } else if (strcmp(argv[i], "stats") == 0)
+        m_command = &CBatch::Stats;
+    i++;
+    if ((m_command == NULL && !m_isValidating) || (hasArgument && i >= argc))
+        return PrintUsage();
+    if (hasArgument)
+        m_argument = argv[i++];
+
+    for (; i < argc; i++) {
+        if (!AddPath(argv[i]))
+            isFailed = true;
+        hasPaths = true;
+    }
+    if (!hasPaths)
+        AddFile(STDIN_PATH);
+
+    if (threads == 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads > BATCH_MAX_THREADS)
+            threads = BATCH_MAX_THREADS;
+    }
+    if (threads > m_cntFiles)
+        threads = m_cntFiles;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int failed = threads > 1 ? RunParallel(threads) : RunSequential();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    //summary of more files
+    if (m_cntFiles > 1) {
+        long time = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+        cerr << m_program << ": " << m_cntFiles << " files, " << m_cntFiles - failed << " OK, " << failed
+                << " failed, " << threads << (threads > 1 ? " threads, " : " thread, ") << time << " ms" << endl;
+    }
+    return failed || isFailed ? BATCH_FAILED : BATCH_OK;
+}
+
+/********************* COMMANDS *******************************/
+
+/*! Checks, that the file is a valid XML document. The file is only read by the checker, no tree is built
+ * (nor the binary image is used), the first error is reported with its line and column. The standard input,
+ * which cannot be mapped, is checked in chunks, so it is not kept in memory. Compressed file is checked, while it
+ * is decompressed by other thread.
+ * \param filePath Path of the file.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return True, the invalid document throws an exception.
+ */
+bool CBatch::Validate(const string & filePath, CXMLWriter & output, string & errors) {
+    CXMLChecker checker(filePath);
+    struct stat info;
+    if (filePath == STDIN_PATH && fstat(STDIN_FILENO, &info) == 0 && !S_ISREG(info.st_mode)) {
+        //pipe is read in chunks
+        checker.Check(STDIN_FILENO);
+    } else {
+        CMappedFile file(filePath);
+        if (CDecoder::GetFormat(file.GetData(), file.GetSize()) != DECODER_NONE) {
+            CDecoder decoder(file.GetData(), file.GetSize(), filePath);
+            checker.Check(&decoder);
+        } else
+            checker.Check(file.GetData(), file.GetSize());
+    }
+    string line = filePath + ": OK";
+    output.Write(line.data(), line.length());
+    output.WriteLine();
+    return true;
+}
+
+/*! Prints the document with every node on its own line.
+ * \param document The loaded document.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return True.
+ */
+bool CBatch::Print(const TDocument & document, CXMLWriter & output, string & errors) {
+    output.SetFormat(WRITER_PRETTY);
+    document.m_store->Print(output);
+    return true;
+}
+
+/*! Prints the document without white spaces between the nodes.
+ * \param document The loaded document.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return True.
+ */
+bool CBatch::Minify(const TDocument & document, CXMLWriter & output, string & errors) {
+    output.SetFormat(WRITER_MINIFY);
+    document.m_store->Print(output);
+    return true;
+}
+
+/*! Prints the node at the path (like /catalog/cd[2]/title) as it is in the file.
+ * \param document The loaded document.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return False, if there is not such node.
+ */
+bool CBatch::Query(const TDocument & document, CXMLWriter & output, string & errors) {
+    int node = document.m_store->FindPath(m_argument);
+    if (node < 0)
+        return AddError(errors, "Path " + m_argument + " does not exist in " + document.m_filePath + "!");
+    document.m_store->XMLPrint(node, output);
+    output.WriteLine();
+    return true;
+}
+
+/*! Prints all the elements with the title in the order of the document, each one on its own line.
+ * The flat array of titles is searched.
+ * \param document The loaded document.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return True.
+ */
+bool CBatch::Filter(const TDocument & document, CXMLWriter & output, string & errors) {
+    //title, which is not in the document, has no atom
+    const CNodeStore * store = document.m_store;
+    int name = store->GetAtoms().Find(m_argument);
+    if (name < 0)
+        return true;
+    for (int node = store->FindNext(name, 0); node >= 0; node = store->FindNext(name, node + 1)) {
+        store->XMLPrint(node, output);
+        output.WriteLine();
+    }
+    return true;
+}
+
+/*! Prints the counts of the nodes of the document on one line, the nodes are counted in the flat arrays.
+ * \param document The loaded document.
+ * \param output Output of the command.
+ * \param errors Messages about the file.
+ * \return True.
+ */
+bool CBatch::Stats(const TDocument & document, CXMLWriter & output, string & errors) {
+    const CNodeStore * store = document.m_store;
+    TStats stats;
+    memset(&stats, 0, sizeof (stats));
+    //parents are before their childs, so their depth is known
+    int * depths = new int [store->GetCount()];
+    for (int node = 0; node < store->GetCount(); node++) {
+        switch (store->GetKind(node)) {
+            case NEXT_IS_PARENTNODE:
+                stats.m_cntParents++;
+                break;
+            case NEXT_IS_TEXTNODE:
+                stats.m_cntTexts++;
+                break;
+            case NEXT_IS_SIMPLE:
+                stats.m_cntSimples++;
+                break;
+            case NEXT_IS_COMMENT:
+                stats.m_cntComments++;
+                break;
+        }
+        stats.m_cntAttributes += store->GetAttributeCount(node);
+        int parent = store->GetParent(node);
+        depths[node] = parent >= 0 ? depths[parent] + 1 : 1;
+        if (depths[node] > stats.m_maxDepth)
+            stats.m_maxDepth = depths[node];
+    }
+    delete [] depths;
+
+    char numbers[STATS_LENGTH];
+    snprintf(numbers, sizeof (numbers), ": bytes=%lu parents=%ld texts=%ld simples=%ld comments=%ld attributes=%ld"
+            " names=%d depth=%d", (unsigned long) document.m_file->GetSize(), stats.m_cntParents, stats.m_cntTexts,
+            stats.m_cntSimples, stats.m_cntComments, stats.m_cntAttributes, store->GetAtoms().GetCount(),
+            stats.m_maxDepth);
+    string line = document.m_filePath + numbers;
+    output.Write(line.data(), line.length());
+    output.WriteLine();
+    return true;
+}
+
+/********************* PROCESSING THE FILES *******************************/
+
+/*! Maps the file and parses it into the flat node store, compressed file is parsed, while it is decompressed
+ * by other thread (texts are copied to the store then, so the decompressed data are not kept).
+ * \param document The document with the path, the file and the store are set here.
+ */
+void CBatch::Load(TDocument & document) {
+    document.m_file = new CMappedFile(document.m_filePath);
+    const char * data = document.m_file->GetData();
+    size_t size = document.m_file->GetSize();
+    CParser parser(data, size, document.m_filePath, NULL);
+    if (CDecoder::GetFormat(data, size) != DECODER_NONE) {
+        CDecoder decoder(data, size, document.m_filePath);
+        document.m_store = parser.ParseStore(&decoder);
+    } else
+        document.m_store = parser.ParseStore();
+}
+
+/*! Loads the file and runs the command over it, the document is freed then. Validated files are not loaded.
+ * \param filePath Path of the file.
+ * \param output Output of the command, it is closed here (it may point to the document).
+ * \param errors Messages about the file.
+ * \return False, if the command failed.
+ */
+bool CBatch::RunFile(const string & filePath, CXMLWriter & output, string & errors) {
+    TDocument document;
+    document.m_filePath = filePath;
+    document.m_file = NULL;
+    document.m_store = NULL;
+    bool isOK = false;
+    try {
+        if (m_isValidating)
+            isOK = Validate(filePath, output, errors);
+        else {
+            Load(document);
+            isOK = (this->*m_command)(document, output, errors);
+        }
+    } catch (const CException & e) {
+        AddError(errors, e.GetMessage());
+    }
+    if (!output.Close())
+        isOK = AddError(errors, "Output could not be written!");
+    delete document.m_store;
+    delete document.m_file;
+    return isOK;
+}
+
+/*! Processes the files one by one, the output is written directly.
+ * \return Count of the files, for which the command failed.
+ */
+int CBatch::RunSequential() {
+    int failed = 0;
+    for (int i = 0; i < m_cntFiles; i++) {
+        CXMLWriter output(STDOUT_FILENO);
+        string errors;
+        if (!RunFile(m_files[i], output, errors))
+            failed++;
+        cerr << errors;
+    }
+    return failed;
+}
+
+/*! Processes the files by the pool of threads. Outputs of the files are kept in memory and this thread writes
+ * them in the order of the files, while the next files are processed.
+ * \param threads Count of threads.
+ * \return Count of the files, for which the command failed.
+ */
+int CBatch::RunParallel(int threads) {
+    m_results = new TResult [m_cntFiles];
+    for (int i = 0; i < m_cntFiles; i++) {
+        m_results[i].m_output = NULL;
+        m_results[i].m_isOK = false;
+        m_results[i].m_isDone = false;
+    }
+    CWorkPool pool(threads);
+    pool.Start(m_cntFiles, RunTask, this);
+
+    int failed = 0;
+    for (int i = 0; i < m_cntFiles; i++) {
+        TResult & result = m_results[i];
+        pthread_mutex_lock(&m_lock);
+        while (!result.m_isDone)
+            pthread_cond_wait(&m_done, &m_lock);
+        pthread_mutex_unlock(&m_lock);
+
+        CXMLWriter output(STDOUT_FILENO);
+        output.Append(result.m_output);
+        result.m_output = NULL;
+        if (!output.Close())
+            result.m_isOK = AddError(result.m_errors, "Output could not be written!");
+        if (!result.m_isOK)
+            failed++;
+        cerr << result.m_errors;
+        string().swap(result.m_errors);
+    }
+    pool.Join();
+    delete [] m_results;
+    m_results = NULL;
+    return failed;
+}
+
+/*! Task of the pool, which processes one file to the copying snapshot writer (the document is freed before
+ * the output is written).
+ * \param batch Pointer to the CBatch.
+ * \param task Index of the file.
+ */
+void CBatch::RunTask(void * batch, int task) {
+    CBatch * self = (CBatch *) batch;
+    CXMLWriter * output = new CXMLWriter();
+    output->SetCopying(true);
+    string errors;
+    bool isOK = self->RunFile(self->m_files[task], *output, errors);
+
+    pthread_mutex_lock(&self->m_lock);
+    TResult & result = self->m_results[task];
+    result.m_output = output;
+    result.m_errors.swap(errors);
+    result.m_isOK = isOK;
+    result.m_isDone = true;
+    pthread_cond_broadcast(&self->m_done);
+    pthread_mutex_unlock(&self->m_lock);
+}
+
+/********************* LIST OF THE FILES *******************************/
+
+/*! Adds the file, or the files of the directory.
+ * \param path Path of the file or of the directory.
+ * \return False, if the directory could not be read.
+ */
+bool CBatch::AddPath(const string & path) {
+    struct stat info;
+    if (path != STDIN_PATH && stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+        return AddDirectory(path);
+    //errors of the file are found, when it is loaded
+    AddFile(path);
+    return true;
+}
+
+/*! Adds the files with BATCH_SUFFIX of the directory and of its subdirectories, in the order of their names.
+ * Compressed files with BATCH_GZIP_SUFFIX and BATCH_ZSTD_SUFFIX are added too (zstd files fail, when it is not
+ * supported). Links to directories are not followed, so there are no cycles.
+ * \param path Path of the directory.
+ * \return False, if the directory or some subdirectory could not be read.
+ */
+bool CBatch::AddDirectory(const string & path) {
+    struct dirent ** entries;
+    int cntEntries = scandir(path.c_str(), &entries, NULL, alphasort);
+    if (cntEntries < 0)
+        return PrintError("Directory " + path + " could not be read!");
+
+    string prefix = path[path.length() - 1] == '/' ? path : path + "/";
+    bool isOK = true;
+    for (int i = 0; i < cntEntries; i++) {
+        const char * name = entries[i]->d_name;
+        struct stat info;
+        if (strcmp(name, ".") != 0 && strcmp(name, "..") != 0 && lstat((prefix + name).c_str(), &info) == 0) {
+            if (S_ISDIR(info.st_mode)) {
+                if (!AddDirectory(prefix + name))
+                    isOK = false;
+            } else if (HasSuffix(name, BATCH_SUFFIX) || HasSuffix(name, BATCH_GZIP_SUFFIX)
+                    || HasSuffix(name, BATCH_ZSTD_SUFFIX))
+                AddFile(prefix + name);
+        }
+        free(entries[i]);
+    }
+    free(entries);
+    return isOK;
+}
+
+/*! Does the name of the file end with the suffix (and something is in front of it)?
+ * \param name Name of the file.
+ * \param suffix The suffix.
+ */
+bool CBatch::HasSuffix(const char * name, const char * suffix) {
+    size_t length = strlen(name);
+    size_t suffixLength = strlen(suffix);
+    return length > suffixLength && strcmp(name + length - suffixLength, suffix) == 0;
+}
+
+/*! Adds the files (or directories) listed in a file, one path on a line.
+ * \param listPath Path of the list, STDIN_PATH reads the list from the standard input.
+ * \return False, if the list, or some listed directory could not be read.
+ */
+bool CBatch::AddList(const string & listPath) {
+    ifstream file;
+    istream * list = &cin;
+    if (listPath != STDIN_PATH) {
+        file.open(listPath.c_str());
+        if (!file.is_open())
+            return PrintError("File " + listPath + " does not exist!");
+        list = &file;
+    }
+
+    bool isOK = true;
+    string line;
+    while (getline(*list, line)) {
+        if (!line.empty() && !AddPath(line))
+            isOK = false;
+    }
+    return isOK;
+}
+
+/*! Adds the file to the end of the list.
+ * \param filePath Path of the file.
+ */
+void CBatch::AddFile(const string & filePath) {
+    ReallocFiles();
+    m_files[m_cntFiles++] = filePath;
+}
+
+/*! Files memory management.
+ */
+void CBatch::ReallocFiles() {
+    if (m_cntFiles < m_sizeFiles)
+        return;
+    string * tmp = new string [m_sizeFiles * REALLOC_CONSTANT];
+    for (int i = 0; i < m_cntFiles; i++)
+        tmp[i].swap(m_files[i]);
+    delete [] m_files;
+    m_files = tmp;
+    m_sizeFiles *= REALLOC_CONSTANT;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Adds the message to the messages about the file.
+ * \param errors Messages about the file.
+ * \param message The message.
+ * \return False (the command failed).
+ */
+bool CBatch::AddError(string & errors, const string & message) const {
+    errors.append(m_program);
+    errors.append(": ");
+    errors.append(message);
+    errors.append("\n");
+    return false;
+}
+
+/*! Prints the message to the standard error output.
+ * \param message The message.
+ * \return False (the command failed).
+ */
+bool CBatch::PrintError(const string & message) const {
+    cerr << m_program << ": " << message << endl;
+    return false;
+}
+
+/*! Prints how to use the program.
+ * \return BATCH_USAGE.
+ */
+int CBatch::PrintUsage() const {
+    cerr << "Usage: " << m_program << " [-j THREADS] [-l LIST] COMMAND [ARGUMENT] [FILE|DIRECTORY]..." << endl
+            << "Commands:" << endl
+            << "  validate      checks, that the files are valid XML documents" << endl
+            << "  print         prints the documents with every node on its own line" << endl
+            << "  minify        prints the documents without white spaces between the nodes" << endl
+            << "  query PATH    prints the node at the path like /catalog/cd[2]/title" << endl
+            << "  filter TITLE  prints all the elements with the title" << endl
+            << "  stats         prints the counts of the nodes of the documents" << endl
+            << "Options:" << endl
+            << "  -j THREADS    count of threads processing the files (as many as the cores by default)" << endl
+            << "  -l LIST       processes also the paths listed in the file, one on a line" << endl
+            << "Directories are searched for " << BATCH_SUFFIX << ", " << BATCH_GZIP_SUFFIX << " and "
+            << BATCH_ZSTD_SUFFIX << " files. Without files, or with "
+            << STDIN_PATH << ", the standard input is read." << endl
+            << "Outputs of the files are written in the order of the files." << endl;
+    return BATCH_USAGE;
+}
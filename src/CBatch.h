@@ -0,0 +1,133 @@
+#ifndef CBATCH_H
+#define	CBATCH_H
+
+#include <cstdlib>
+#include <string>
+#include <pthread.h>
+
+#include "CMappedFile.h"
+#include "CNodeStore.h"
+#include "CXMLWriter.h"
+
+using namespace std;
+
+///! Exit status, when every file was processed
+#define BATCH_OK 0
+///! Exit status, when some file is not valid, or the searched node was not found
+#define BATCH_FAILED 1
+///! Exit status, when the command line is wrong
+#define BATCH_USAGE 2
+///! Suffix of the files, which are processed from the given directories
+#define BATCH_SUFFIX ".xml"
+///! Suffix of the gzip compressed files, which are processed from the given directories
+#define BATCH_GZIP_SUFFIX ".xml.gz"
+///! Suffix of the zstd compressed files, which are processed from the given directories
+#define BATCH_ZSTD_SUFFIX ".xml.zst"
+
+///! Class, which runs one command of the command line over the files (or the standard input) without any interface.
+///! The commands only read the documents, so they are parsed into the flat node store instead of the tree.
+///! Documents go to the standard output, messages about the files to the standard error output.
+///! More files are processed by a pool of threads, their outputs are written in the order of the files.
+
+class CBatch {
+public:
+    CBatch(const char * program);
+    ~CBatch();
+
+    int Run(int argc, char ** argv);
+protected:
+    ///! Structure, which keeps one loaded document for the commands.
+    struct TDocument {
+        ///! Path of the file
+        string m_filePath;
+        ///! The mapped file (texts of the store point to it)
+        CMappedFile * m_file;
+        ///! Nodes of the document
+        CNodeStore * m_store;
+    };
+
+    ///! Method, which runs the command over one loaded document and writes its output.
+    typedef bool (CBatch::*TCommand)(const TDocument & document, CXMLWriter & output, string & errors);
+
+    ///! Structure, which counts the nodes of a document for the stats command.
+    struct TStats {
+        ///! Count of parent nodes
+        long m_cntParents;
+        ///! Count of text nodes
+        long m_cntTexts;
+        ///! Count of simple nodes
+        long m_cntSimples;
+        ///! Count of comments
+        long m_cntComments;
+        ///! Count of attributes
+        long m_cntAttributes;
+        ///! Depth of the deepest node (the root has depth 1)
+        int m_maxDepth;
+    };
+
+    ///! Structure, which keeps the output of one file processed by the pool, until it is written.
+    struct TResult {
+        ///! Output of the command (copying snapshot writer)
+        CXMLWriter * m_output;
+        ///! Messages about the file
+        string m_errors;
+        ///! Was the command successful?
+        bool m_isOK;
+        ///! Is the file processed?
+        bool m_isDone;
+    };
+
+    //commands
+    bool Validate(const string & filePath, CXMLWriter & output, string & errors);
+    bool Print(const TDocument & document, CXMLWriter & output, string & errors);
+    bool Minify(const TDocument & document, CXMLWriter & output, string & errors);
+    bool Query(const TDocument & document, CXMLWriter & output, string & errors);
+    bool Filter(const TDocument & document, CXMLWriter & output, string & errors);
+    bool Stats(const TDocument & document, CXMLWriter & output, string & errors);
+
+    //processing the files
+    void Load(TDocument & document);
+    bool RunFile(const string & filePath, CXMLWriter & output, string & errors);
+    int RunSequential();
+    int RunParallel(int threads);
+    static void RunTask(void * batch, int task);
+
+    //list of the files
+    bool AddPath(const string & path);
+    bool AddDirectory(const string & path);
+    static bool HasSuffix(const char * name, const char * suffix);
+    bool AddList(const string & listPath);
+    void AddFile(const string & filePath);
+    void ReallocFiles();
+
+    //tools of the commands
+    bool AddError(string & errors, const string & message) const;
+    bool PrintError(const string & message) const;
+    int PrintUsage() const;
+
+    ///! Name of the program (for messages)
+    string m_program;
+    ///! The command
+    TCommand m_command;
+    ///! Is the command validate (the files are only checked, no tree is built)?
+    bool m_isValidating;
+    ///! Argument of the command (path of query, title of filter)
+    string m_argument;
+    ///! Paths of the files
+    string * m_files;
+    ///! Count of the files
+    int m_cntFiles;
+    ///! Current max count of the files
+    int m_sizeFiles;
+
+    //processing by the pool
+    ///! Results of the files
+    TResult * m_results;
+    ///! Lock of the results
+    pthread_mutex_t m_lock;
+    ///! Signal of processed file
+    pthread_cond_t m_done;
+};
+
+#endif	/* CBATCH_H */
+
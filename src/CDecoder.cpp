@@ -0,0 +1,326 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "CDecoder.h"
+#include "CException.h"
+
+///! Maximal size of compressed data given to zlib at once (it counts in 32 bits)
+#define DECODER_INPUT_SIZE 1073741824
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new decoder of compressed data, nothing is decompressed yet.
+ * \param data Pointer to the compressed data (they must stay, until the decoder is deleted).
+ * \param size Size of the compressed data.
+ * \param filePath File name (for exceptions).
+ * \throws InvalidXMLFormatException The format is not known (or not supported).
+ */
+CDecoder::CDecoder(const char * data, size_t size, const string & filePath) {
+    m_data = data;
+    m_size = size;
+    m_pos = 0;
+    m_filePath = filePath;
+    m_format = GetFormat(data, size);
+
+    if (m_format == DECODER_GZIP) {
+        memset(&m_zlib, 0, sizeof (m_zlib));
+        if (inflateInit2(&m_zlib, 15 + 16) != Z_OK) // 16 means gzip header
+            throw bad_alloc();
+    } else if (m_format == DECODER_ZSTD) {
+#ifdef HAVE_ZSTD
+        m_zstd = ZSTD_createDStream();
+        if (m_zstd == NULL)
+            throw bad_alloc();
+        ZSTD_initDStream(m_zstd);
+        m_zstdInput.src = data;
+        m_zstdInput.size = size;
+        m_zstdInput.pos = 0;
+        m_zstdResult = 1;
+#else
+        Corrupted("Zstd compression is not supported by this build.");
+#endif
+    } else
+        Corrupted("The data are not compressed.");
+
+    for (int i = 0; i < DECODER_BUFFERS; i++) {
+        m_buffers[i] = new char [DECODER_BUFFER_SIZE];
+        m_sizes[i] = 0;
+    }
+    m_head = 0;
+    m_tail = 0;
+    m_cntFilled = 0;
+    m_isEnded = false;
+    m_isCanceled = false;
+    m_started = false;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_filled, NULL);
+    pthread_cond_init(&m_released, NULL);
+}
+
+/*! Stops the decoder thread (if the data were not read to the end) and frees the buffers.
+ */
+CDecoder::~CDecoder() {
+    if (m_started) {
+        pthread_mutex_lock(&m_lock);
+        m_isCanceled = true;
+        pthread_cond_broadcast(&m_released);
+        pthread_mutex_unlock(&m_lock);
+        pthread_join(m_thread, NULL);
+    }
+    pthread_cond_destroy(&m_released);
+    pthread_cond_destroy(&m_filled);
+    pthread_mutex_destroy(&m_lock);
+    for (int i = 0; i < DECODER_BUFFERS; i++)
+        delete [] m_buffers[i];
+
+    if (m_format == DECODER_GZIP)
+        inflateEnd(&m_zlib);
+#ifdef HAVE_ZSTD
+    else
+        ZSTD_freeDStream(m_zstd);
+#endif
+}
+
+/*! Tells the format of the data by their magic bytes.
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ * \return The format, specified by constants.
+ */
+int CDecoder::GetFormat(const char * data, size_t size) {
+    const unsigned char * x = (const unsigned char *) data;
+    if (size >= 2 && x[0] == 0x1f && x[1] == 0x8b)
+        return DECODER_GZIP;
+    if (size >= 4 && x[0] == 0x28 && x[1] == 0xb5 && x[2] == 0x2f && x[3] == 0xfd)
+        return DECODER_ZSTD;
+    return DECODER_NONE;
+}
+
+/*! Gets the size of decompressed data written in the compressed data (for the progress of the loading).
+ * Gzip keeps only the lower 32 bits of the size of its last part, so its size is only a lower bound:
+ * the lowest size with these bits, which is not smaller than the compressed data.
+ * \return The size, 0 if it is not known.
+ */
+size_t CDecoder::GetSizeHint() const {
+    if (m_format == DECODER_GZIP && m_size >= 18) {
+        const unsigned char * x = (const unsigned char *) m_data + m_size - 4;
+        uint64_t size = (uint64_t) x[0] | (uint64_t) x[1] << 8 | (uint64_t) x[2] << 16 | (uint64_t) x[3] << 24;
+        //documents over 4 GB wrap around
+        while (size < m_size)
+            size += (uint64_t) 1 << 32;
+        return (size_t) size;
+    }
+#ifdef HAVE_ZSTD
+    if (m_format == DECODER_ZSTD) {
+        unsigned long long size = ZSTD_getFrameContentSize(m_data, m_size);
+        if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR)
+            return size;
+    }
+#endif
+    return 0;
+}
+
+/*! Starts the decoder thread. If it could not be started, the data are decompressed by Next.
+ */
+void CDecoder::Start() {
+    m_started = pthread_create(&m_thread, NULL, DecoderThread, this) == 0;
+}
+
+/*! Gets the next buffer of decompressed data, it waits, until the decoder thread fills it.
+ * The buffer must be given back by Release.
+ * \param size To this variable is saved the count of bytes in the buffer.
+ * \return Pointer to the buffer, NULL after the last one.
+ * \throws InvalidXMLFormatException The compressed data are corrupted (after the buffers before the error).
+ */
+const char * CDecoder::Next(size_t & size) {
+    //without the thread, one buffer is decompressed at once
+    if (!m_started) {
+        if (m_isEnded)
+            return NULL;
+        m_isEnded = !DecodeBuffer(m_buffers[0], m_sizes[0]);
+        size = m_sizes[0];
+        return m_buffers[0];
+    }
+
+    pthread_mutex_lock(&m_lock);
+    while (m_cntFilled == 0 && !m_isEnded)
+        pthread_cond_wait(&m_filled, &m_lock);
+    if (m_cntFilled == 0) {
+        pthread_mutex_unlock(&m_lock);
+        if (m_error)
+            rethrow_exception(m_error);
+        return NULL;
+    }
+    const char * buffer = m_buffers[m_head];
+    size = m_sizes[m_head];
+    pthread_mutex_unlock(&m_lock);
+    return buffer;
+}
+
+/*! Gives the read buffer back to the decoder thread.
+ */
+void CDecoder::Release() {
+    if (!m_started)
+        return;
+    pthread_mutex_lock(&m_lock);
+    m_head = (m_head + 1) % DECODER_BUFFERS;
+    m_cntFilled--;
+    pthread_cond_signal(&m_released);
+    pthread_mutex_unlock(&m_lock);
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Thread function, which decompresses the data.
+ * \param decoder Pointer to CDecoder.
+ */
+void * CDecoder::DecoderThread(void * decoder) {
+    ((CDecoder *) decoder)->Decode();
+    return NULL;
+}
+
+/*! Fills the free buffers, until the data are decompressed, or the decoding is canceled.
+ */
+void CDecoder::Decode() {
+    try {
+        bool isLast = false;
+        while (!isLast) {
+            char * buffer = Fill();
+            if (buffer == NULL)
+                return;
+            size_t size;
+            isLast = !DecodeBuffer(buffer, size);
+            Filled(size, isLast);
+        }
+    } catch (...) {
+        //the exception is thrown again by the reading thread
+        pthread_mutex_lock(&m_lock);
+        m_error = current_exception();
+        m_isEnded = true;
+        pthread_cond_signal(&m_filled);
+        pthread_mutex_unlock(&m_lock);
+    }
+}
+
+/*! Decompresses the next part of the data to the buffer.
+ * \param buffer Pointer to the buffer (of DECODER_BUFFER_SIZE).
+ * \param size To this variable is saved the count of decompressed bytes.
+ * \return False, if the data ended.
+ */
+bool CDecoder::DecodeBuffer(char * buffer, size_t & size) {
+    if (m_format == DECODER_GZIP)
+        return DecodeGzip(buffer, size);
+    return DecodeZstd(buffer, size);
+}
+
+/*! Decompresses the next part of gzip data. More files can follow each other (like for zcat),
+ * anything else after the last file is ignored.
+ * \param buffer Pointer to the buffer (of DECODER_BUFFER_SIZE).
+ * \param size To this variable is saved the count of decompressed bytes.
+ * \return False, if the data ended.
+ */
+bool CDecoder::DecodeGzip(char * buffer, size_t & size) {
+    bool hasMore = true;
+    m_zlib.next_out = (Bytef *) buffer;
+    m_zlib.avail_out = DECODER_BUFFER_SIZE;
+    while (m_zlib.avail_out > 0) {
+        if (m_zlib.avail_in == 0) {
+            size_t input = m_size - m_pos;
+            if (input > DECODER_INPUT_SIZE)
+                input = DECODER_INPUT_SIZE;
+            m_zlib.next_in = (Bytef *) m_data + m_pos;
+            m_zlib.avail_in = input;
+            m_pos += input;
+        }
+
+        int result = inflate(&m_zlib, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            size_t next = m_pos - m_zlib.avail_in;
+            if (GetFormat(m_data + next, m_size - next) != DECODER_GZIP) {
+                hasMore = false;
+                break;
+            }
+            inflateReset(&m_zlib);
+        } else if (result == Z_BUF_ERROR)
+            Corrupted("Compressed data are not complete.");
+        else if (result == Z_MEM_ERROR)
+            throw bad_alloc();
+        else if (result != Z_OK)
+            Corrupted("Compressed data are corrupted.");
+    }
+    size = DECODER_BUFFER_SIZE - m_zlib.avail_out;
+    return hasMore;
+}
+
+/*! Decompresses the next part of zstd data (all of its frames).
+ * \param buffer Pointer to the buffer (of DECODER_BUFFER_SIZE).
+ * \param size To this variable is saved the count of decompressed bytes.
+ * \return False, if the data ended.
+ */
+bool CDecoder::DecodeZstd(char * buffer, size_t & size) {
+    bool hasMore = true;
+#ifdef HAVE_ZSTD
+    ZSTD_outBuffer output;
+    output.dst = buffer;
+    output.size = DECODER_BUFFER_SIZE;
+    output.pos = 0;
+    while (output.pos < output.size) {
+        //decompressor may keep some data, when all the input is read
+        bool isInputRead = m_zstdInput.pos == m_zstdInput.size;
+        if (isInputRead && m_zstdResult == 0) {
+            hasMore = false;
+            break;
+        }
+        size_t pos = output.pos;
+        m_zstdResult = ZSTD_decompressStream(m_zstd, &output, &m_zstdInput);
+        if (ZSTD_isError(m_zstdResult))
+            Corrupted("Compressed data are corrupted.");
+        if (isInputRead && output.pos == pos)
+            Corrupted("Compressed data are not complete.");
+    }
+    size = output.pos;
+#else
+    size = 0;
+    hasMore = false;
+#endif
+    return hasMore;
+}
+
+/*! Throws the exception of invalid format with the reason.
+ * \param reason What is wrong with the compressed data.
+ */
+void CDecoder::Corrupted(const char * reason) const {
+    InvalidXMLFormatException e(m_filePath);
+    e.SetReason(reason);
+    throw e;
+}
+
+/*! Waits for a free buffer for the decoder thread.
+ * \return Pointer to the buffer, NULL if the decoding is canceled.
+ */
+char * CDecoder::Fill() {
+    pthread_mutex_lock(&m_lock);
+    while (m_cntFilled == DECODER_BUFFERS && !m_isCanceled)
+        pthread_cond_wait(&m_released, &m_lock);
+    char * buffer = m_isCanceled ? NULL : m_buffers[m_tail];
+    pthread_mutex_unlock(&m_lock);
+    return buffer;
+}
+
+/*! Gives the filled buffer to the reading thread.
+ * \param size Count of decompressed bytes in the buffer.
+ * \param isLast Is it the last buffer?
+ */
+void CDecoder::Filled(size_t size, bool isLast) {
+    pthread_mutex_lock(&m_lock);
+    m_sizes[m_tail] = size;
+    m_tail = (m_tail + 1) % DECODER_BUFFERS;
+    m_cntFilled++;
+    m_isEnded = isLast;
+    pthread_cond_signal(&m_filled);
+    pthread_mutex_unlock(&m_lock);
+}
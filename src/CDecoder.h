@@ -0,0 +1,102 @@
+#ifndef CDECODER_H
+#define	CDECODER_H
+
+#include <cstdlib>
+#include <string>
+#include <exception>
+#include <pthread.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+///! Data are not compressed.
+#define DECODER_NONE 0
+///! Data are compressed by gzip.
+#define DECODER_GZIP 1
+///! Data are compressed by zstd (they are decompressed only if the program is built with HAVE_ZSTD).
+#define DECODER_ZSTD 2
+///! Count of the buffers of decompressed data
+#define DECODER_BUFFERS 4
+///! Size of one buffer of decompressed data
+#define DECODER_BUFFER_SIZE 1048576
+
+///! Class, which decompresses the data (usually mapped file) by its own thread into a ring of buffers,
+///! which are read meanwhile (by the push reader), so the decompression and the parsing run at once.
+///! The format is told by the magic bytes at the start of the data.
+
+class CDecoder {
+public:
+    CDecoder(const char * data, size_t size, const string & filePath);
+    ~CDecoder();
+
+    static int GetFormat(const char * data, size_t size);
+    size_t GetSizeHint() const;
+
+    void Start();
+    const char * Next(size_t & size);
+    void Release();
+protected:
+    static void * DecoderThread(void * decoder);
+    void Decode();
+    bool DecodeBuffer(char * buffer, size_t & size);
+    bool DecodeGzip(char * buffer, size_t & size);
+    bool DecodeZstd(char * buffer, size_t & size);
+    void Corrupted(const char * reason) const;
+    char * Fill();
+    void Filled(size_t size, bool isLast);
+
+    ///! Pointer to the compressed data
+    const char * m_data;
+    ///! Size of the compressed data
+    size_t m_size;
+    ///! Position of the compressed data, which were not given to the decompressor yet
+    size_t m_pos;
+    ///! File name (for exceptions)
+    string m_filePath;
+    ///! Format of the data, specified by constants
+    int m_format;
+    ///! State of gzip decompression
+    z_stream m_zlib;
+#ifdef HAVE_ZSTD
+    ///! State of zstd decompression
+    ZSTD_DStream * m_zstd;
+    ///! Compressed data of zstd decompression
+    ZSTD_inBuffer m_zstdInput;
+    ///! Last result of zstd decompression (0, when a frame was finished)
+    size_t m_zstdResult;
+#endif
+
+    //ring of the buffers
+    ///! Data of the buffers
+    char * m_buffers[DECODER_BUFFERS];
+    ///! Count of decompressed bytes in the buffers
+    size_t m_sizes[DECODER_BUFFERS];
+    ///! Index of the next buffer to be read
+    int m_head;
+    ///! Index of the next buffer to be filled
+    int m_tail;
+    ///! Count of the buffers, which are filled (or read)
+    int m_cntFilled;
+    ///! Was the last buffer filled?
+    bool m_isEnded;
+    ///! Should the decoder thread stop (the data are not read anymore)?
+    bool m_isCanceled;
+    ///! Error of the decoder thread, it is thrown, when the buffers before it are read
+    exception_ptr m_error;
+    ///! Lock of the ring
+    pthread_mutex_t m_lock;
+    ///! Signals, that a buffer was filled (or the decoding ended)
+    pthread_cond_t m_filled;
+    ///! Signals, that a buffer was read (or the decoding is canceled)
+    pthread_cond_t m_released;
+    ///! The decoder thread
+    pthread_t m_thread;
+    ///! Has the thread to be joined?
+    bool m_started;
+};
+
+#endif	/* CDECODER_H */
+
@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "CEncoder.h"
+
+///! Maximal size of data given to zlib at once (it counts in 32 bits)
+#define ENCODER_INPUT_SIZE 1073741824
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new encoder, the compressed stream is started by the first compressed data.
+ * \param format DECODER_GZIP or DECODER_ZSTD (zstd only if it is built with HAVE_ZSTD).
+ */
+CEncoder::CEncoder(int format) {
+    m_format = format;
+    m_input = NULL;
+    m_inputSize = 0;
+    m_isLast = false;
+    m_isDone = true;
+    m_failed = true;
+    m_buffer = NULL;
+
+    if (m_format == DECODER_GZIP) {
+        memset(&m_zlib, 0, sizeof (m_zlib));
+        // 16 means gzip header and trailer
+        m_failed = deflateInit2(&m_zlib, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK;
+    }
+#ifdef HAVE_ZSTD
+    if (m_format == DECODER_ZSTD) {
+        m_zstd = ZSTD_createCStream();
+        m_zstdInput.src = NULL;
+        m_zstdInput.size = 0;
+        m_zstdInput.pos = 0;
+        m_failed = m_zstd == NULL || ZSTD_isError(ZSTD_initCStream(m_zstd, ZSTD_CLEVEL_DEFAULT));
+    }
+#endif
+    if (!m_failed)
+        m_buffer = new char [ENCODER_BUFFER_SIZE];
+}
+
+/*! Frees the state of the compression.
+ */
+CEncoder::~CEncoder() {
+    if (m_format == DECODER_GZIP)
+        deflateEnd(&m_zlib);
+#ifdef HAVE_ZSTD
+    if (m_format == DECODER_ZSTD && m_zstd)
+        ZSTD_freeCStream(m_zstd);
+#endif
+    delete [] m_buffer;
+}
+
+/*! Did the compression fail? The encoder of not supported format fails at once.
+ */
+bool CEncoder::IsFailed() const {
+    return m_failed;
+}
+
+/*! Gives next part of the data to the encoder, it is compressed by Next.
+ * \param data Pointer to the data (they must stay, until they are compressed).
+ * \param size Size of the data.
+ * \param isLast Is it the end of the data (the compressed stream is finished then)?
+ */
+void CEncoder::SetInput(const char * data, size_t size, bool isLast) {
+    m_input = data;
+    m_inputSize = size;
+    m_isLast = isLast;
+    m_isDone = false;
+#ifdef HAVE_ZSTD
+    m_zstdInput.src = data;
+    m_zstdInput.size = size;
+    m_zstdInput.pos = 0;
+#endif
+}
+
+/*! Compresses the input, until the buffer is full or the input is compressed.
+ * \param size Count of compressed bytes in the buffer (it may be 0).
+ * \return Pointer to the buffer, NULL if the input is compressed (or the compression failed).
+ */
+const char * CEncoder::Next(size_t & size) {
+    if (m_isDone || m_failed)
+        return NULL;
+
+    if (m_format == DECODER_GZIP) {
+        if (m_zlib.avail_in == 0 && m_inputSize > 0) {
+            size_t part = m_inputSize < ENCODER_INPUT_SIZE ? m_inputSize : ENCODER_INPUT_SIZE;
+            m_zlib.next_in = (Bytef *) m_input;
+            m_zlib.avail_in = part;
+            m_input += part;
+            m_inputSize -= part;
+        }
+        m_zlib.next_out = (Bytef *) m_buffer;
+        m_zlib.avail_out = ENCODER_BUFFER_SIZE;
+        bool isFinished = m_isLast && m_inputSize == 0;
+        int result = deflate(&m_zlib, isFinished ? Z_FINISH : Z_NO_FLUSH);
+        if (result == Z_STREAM_ERROR) {
+            m_failed = true;
+            return NULL;
+        }
+        size = ENCODER_BUFFER_SIZE - m_zlib.avail_out;
+        //zlib stops only when the buffer is full, or when everything is compressed
+        m_isDone = isFinished ? result == Z_STREAM_END : m_zlib.avail_in == 0 && m_inputSize == 0;
+    }
+#ifdef HAVE_ZSTD
+    if (m_format == DECODER_ZSTD) {
+        ZSTD_outBuffer output = {m_buffer, ENCODER_BUFFER_SIZE, 0};
+        size_t remaining = ZSTD_compressStream(m_zstd, &output, &m_zstdInput);
+        //the frame is ended, when all the data are given to zstd
+        if (!ZSTD_isError(remaining) && m_isLast && m_zstdInput.pos == m_zstdInput.size)
+            remaining = ZSTD_endStream(m_zstd, &output);
+        if (ZSTD_isError(remaining)) {
+            m_failed = true;
+            return NULL;
+        }
+        size = output.pos;
+        m_isDone = m_zstdInput.pos == m_zstdInput.size && (!m_isLast || remaining == 0);
+    }
+#endif
+    return m_buffer;
+}
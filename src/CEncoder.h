@@ -0,0 +1,54 @@
+#ifndef CENCODER_H
+#define	CENCODER_H
+
+#include <cstdlib>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "CDecoder.h"
+
+using namespace std;
+
+///! Size of the buffer of compressed data
+#define ENCODER_BUFFER_SIZE 1048576
+
+///! Class, which compresses the data in the format of the decoder (DECODER_GZIP, DECODER_ZSTD), so compressed
+///! file is saved in its format. The input is given by parts and the compressed data are taken from the buffer,
+///! until the part is compressed.
+
+class CEncoder {
+public:
+    CEncoder(int format);
+    ~CEncoder();
+
+    bool IsFailed() const;
+    void SetInput(const char * data, size_t size, bool isLast);
+    const char * Next(size_t & size);
+protected:
+    ///! Format of the data, specified by constants of the decoder
+    int m_format;
+    ///! State of gzip compression
+    z_stream m_zlib;
+#ifdef HAVE_ZSTD
+    ///! State of zstd compression
+    ZSTD_CStream * m_zstd;
+    ///! Data of zstd compression
+    ZSTD_inBuffer m_zstdInput;
+#endif
+    ///! Pointer to the input, which was not given to the compressor yet
+    const char * m_input;
+    ///! Size of the input, which was not given to the compressor yet (gzip gets it by parts)
+    size_t m_inputSize;
+    ///! Is the input the end of the data?
+    bool m_isLast;
+    ///! Is the input compressed (and the stream finished, if it is the last input)?
+    bool m_isDone;
+    ///! Did the compression fail (or is the format not supported)?
+    bool m_failed;
+    ///! Buffer of compressed data
+    char * m_buffer;
+};
+
+#endif	/* CENCODER_H */
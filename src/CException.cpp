@@ -1,12 +1,25 @@
 #include <iostream>
 
-#include "CGUI.h"
 #include <cstdlib>
+#include <cstring>
+#include <cstdio>
 
 #include "CException.h"
 
+///! Maximal length of the position in the message about invalid XML format
+#define LOCATION_LENGTH 128
+
 using namespace std;
 
+/********************* EXCEPTION *******************************/
+
+/*! Virtual method, which says, if the exception is an error of opening the file, so there is no document after it
+ * (errors of editing keep the document open).
+ */
+bool CException::ClosesFile() const {
+    return false;
+}
+
 /********************* INVALID FILE NAME *******************************/
 
 /*! Creates new exception for invalid file name.
@@ -16,17 +29,20 @@ InvalidFileNameException::InvalidFileNameException(const string & fileName) {
     m_fileName = fileName;
 }
 
-/*! Virtual method for printing the message about invalid file name to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about invalid file name.
  */
-void InvalidFileNameException::Print(CGUI * interface) const {
+string InvalidFileNameException::GetMessage() const {
     string str;
-    interface->SetXMLOpened(false);
-    str.append("Console: ");
-    str.append("File");
+    str.append("File ");
+    str.append(m_fileName);
     str.append(" does not exist!");
-    interface->ConsolePrint(str.c_str());
-    interface->Handler();
+    return str;
+}
+
+/*! The file was not opened.
+ */
+bool InvalidFileNameException::ClosesFile() const {
+    return true;
 }
 
 /********************* INVALID XML TITLE OR ATTRIBUTE *******************************/
@@ -38,22 +54,13 @@ InvalidXMLTitleException::InvalidXMLTitleException(const string & title) {
     m_title = title;
 }
 
-/*! Virtual method for printing the message about invalid XML title or attribute to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about invalid XML title or attribute.
  */
-void InvalidXMLTitleException::Print(CGUI * interface) const {
+string InvalidXMLTitleException::GetMessage() const {
     string str;
-    str.append("Console: ");
     str.append(m_title);
     str.append(" is not valid XML element or attribute title!");
-    if (interface->IsTreeInitialized()) {
-        interface->ConsolePrint(str.c_str());
-        interface->TreeHandler();
-    } else {
-        interface->SetXMLOpened(false);
-        interface->ConsolePrint(str.c_str());
-        interface->Handler();
-    }
+    return str;
 }
 
 /********************* DUPLICATE ATTRIBUTE *******************************/
@@ -65,23 +72,14 @@ AttributeAlreadyExistsException::AttributeAlreadyExistsException(const string &
     m_name = name;
 }
 
-/*! Virtual method for printing the message about duplicate attribute to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about duplicate attribute.
  */
-void AttributeAlreadyExistsException::Print(CGUI * interface) const {
+string AttributeAlreadyExistsException::GetMessage() const {
     string str;
-    str.append("Console: ");
     str.append("Attribute ");
     str.append(m_name);
     str.append(" already exists!");
-    if (interface->IsTreeInitialized()) {
-        interface->ConsolePrint(str.c_str());
-        interface->TreeHandler();
-    } else {
-        interface->SetXMLOpened(false);
-        interface->ConsolePrint(str.c_str());
-        interface->Handler();
-    }
+    return str;
 }
 
 /********************* NONEXISTING ATTRIBUTE *******************************/
@@ -93,23 +91,14 @@ AttributeDoesNotExistException::AttributeDoesNotExistException(const string & na
     m_name = name;
 }
 
-/*! Virtual method for printing the message about not existing attribute to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about not existing attribute.
  */
-void AttributeDoesNotExistException::Print(CGUI * interface) const {
+string AttributeDoesNotExistException::GetMessage() const {
     string str;
-    str.append("Console: ");
     str.append("Attribute ");
     str.append(m_name);
     str.append(" does not exist!");
-    if (interface->IsTreeInitialized()) {
-        interface->ConsolePrint(str.c_str());
-        interface->TreeHandler();
-    } else {
-        interface->SetXMLOpened(false);
-        interface->ConsolePrint(str.c_str());
-        interface->Handler();
-    }
+    return str;
 }
 
 /********************* INVALID CHILD ID *******************************/
@@ -121,22 +110,13 @@ InvalidChildID::InvalidChildID(int id) {
     m_id = id;
 }
 
-/*! Virtual method for printing the message about invalid child id to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about invalid child id.
  */
-void InvalidChildID::Print(CGUI * interface) const {
+string InvalidChildID::GetMessage() const {
     string str;
-    str.append("Console: ");
     str.append("This child id");
     str.append(" does not exist!");
-    if (interface->IsTreeInitialized()) {
-        interface->ConsolePrint(str.c_str());
-        interface->TreeHandler();
-    } else {
-        interface->SetXMLOpened(false);
-        interface->ConsolePrint(str.c_str());
-        interface->Handler();
-    }
+    return str;
 }
 
 /********************* INVALID XML FORMAT *******************************/
@@ -146,18 +126,105 @@ void InvalidChildID::Print(CGUI * interface) const {
  */
 InvalidXMLFormatException::InvalidXMLFormatException(const string & fileName) {
     m_fileName = fileName;
+    m_offset = 0;
+    m_line = 0;
+    m_column = 0;
+}
+
+/*! Creates new exception for invalid XML format at given position, it is shown after Locate.
+ * \param fileName Name of the file.
+ * \param offset Position of the error in the read data.
+ */
+InvalidXMLFormatException::InvalidXMLFormatException(const string & fileName, size_t offset) {
+    m_fileName = fileName;
+    m_offset = offset;
+    m_line = 0;
+    m_column = 0;
 }
 
-/*! Virtual method for printing the message about invalid XML format to the console.
- * \param interface Pointer to the interface, where the message will be displayed.
+/*! Virtual method for getting the message about invalid XML format.
  */
-void InvalidXMLFormatException::Print(CGUI * interface) const {
+string InvalidXMLFormatException::GetMessage() const {
     string str;
-    interface->SetXMLOpened(false);
-    str.append("Console: ");
     str.append("File ");
     str.append(m_fileName);
-    str.append(" is not a valid XML document!");
-    interface->ConsolePrint(str.c_str());
-    interface->Handler();
-}
\ No newline at end of file
+    str.append(" is not a valid XML document");
+    if (m_line > 0) {
+        char position[LOCATION_LENGTH];
+        snprintf(position, LOCATION_LENGTH, " (line %lu, column %lu, byte %lu)",
+                (unsigned long) m_line, (unsigned long) m_column, (unsigned long) m_offset);
+        str.append(position);
+    }
+    str.append("!");
+    if (!m_reason.empty()) {
+        str.append(" ");
+        str.append(m_reason);
+    }
+    return str;
+}
+
+/*! Counts the line and column of the error, the data must be the whole file (errors of parts are not located).
+ * \param data Pointer to the data, where the error was found.
+ * \param size Size of the data.
+ */
+void InvalidXMLFormatException::Locate(const char * data, size_t size) {
+    if (m_offset > size)
+        m_offset = size;
+    m_line = 1;
+    size_t lineStart = 0;
+    const char * end = data + m_offset;
+    for (const char * p = data; (p = (const char *) memchr(p, 10, end - p)) != NULL; p++) {
+        m_line++;
+        lineStart = p + 1 - data;
+    }
+    m_column = m_offset - lineStart + 1;
+}
+
+/*! Sets the position of the error, which was counted by the reader (like in a stream, which is not kept).
+ * \param offset Position of the error from the start of the file.
+ * \param line Line of the error (from 1).
+ * \param column Column of the error (from 1, in bytes).
+ */
+void InvalidXMLFormatException::SetPosition(size_t offset, size_t line, size_t column) {
+    m_offset = offset;
+    m_line = line;
+    m_column = column;
+}
+
+/*! Sets the description of the error (like message of other exception found at the position).
+ * \param reason The description.
+ */
+void InvalidXMLFormatException::SetReason(const string & reason) {
+    m_reason = reason;
+}
+
+/*! Gets the position of the error in the read data.
+ */
+size_t InvalidXMLFormatException::GetOffset() const {
+    return m_offset;
+}
+
+/*! The file was not opened.
+ */
+bool InvalidXMLFormatException::ClosesFile() const {
+    return true;
+}
+
+/********************* LOADING CANCELED *******************************/
+
+/*! Creates new exception for canceled loading.
+ */
+LoadingCanceledException::LoadingCanceledException() {
+}
+
+/*! Virtual method for getting the message about canceled loading.
+ */
+string LoadingCanceledException::GetMessage() const {
+    return "Loading canceled.";
+}
+
+/*! The file was not opened.
+ */
+bool LoadingCanceledException::ClosesFile() const {
+    return true;
+}
@@ -1,8 +1,6 @@
 #ifndef CEXCEPTION_H
 #define	CEXCEPTION_H
 
-#include "CGUI.h"
-
 #include <cstdlib>
 #include <iostream>
 #include <string>
@@ -16,7 +14,8 @@ public:
 
     CException() {
     };
-    virtual void Print(CGUI * interface) const = 0;
+    virtual string GetMessage() const = 0;
+    virtual bool ClosesFile() const;
 };
 
 /****************************************************/
@@ -26,7 +25,8 @@ public:
 class InvalidFileNameException : public CException {
 public:
     InvalidFileNameException(const string & fileName);
-    virtual void Print(CGUI * interface) const;
+    virtual string GetMessage() const;
+    virtual bool ClosesFile() const;
 protected:
     ///! Name of nonexisting file.
     string m_fileName;
@@ -39,7 +39,7 @@ protected:
 class InvalidXMLTitleException : public CException {
 public:
     InvalidXMLTitleException(const string & title);
-    virtual void Print(CGUI * interface) const;
+    virtual string GetMessage() const;
 protected:
     ///! Title of invalid XML node.
     string m_title;
@@ -52,7 +52,7 @@ protected:
 class AttributeAlreadyExistsException : public CException {
 public:
     AttributeAlreadyExistsException(const string & name);
-    virtual void Print(CGUI * interface) const;
+    virtual string GetMessage() const;
 protected:
     ///! Duplicate attribute name
     string m_name;
@@ -65,7 +65,7 @@ protected:
 class AttributeDoesNotExistException : public CException {
 public:
     AttributeDoesNotExistException(const string & name);
-    virtual void Print(CGUI * interface) const;
+    virtual string GetMessage() const;
 protected:
     ///! Nonexisting attribute name.
     string m_name;
@@ -78,7 +78,7 @@ protected:
 class InvalidChildID : public CException {
 public:
     InvalidChildID(int id);
-    virtual void Print(CGUI * interface) const;
+    virtual string GetMessage() const;
 protected:
     ///! Nonexisting attribute ID.
     int m_id;
@@ -91,10 +91,36 @@ protected:
 class InvalidXMLFormatException : public CException {
 public:
     InvalidXMLFormatException(const string & fileName);
-    virtual void Print(CGUI * interface) const;
+    InvalidXMLFormatException(const string & fileName, size_t offset);
+    virtual string GetMessage() const;
+    virtual bool ClosesFile() const;
+
+    void Locate(const char * data, size_t size);
+    void SetPosition(size_t offset, size_t line, size_t column);
+    void SetReason(const string & reason);
+    size_t GetOffset() const;
 protected:
     ///! File name of invalid formated XML.
     string m_fileName;
+    ///! Position of the error in the read data.
+    size_t m_offset;
+    ///! Line of the error (from 1), 0 if the error is not located.
+    size_t m_line;
+    ///! Column of the error (from 1, in bytes).
+    size_t m_column;
+    ///! What is wrong at the position (may be empty).
+    string m_reason;
+};
+
+/****************************************************/
+
+///! Class for exception, which is thrown, when the user canceled the loading of XML file.
+
+class LoadingCanceledException : public CException {
+public:
+    LoadingCanceledException();
+    virtual string GetMessage() const;
+    virtual bool ClosesFile() const;
 };
 
 #endif	/* CEXCEPTION_H */
@@ -5,13 +5,15 @@
 
 #include "CGUI.h"
 #include "CNode.h"
+#include "CText.h"
 #include "CXML.h"
 #include "functions.h"
 #include "CException.h"
+#include "CProgress.h"
 
 ///! When reallocing, how many times will new array will be bigger
 #define REALLOC_CONSTANT 2
-///! Start size of main XML tree
+///! Start size of attributes list
 #define DEFAULT_MENU_ITEMS_COUNT 100
 ///! Height of control window
 #define CONTROLS_LINES 3
@@ -24,21 +26,23 @@
 ///! Maximum of chars in user input
 #define MAX_INPUT 2500
 
+///! How often the progress of the loading or saving is shown (in milliseconds)
+#define PROGRESS_REFRESH 100
+///! How long the interface waits for the loading thread to let it see the tree (in milliseconds)
+#define LOADING_WAIT 20
+///! Count of characters of the progress bar
+#define PROGRESS_BAR_WIDTH 20
+
 /********************* PUBLIC METHODS *******************************/
 
 /*! Initializes the curses environment and creates new windows.
  * \param openingXML Was the XML opened from the command line?.
  */
 CGUI::CGUI(bool openingXML) {
-    //allocates the space for tree
-    m_menuItems = new ITEM * [DEFAULT_MENU_ITEMS_COUNT];
-    m_nodes = new CNode * [DEFAULT_MENU_ITEMS_COUNT];
-    for (int i = 0; i < DEFAULT_MENU_ITEMS_COUNT; i++) {
-        m_menuItems[i] = NULL;
-        m_nodes[i] = NULL;
-    }
-    m_cntNodes = 0;
-    m_menuSize = DEFAULT_MENU_ITEMS_COUNT;
+    //the tree is shown from the first row
+    m_current = 0;
+    m_top = 0;
+    m_attributesTexts = NULL;
 
     //sets state
     m_xmlOpened = openingXML;
@@ -87,30 +91,21 @@ CGUI::~CGUI() {
     if (m_xmlOpened) {
         delete m_xmlfile;
     }
-    delete [] m_menuItems;
-    delete [] m_nodes;
+    delete [] m_attributesTexts;
 }
 
 /********************* INSERTING TO MENUS METHODS *******************************/
 
-/*! Inserts an item to main tree.
- * \param name Text of the item.
- * \param node Pointer to node bound with this text.
- * \param type P means parent node, T means text node, S means simple node and C means comment node
- */
-void CGUI::AddMenuItem(const string* name, CNode * node, const char * type) {
-    ReallocItems(); //ensure that the array is not full
-    m_menuItems[m_cntNodes] = new_item(name->c_str(), type);
-    m_nodes[m_cntNodes++] = node;
-}
-
 /*! Inserts an item to an attributes menu.
- * \param name Name of attribute.
- * \param value Value of an attribute.
+ * \param name Name of attribute (it is copied).
+ * \param value Value of an attribute (it is copied).
  */
-void CGUI::AddAttributeItem(const string* name, const string* value) {
+void CGUI::AddAttributeItem(const CText & name, const CText & value) {
     ReallocAttributes(); //ensure that the array is not full
-    m_attributesItems[m_cntAttributes++] = new_item(name->c_str(), value->c_str());
+    char ** texts = m_attributesTexts + 2 * m_cntAttributes;
+    texts[0] = CopyText(name.GetData(), name.GetLength());
+    texts[1] = CopyText(value.GetData(), value.GetLength());
+    m_attributesItems[m_cntAttributes++] = new_item(texts[0], texts[1]);
 }
 
 /********************* PUBLIC USER INPUT HANDLERS *******************************/
@@ -119,7 +114,8 @@ void CGUI::AddAttributeItem(const string* name, const string* value) {
  */
 void CGUI::TreeHandler() {
     int c; //to get id of pressed key
-    int id; // id of current menu item
+    int id; // row of current node
+    CNode * node; // current node
     char str[MAX_INPUT]; //for user string input
     string title; //for user string input
 
@@ -131,73 +127,67 @@ void CGUI::TreeHandler() {
     while ((c = wgetch(m_tree.win)) != KEY_F(12)) {
         switch (c) {
             case KEY_DOWN: //down arrow button
-                menu_driver(m_menu, REQ_DOWN_ITEM);
+                MoveCursor(m_current + 1);
                 ConsolePrint("Console:");
                 break;
             case KEY_UP: //up arrow button
-                menu_driver(m_menu, REQ_UP_ITEM);
+                MoveCursor(m_current - 1);
                 ConsolePrint("Console:");
                 break;
             case KEY_NPAGE: //page down button
-                menu_driver(m_menu, REQ_SCR_DPAGE);
+                m_top += m_tree.height;
+                MoveCursor(m_current + m_tree.height);
                 ConsolePrint("Console:");
                 break;
             case KEY_PPAGE://page up button
-                menu_driver(m_menu, REQ_SCR_UPAGE);
+                m_top -= m_tree.height;
+                MoveCursor(m_current - m_tree.height);
+                ConsolePrint("Console:");
+                break;
+            case KEY_HOME: //home button
+                MoveCursor(0);
+                ConsolePrint("Console:");
+                break;
+            case KEY_END: //end button
+                MoveCursor(m_xmlfile->GetRowCount() - 1);
                 ConsolePrint("Console:");
                 break;
 
             case KEY_F(2):// F2 - Expand current node
-                id = item_index(current_item(m_menu));
-
-                m_nodes[id]->Expand();
+                if (!m_xmlfile->GetRowCount())
+                    break;
 
-                //whole tree has to be build again
-                TreeDestroy();
-                m_xmlfile->Show();
+                //rows of the descendants are inserted, the cursor stays
+                m_xmlfile->ExpandRow(m_current);
                 TreeInit();
-
-                //highlight current item again
-                while (item_index(current_item(m_menu)) != id) {
-                    menu_driver(m_menu, REQ_DOWN_ITEM);
-                }
                 ConsolePrint("Console:");
                 break;
             case KEY_F(3): //F3 - Collapse current node
-                id = item_index(current_item(m_menu));
-
-                m_nodes[id]->Collapse();
+                if (!m_xmlfile->GetRowCount())
+                    break;
 
-                //whole tree has to be build again
-                TreeDestroy();
-                m_xmlfile->Show();
+                //rows of the descendants are removed, the cursor stays
+                m_xmlfile->CollapseRow(m_current);
                 TreeInit();
-                //highlight current item again
-                while (item_index(current_item(m_menu)) != id) {
-                    menu_driver(m_menu, REQ_DOWN_ITEM);
-                }
                 ConsolePrint("Console:");
                 break;
 
             case KEY_F(4): // F4 - Show attributes of current node and enable their editing
-                id = item_index(current_item(m_menu));
+                if (!m_xmlfile->GetRowCount())
+                    break;
+                id = m_current;
 
                 //comment nodes doesn't have attributes
-                if (m_nodes[id]->HasAttributes()) {
+                if (m_xmlfile->GetRowNode(id)->HasAttributes()) {
                     ConsolePrint("Console:");
+                    m_xmlfile->WaitForSnapshot();
 
                     //change the environment and handling
                     PostAttributesControlWindow();
                     AttributesHandler(id);
 
-                    //rebuild the tree
-                    m_xmlfile->Show();
+                    //show the tree again, its rows did not change
                     TreeInit();
-
-                    //scroll to the current item
-                    while (item_index(current_item(m_menu)) != id) {
-                        menu_driver(m_menu, REQ_DOWN_ITEM);
-                    }
                     ConsolePrint("Console: Finished editing attributes.");
                     PostDefaultControlWindow();
                 } else {
@@ -206,26 +196,21 @@ void CGUI::TreeHandler() {
                 break;
 
             case KEY_F(5): //F5 - inserting new node
-                if (m_cntNodes) { //if we are inserting to a given node
-                    id = item_index(current_item(m_menu));
+                //titles of new nodes are added to the atoms, which the saving thread may be reading
+                m_xmlfile->WaitForSnapshot();
+                if (m_xmlfile->GetRowCount()) { //if we are inserting to a given node
+                    id = m_current;
 
                     //inserting is allowed only for parent nodes
-                    if (m_nodes[id]->HasChilds()) {
+                    if (m_xmlfile->GetRowNode(id)->HasChilds()) {
                         ConsolePrint("Console: Which node do you want to create?");
 
                         //change to inserting environment
                         PostInsertingControlWindow();
                         InsertingHandler(id);
 
-                        //rebuild the tree
-                        TreeDestroy();
-                        m_xmlfile->Show();
+                        //rows of new node are inserted already
                         TreeInit();
-
-                        //scroll to the current item
-                        while (item_index(current_item(m_menu)) != id) {
-                            menu_driver(m_menu, REQ_DOWN_ITEM);
-                        }
                         ConsolePrint("Console: Finished inserting node.");
                         PostDefaultControlWindow();
 
@@ -240,9 +225,7 @@ void CGUI::TreeHandler() {
                     PostInsertingControlWindow();
                     InsertingHandler(INSERTING_TO_ROOT);
 
-                    //rebuild the tree
-                    TreeDestroy();
-                    m_xmlfile->Show();
+                    //rows of new root are listed already
                     TreeInit();
 
                     ConsolePrint("Console: Finished inserting node.");
@@ -251,27 +234,11 @@ void CGUI::TreeHandler() {
                 break;
 
             case KEY_F(6): //F6 - Removing nodes
-                id = item_index(current_item(m_menu));
-                //deleting a node with a parent
-                if (m_nodes[id]->GetParent() != NULL)
-                    m_nodes[id]->GetParent()->DeleteNode(m_nodes[id]->GetID());
-                else {
-                    //deleting root node
-                    delete m_nodes[id];
-                    m_xmlfile->SetRoot(NULL);
-                }
-
-                //rebuild the tree
-                TreeDestroy();
-                m_xmlfile->Show();
-                TreeInit();
-
-                //scroll to previous item (if there is any)
-                if (m_cntNodes) {
-                    while (item_index(current_item(m_menu)) != id - 1 && id != 0) {
-                        menu_driver(m_menu, REQ_DOWN_ITEM);
-                    }
-                }
+                if (!m_xmlfile->GetRowCount())
+                    break;
+                //rows of the node are removed, the cursor moves to previous item (if there is any)
+                m_xmlfile->DeleteRow(m_current);
+                MoveCursor(m_current - 1);
                 ConsolePrint("Console: Node successfully deleted.");
                 break;
 
@@ -284,19 +251,35 @@ void CGUI::TreeHandler() {
                 noecho();
                 title = str;
 
-                //process filtering 
+                //process filtering, the cursor stays on its node, if it is still visible
+                node = m_xmlfile->GetRowCount() ? m_xmlfile->GetRowNode(m_current) : NULL;
                 m_xmlfile->Filter(title);
 
                 //rebuild the tree
                 TreeDestroy();
                 m_xmlfile->Show();
-                TreeInit();
+                m_top = 0;
+                MoveCursor(node ? m_xmlfile->FindRow(node) : 0);
                 ConsolePrint("Console: Filtered.");
                 break;
 
+            case KEY_F(10): //F10 - Going to a node, row, page or percentage
+                ConsolePrint("Go to (/path/to[2]/node, row, +pages, -pages or percent%): ");
+
+                //user input
+                echo();
+                wgetnstr(m_console.win, str, MAX_INPUT);
+                noecho();
+                title = str;
+
+                GoTo(title);
+                break;
+
             case KEY_F(8): //F8 - Saving the file
+                //the tree is serialized and written in the background, it can be edited, when its snapshot is complete
                 m_xmlfile->Save();
-                ConsolePrint("Console: File saved.");
+                wtimeout(m_tree.win, PROGRESS_REFRESH);
+                ShowSaving();
                 break;
 
             case KEY_F(9): //F9 - Opening new file
@@ -312,23 +295,23 @@ void CGUI::TreeHandler() {
                 m_xmlOpened = false;
                 m_treeInitialized = false;
 
-                //try to open the file
+                //try to open the file, it is loaded in the background
                 try {
-                    m_xmlfile = OpenFile(m_xmlfile, title, this);
+                    m_xmlfile = OpenFile(m_xmlfile, title);
+                    LoadingHandler();
                 } catch (const CException & e) {
                     wclear(m_tree.win);
                     wborder(m_tree.win, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
-                    e.Print(this);
+                    ErrorHandler(e);
                     return;
                 }
+                //if successful, the tree is shown already
                 m_xmlOpened = true;
-                wclear(m_tree.win);
-                wborder(m_tree.win, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
+                ConsolePrint("Console:");
+                break;
 
-                //if successful, rebuild the tree
-                TreeDestroy();
-                m_xmlfile->Show();
-                TreeInit();
+            case ERR: //no key was pressed in time, while the file is saved
+                ShowSaving();
                 break;
         }
         wrefresh(m_tree.win);
@@ -360,22 +343,18 @@ void CGUI::Handler() {
                 m_xmlOpened = false;
                 m_treeInitialized = false;
 
-                //trying to open the file
+                //trying to open the file, it is loaded in the background
                 try {
-                    m_xmlfile = OpenFile(NULL, file, this);
+                    m_xmlfile = OpenFile(NULL, file);
+                    LoadingHandler();
                 } catch (const CException & e) {
-                    e.Print(this);
+                    ErrorHandler(e);
                     return;
                 }
                 
+                //if successful, the tree is shown already
                 m_xmlOpened = true;
-                wclear(m_tree.win);
-                wborder(m_tree.win, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
-
-                //if successful, rebuild the tree
-                TreeDestroy();
-                m_xmlfile->Show();
-                TreeInit();
+                ConsolePrint("Console:");
 
                 //... and give handling to the Tree Handler
                 TreeHandler();
@@ -385,25 +364,86 @@ void CGUI::Handler() {
     }
 }
 
+/*! A loop, which shows the progress of the loading of the XML file. The user can browse the complete childs
+ * of the root meanwhile and cancel the loading by F12. When the loading ends, the whole tree is shown.
+ */
+void CGUI::LoadingHandler() {
+    int c; //to get id of pressed key
+    CNode * node = NULL; //node of the cursor
+    CProgress * progress = m_xmlfile->GetProgress();
 
-/********************* MENU INITIALIZERS AND DESTROYERS *******************************/
+    m_current = m_top = 0;
+    TreeDestroy();
+    wrefresh(m_tree.win);
+    PostLoadingControlWindow();
+    PrintProgress("Loading", progress);
+
+    //keys are read with timeout, so the progress is refreshed
+    wtimeout(m_tree.win, PROGRESS_REFRESH);
+    while (!progress->IsFinished()) {
+        c = wgetch(m_tree.win);
+        if (c == KEY_F(12))
+            progress->Cancel();
+
+        //the tree can be seen only between the nodes parsed by the loading thread
+        if (progress->TryLock(LOADING_WAIT)) {
+            if (!progress->IsFinished()) {
+                try {
+                    BrowseLoaded(c);
+                } catch (const CException & e) {
+                    //the loading is stopped with the document
+                    progress->Unlock();
+                    wtimeout(m_tree.win, -1);
+                    delete m_xmlfile;
+                    m_xmlfile = NULL;
+                    throw;
+                }
+                node = m_xmlfile->GetRowCount() ? m_xmlfile->GetRowNode(m_current) : NULL;
+            }
+            progress->Unlock();
+        }
+        PrintProgress("Loading", progress);
+    }
+    wtimeout(m_tree.win, -1);
 
-/*! Initializes the XML tree (creates the menu)
- */
-void CGUI::TreeInit() {
-    //load attributes
-    m_menu = new_menu((ITEM **) m_menuItems);
+    //errors of the loading are thrown here
+    try {
+        m_xmlfile->FinishLoading();
+    } catch (const CException & e) {
+        delete m_xmlfile;
+        m_xmlfile = NULL;
+        throw;
+    }
 
-    wclear(m_tree.win);
+    //the cursor stays on its node
+    PostDefaultControlWindow();
+    MoveCursor(node ? m_xmlfile->FindRow(node) : 0);
+}
 
-    //specify menu's details
-    set_menu_win(m_menu, m_tree.win);
-    set_menu_sub(m_menu, derwin(m_tree.win, m_tree.height, m_tree.width, 1, 1));
-    set_menu_mark(m_menu, " -> ");
-    set_menu_format(m_menu, m_tree.height, 1);
+/*! Prints the message of the exception to the console and gives the handling back.
+ * Errors of editing return to the tree, after errors of opening there is no XML file.
+ * \param e The exception.
+ */
+void CGUI::ErrorHandler(const CException & e) {
+    string str;
+    str.append("Console: ");
+    str.append(e.GetMessage());
+    if (!e.ClosesFile() && IsTreeInitialized()) {
+        ConsolePrint(str.c_str());
+        TreeHandler();
+    } else {
+        SetXMLOpened(false);
+        ConsolePrint(str.c_str());
+        Handler();
+    }
+}
 
-    post_menu(m_menu);
-    wrefresh(m_tree.win);
+/********************* MENU INITIALIZERS AND DESTROYERS *******************************/
+
+/*! Shows the XML tree, the cursor stays on its row (if the row still exists).
+ */
+void CGUI::TreeInit() {
+    MoveCursor(m_current);
 }
 
 /*! Initializes the attributes list for given node. (creates the menu)
@@ -424,25 +464,10 @@ void CGUI::AttributesInit() {
     wrefresh(m_tree.win);
 }
 
-/*! Frees and removes the XML tree and menu.
+/*! Removes the XML tree from the window.
  */
 void CGUI::TreeDestroy() {
-    if (m_xmlOpened) {
-        unpost_menu(m_menu);
-        free_menu(m_menu);
-    }
-    for (int i = 0; i < m_cntNodes; i++) {
-        free_item(m_menuItems[i]);
-    }
-
-    //be ready for new items inserting
-    m_menuItems = new ITEM * [m_menuSize];
-    for (int i = 0; i < m_menuSize; i++) {
-
-        m_menuItems[i] = NULL;
-        m_nodes[i] = NULL;
-    }
-    m_cntNodes = 0;
+    werase(m_tree.win);
 }
 
 /*! Frees and removes the attributes tree and menu.
@@ -452,6 +477,9 @@ void CGUI::AttributesDestroy() {
     free_menu(m_attributes);
     for (int i = 0; i < m_cntAttributes; i++) {
         free_item(m_attributesItems[i]);
+        delete [] m_attributesTexts[2 * i];
+        delete [] m_attributesTexts[2 * i + 1];
+        m_attributesTexts[2 * i] = m_attributesTexts[2 * i + 1] = NULL;
     }
 
     //be ready for new items inserting
@@ -472,10 +500,10 @@ void CGUI::ConsolePrint(const char * str) {
     wborder(m_console.win, ' ', ' ', '-', ' ', '+', '+', ' ', ' ');
     //print file name only if it is opened
     if (m_xmlOpened) {
-        mvwprintw(m_console.win, 1, 0, m_xmlfile->GetFilePath().c_str());
-        mvwprintw(m_console.win, 1, m_xmlfile->GetFilePath().length() + 1, str);
+        mvwprintw(m_console.win, 1, 0, "%s", m_xmlfile->GetFilePath().c_str());
+        mvwprintw(m_console.win, 1, m_xmlfile->GetFilePath().length() + 1, "%s", str);
     } else {
-        mvwprintw(m_console.win, 1, 0, str);
+        mvwprintw(m_console.win, 1, 0, "%s", str);
     }
     wrefresh(m_console.win);
 }
@@ -585,7 +613,9 @@ void CGUI::PostDefaultControlWindow() {
     mvwprintw(m_control.win, 2, 25 + 3 * gap, "|");
     mvwprintw(m_control.win, 2, 26 + 4 * gap, "[F9] Open");
     mvwprintw(m_control.win, 2, 41 + 5 * gap, "|");
-    mvwprintw(m_control.win, 2, 42 + 6 * gap, "[F12] Quit");
+    mvwprintw(m_control.win, 2, 42 + 6 * gap, "[F10] Go to");
+    mvwprintw(m_control.win, 2, 58 + 7 * gap, "|");
+    mvwprintw(m_control.win, 2, 59 + 8 * gap, "[F12] Quit");
     wrefresh(m_control.win);
 }
 
@@ -636,6 +666,21 @@ void CGUI::PostStartControlWindow() {
     wrefresh(m_control.win);
 }
 
+/*! Posts control hints for browsing the tree, while it is loaded.
+ */
+void CGUI::PostLoadingControlWindow() {
+    wclear(m_control.win);
+    wborder(m_control.win, ' ', ' ', '-', ' ', '+', '+', ' ', ' ');
+    int gap = (COLS - 11 - 13 - 15 - 16 - 11) / 8;
+
+    mvwprintw(m_control.win, 1, 0, "[F2] Expand");
+    mvwprintw(m_control.win, 1, 11 + gap, "|");
+    mvwprintw(m_control.win, 1, 12 + 2 * gap, "[F3] Collapse");
+    mvwprintw(m_control.win, 1, 25 + 3 * gap, "|");
+    mvwprintw(m_control.win, 1, 26 + 4 * gap, "[F12] Cancel");
+    wrefresh(m_control.win);
+}
+
 /********************* PRIVATE USER INPUT HANDLERS *******************************/
 
 /*! An infinite loop, which allows the user to perform wanted actions while inserting node to an XML tree.
@@ -661,16 +706,15 @@ void CGUI::InsertingHandler(int id) {
                 title = str;
 
                 //creating new node
-                node = new CParentNode(title);
+                node = new (m_xmlfile->GetArena()) CParentNode(title);
                 if (id == INSERTING_TO_ROOT) {
                     m_xmlfile->SetRoot(node);
                 } else {
-                    m_nodes[id]->InsertNode(node);
+                    m_xmlfile->InsertNode(id, node);
                 }
                 return;
             case 'T':
             case 't': //T - inserting new text node
-                menu_driver(m_menu, REQ_UP_ITEM);
                 ConsolePrint("Enter node title: ");
 
                 //user input
@@ -685,16 +729,15 @@ void CGUI::InsertingHandler(int id) {
                 text = txt;
 
                 //creating new node
-                node = new CTextNode(title, text);
+                node = new (m_xmlfile->GetArena()) CTextNode(title, text);
                 if (id == INSERTING_TO_ROOT) {
                     m_xmlfile->SetRoot(node);
                 } else {
-                    m_nodes[id]->InsertNode(node);
+                    m_xmlfile->InsertNode(id, node);
                 }
                 return;
             case 'C':
             case 'c': //C - comment node
-                menu_driver(m_menu, REQ_UP_ITEM);
                 ConsolePrint("Enter comment text: ");
 
                 //user input
@@ -704,16 +747,15 @@ void CGUI::InsertingHandler(int id) {
                 text = txt;
 
                 //inserting new node
-                node = new CCommentNode(text);
+                node = new (m_xmlfile->GetArena()) CCommentNode(text);
                 if (id == INSERTING_TO_ROOT) {
                     m_xmlfile->SetRoot(node);
                 } else {
-                    m_nodes[id]->InsertNode(node);
+                    m_xmlfile->InsertNode(id, node);
                 }
                 return;
             case 'S':
             case 's': //S - new simple node
-                menu_driver(m_menu, REQ_UP_ITEM);
                 ConsolePrint("Enter node title: ");
 
                 //user input
@@ -723,11 +765,11 @@ void CGUI::InsertingHandler(int id) {
                 title = str;
 
                 //inserting new node
-                node = new CSimpleNode(title);
+                node = new (m_xmlfile->GetArena()) CSimpleNode(title);
                 if (id == INSERTING_TO_ROOT) {
                     m_xmlfile->SetRoot(node);
                 } else {
-                    m_nodes[id]->InsertNode(node);
+                    m_xmlfile->InsertNode(id, node);
                 }
                 return;
         }
@@ -743,17 +785,21 @@ void CGUI::AttributesHandler(int id) {
     char str[MAX_INPUT], val[MAX_INPUT]; //for user input
     string name, value; //for user input
     CAttribute * attribute; //for new attribute
+    CNode * node = m_xmlfile->GetRowNode(id); //node of the attributes
 
     //allocates the attribute menu
     m_attributesItems = new ITEM * [DEFAULT_MENU_ITEMS_COUNT];
+    delete [] m_attributesTexts;
+    m_attributesTexts = new char * [2 * DEFAULT_MENU_ITEMS_COUNT];
     for (int i = 0; i < DEFAULT_MENU_ITEMS_COUNT; i++) {
         m_attributesItems[i] = NULL;
+        m_attributesTexts[2 * i] = m_attributesTexts[2 * i + 1] = NULL;
     }
     m_cntAttributes = 0;
     m_attributesSize = DEFAULT_MENU_ITEMS_COUNT;
 
     //fills it with attributes
-    m_nodes[id]->GetAttributes(this);
+    ListAttributes(node);
 
     //and creates the list of attributes
     TreeDestroy();
@@ -795,14 +841,9 @@ void CGUI::AttributesHandler(int id) {
 
                 AttributesDestroy();
                 //inserts the attribute
-                attribute = new CAttribute(name, value);
-
-                //it has to rebuild the tree to insert it
-                m_xmlfile->Show();
-                m_nodes[id]->InsertAttribute(attribute);
-                m_nodes[id]->GetAttributes(this);
-                TreeInit();
-                TreeDestroy();
+                attribute = new (m_xmlfile->GetArena()) CAttribute(name, value);
+                node->InsertAttribute(attribute);
+                ListAttributes(node);
 
                 //rebuilds the list of attributes
                 AttributesInit();
@@ -813,12 +854,9 @@ void CGUI::AttributesHandler(int id) {
                 name = item_name(current_item(m_attributes));
                 AttributesDestroy();
 
-                //it has to rebuild the tree to insert it
-                m_xmlfile->Show();
-                m_nodes[id]->RemoveAttribute(name);
-                m_nodes[id]->GetAttributes(this);
-                TreeInit();
-                TreeDestroy();
+                //removes the attribute
+                node->RemoveAttribute(name);
+                ListAttributes(node);
 
                 //rebuilds the list
                 AttributesInit();
@@ -837,53 +875,145 @@ void CGUI::AttributesHandler(int id) {
     AttributesDestroy();
 }
 
-/********************* MEMORY MANAGEMENT TOOLS *******************************/
-
-/*! Handles the arrays used by main tree.
+/*! Fills the attributes menu with the attributes of the node.
+ * \param node The node.
  */
-void CGUI::ReallocItems() {
-    if (m_cntNodes > m_menuSize - 2) {
-        ITEM ** tmp = new ITEM * [REALLOC_CONSTANT * m_menuSize];
-        CNode ** tmp_node = new CNode * [REALLOC_CONSTANT * m_menuSize];
+void CGUI::ListAttributes(CNode * node) {
+    for (int i = 0; i < node->GetAttributeCount(); i++)
+        AddAttributeItem(node->GetAttribute(i)->GetNameText(), node->GetAttribute(i)->GetValueText());
+}
 
-        for (int i = 0; i < REALLOC_CONSTANT * m_menuSize; i++) {
-            tmp[i] = NULL;
-            tmp_node[i] = NULL;
-        }
+/********************* TREE VIEW *******************************/
 
-        for (int i = 0; i < m_cntNodes; i++) {
-            tmp[i] = m_menuItems[i];
-            tmp_node[i] = m_nodes[i];
+/*! Prints the rows of the tree, which are in the window, texts of the rows are made by nodes,
+ * only if the nodes changed.
+ */
+void CGUI::TreeDraw() {
+    string line;
+    int cnt = m_xmlfile->GetRowCount();
+
+    werase(m_tree.win);
+    for (int i = 0; i < m_tree.height && m_top + i < cnt; i++) {
+        int row = m_top + i;
+        CText text = m_xmlfile->GetRowText(row);
+
+        //mark of the cursor, type of the node and its text
+        line = row == m_current ? " -> " : "    ";
+        line += m_xmlfile->GetRowNode(row)->GetType();
+        line += ' ';
+        line.append(text.GetData(), text.GetLength() < (size_t) m_tree.width ? text.GetLength() : m_tree.width);
+        if ((int) line.length() >= m_tree.width)
+            line.resize(m_tree.width - 1);
+
+        //new lines and tabs of the values would break the window
+        for (size_t j = 0; j < line.length(); j++) {
+            if ((unsigned char) line[j] < ' ')
+                line[j] = ' ';
         }
 
-        m_menuSize = REALLOC_CONSTANT*m_menuSize;
-        delete [] m_menuItems;
-        delete [] m_nodes;
-        m_menuItems = tmp;
-        m_nodes = tmp_node;
+        if (row == m_current)
+            wattron(m_tree.win, A_REVERSE);
+        mvwaddstr(m_tree.win, i, 0, line.c_str());
+        if (row == m_current)
+            wattroff(m_tree.win, A_REVERSE);
+    }
+    wrefresh(m_tree.win);
+}
+
+/*! Moves the cursor to the node given by a path, to a row (from 1), by count of pages (+N or -N),
+ * or to a percentage of the rows (N%). Rows between the old and new cursor are not visited.
+ * \param target The user input.
+ */
+void CGUI::GoTo(const string & target) {
+    if (target.empty()) {
+        ConsolePrint("Console:");
+        return;
+    }
+
+    if (target[0] == '/') {
+        //parents of the node are expanded
+        CNode * node = m_xmlfile->FindPath(target);
+        if (node == NULL) {
+            ConsolePrint("Console: Node not found.");
+            return;
+        }
+        MoveCursor(m_xmlfile->ShowNode(node));
+    } else if (target[target.length() - 1] == '%') {
+        MoveCursor((int) ((long long) (m_xmlfile->GetRowCount() - 1) * atoi(target.c_str()) / 100));
+    } else if (target[0] == '+' || target[0] == '-') {
+        int pages = atoi(target.c_str());
+        m_top += pages * m_tree.height;
+        MoveCursor(m_current + pages * m_tree.height);
+    } else {
+        MoveCursor(atoi(target.c_str()) - 1);
     }
+    ConsolePrint("Console:");
 }
 
+/*! Moves the cursor to the row and scrolls the window, so the row is in it.
+ * \param row Index of the row, it is moved to the nearest existing row.
+ */
+void CGUI::MoveCursor(int row) {
+    int cnt = m_xmlfile->GetRowCount();
+    if (row >= cnt)
+        row = cnt - 1;
+    if (row < 0)
+        row = 0;
+    m_current = row;
+
+    //the window is full, if there are enough rows
+    if (m_top > cnt - m_tree.height)
+        m_top = cnt - m_tree.height;
+    if (m_top < 0)
+        m_top = 0;
+    if (m_current < m_top)
+        m_top = m_current;
+    else if (m_current >= m_top + m_tree.height)
+        m_top = m_current - m_tree.height + 1;
+
+    TreeDraw();
+}
+
+/********************* MEMORY MANAGEMENT TOOLS *******************************/
+
 /*! Handles the arrays used by attributes list.
  */
 void CGUI::ReallocAttributes() {
     if (m_cntAttributes > m_attributesSize - 2) {
         ITEM ** tmp = new ITEM * [REALLOC_CONSTANT * m_attributesSize];
+        char ** tmp_text = new char * [2 * REALLOC_CONSTANT * m_attributesSize];
 
         for (int i = 0; i < REALLOC_CONSTANT * m_attributesSize; i++) {
             tmp[i] = NULL;
+            tmp_text[2 * i] = tmp_text[2 * i + 1] = NULL;
         }
 
         for (int i = 0; i < m_cntAttributes; i++) {
-            tmp[i] = m_menuItems[i];
+            tmp[i] = m_attributesItems[i];
+            tmp_text[2 * i] = m_attributesTexts[2 * i];
+            tmp_text[2 * i + 1] = m_attributesTexts[2 * i + 1];
         }
 
         m_attributesSize = REALLOC_CONSTANT*m_attributesSize;
         delete [] m_attributesItems;
+        delete [] m_attributesTexts;
         m_attributesItems = tmp;
+        m_attributesTexts = tmp_text;
     }
 }
 
+/*! Copies the text to a new null terminated string for a menu item.
+ * \param data Pointer to the text.
+ * \param length Count of characters.
+ * \return The new string, it has to be deleted by delete [].
+ */
+char * CGUI::CopyText(const char * data, size_t length) {
+    char * text = new char [length + 1];
+    memcpy(text, data, length);
+    text[length] = 0;
+    return text;
+}
+
 /********************* WINDOW CREATING TOOL *******************************/
 
 /*! Creates the window with specified parameters.
@@ -899,3 +1029,92 @@ WINDOW * CGUI::CreateNewWindow(int width, int height, int startx, int starty) {
     wrefresh(local_win);
     return local_win;
 }
+
+/*! Lists newly loaded rows and handles the key pressed during the loading, the document must be owned.
+ * The root still gets new childs, so it cannot be collapsed.
+ * \param c The key (ERR, if none was pressed).
+ */
+void CGUI::BrowseLoaded(int c) {
+    m_xmlfile->ShowLoaded();
+    switch (c) {
+        case KEY_DOWN:
+            m_current++;
+            break;
+        case KEY_UP:
+            m_current--;
+            break;
+        case KEY_NPAGE:
+            m_top += m_tree.height;
+            m_current += m_tree.height;
+            break;
+        case KEY_PPAGE:
+            m_top -= m_tree.height;
+            m_current -= m_tree.height;
+            break;
+        case KEY_HOME:
+            m_current = 0;
+            break;
+        case KEY_END:
+            m_current = m_xmlfile->GetRowCount() - 1;
+            break;
+        case KEY_F(2):
+            if (m_current > 0)
+                m_xmlfile->ExpandRow(m_current);
+            break;
+        case KEY_F(3):
+            if (m_current > 0)
+                m_xmlfile->CollapseRow(m_current);
+            break;
+    }
+    MoveCursor(m_current);
+}
+
+/*! Prints the progress of the loading or saving to the console (processed part of the file and count of parsed nodes).
+ * \param activity Name of the activity.
+ * \param progress The progress.
+ */
+void CGUI::PrintProgress(const char * activity, CProgress * progress) {
+    size_t bytes = progress->GetBytes();
+    size_t size = progress->GetSize();
+    int nodes = progress->GetNodes();
+    int percent = size ? (int) (bytes * 100 / size) : 0;
+    //size of compressed file is only estimated
+    if (percent > 100)
+        percent = 100;
+
+    string str = "Console: ";
+    str += activity;
+    str += " [";
+    for (int i = 0; i < PROGRESS_BAR_WIDTH; i++)
+        str += i < percent * PROGRESS_BAR_WIDTH / 100 ? '#' : ' ';
+    char numbers[100];
+    snprintf(numbers, sizeof (numbers), "] %d%% (%lu of %lu kB", percent,
+            (unsigned long) (bytes / 1024), (unsigned long) (size / 1024));
+    str += numbers;
+    //the saving does not count nodes
+    if (nodes > 0) {
+        snprintf(numbers, sizeof (numbers), ", %d nodes", nodes);
+        str += numbers;
+    }
+    str += ")";
+    ConsolePrint(str.c_str());
+}
+
+/*! Shows the progress of the saving, when the saving thread ends, its result is shown.
+ */
+void CGUI::ShowSaving() {
+    CProgress * progress = m_xmlfile->GetSavingProgress();
+    if (progress == NULL)
+        return;
+    if (!progress->IsFinished()) {
+        PrintProgress("Saving", progress);
+        return;
+    }
+
+    //keys are waited for without timeout again
+    wtimeout(m_tree.win, -1);
+    if (m_xmlfile->FinishSaving())
+        ConsolePrint("Console: File saved.");
+    else
+        ConsolePrint("Console: File could not be saved.");
+}
@@ -9,11 +9,15 @@
 #include <ncurses.h>
 #include <menu.h>
 #include <cstdlib>
+#include <string>
 
 using namespace std;
 
 class CNode;
 class CXML;
+class CText;
+class CProgress;
+class CException;
 
 ///! Structure stores the pointer to a window, its position and size.
 struct Window {
@@ -29,13 +33,14 @@ public:
     CGUI(bool openingXML);
     ~CGUI();
 
-    //functions for inserting menu items
-    void AddMenuItem(const string * name, CNode * node, const char * type);
-    void AddAttributeItem(const string * name, const string * value);
+    //function for inserting attributes menu items
+    void AddAttributeItem(const CText & name, const CText & value);
 
     //user input handlers
     void Handler();
     void TreeHandler();
+    void LoadingHandler();
+    void ErrorHandler(const CException & e);
 
     //menu initializes and destroyers
     void TreeInit();
@@ -69,14 +74,26 @@ protected:
     void PostInsertingControlWindow();
     void PostAttributesControlWindow();
     void PostStartControlWindow();
+    void PostLoadingControlWindow();
 
     //user input handlers
     void InsertingHandler(int id);
     void AttributesHandler(int id);
 
+    //view of the tree
+    void TreeDraw();
+    void GoTo(const string & target);
+    void MoveCursor(int row);
+    void BrowseLoaded(int c);
+    void PrintProgress(const char * activity, CProgress * progress);
+    void ShowSaving();
+
+    //attributes of the node
+    void ListAttributes(CNode * node);
+
     //memory management tools
-    void ReallocItems();
     void ReallocAttributes();
+    static char * CopyText(const char * data, size_t length);
 
     //tool for creating new window
     WINDOW * CreateNewWindow(int width, int height, int startx, int starty);
@@ -89,26 +106,24 @@ protected:
     ///! Console window
     Window m_console;
 
+    //view of the tree, only rows in the window are printed
+    ///! Row of the cursor
+    int m_current;
+    ///! First row in the window
+    int m_top;
+
     //arrays of menus items
-    ///! XML printed strings
-    ITEM ** m_menuItems;
-    ///! Pointers to nodes connected to strings
-    CNode ** m_nodes; //every item in menu represents a node
     ///! Attributes of given node (its strings)
     ITEM ** m_attributesItems;
+    ///! Copies of names and values of attributes (two for every item)
+    char ** m_attributesTexts;
 
     //menus to be shown
-    ///! Main XML tree
-    MENU *m_menu;
     ///! List of attributes for given node
     MENU *m_attributes;
 
 
     //menus information
-    ///! Count of shown nodes
-    int m_cntNodes;
-    ///! Current max count of shown nodes
-    int m_menuSize;
     ///! Count of shown attributes
     int m_cntAttributes;
     ///! Current max count of attributes
@@ -0,0 +1,80 @@
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <string>
+
+#include "CImage.h"
+#include "CXMLHandler.h"
+
+///! Multiplier of the checksum
+#define CHECKSUM_PRIME 0x100000001b3ULL
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Gets the path of the image of the XML file, it is in the directory of the images and its name is the hash
+ * of the absolute path of the file.
+ * \param filePath Path of the XML file.
+ * \return Path of the image, empty string, if images are not used.
+ */
+string CImage::GetPath(const string & filePath) {
+    const char * directory = getenv(IMAGE_DIR_VARIABLE);
+    char absolutePath[PATH_MAX];
+    if (directory == NULL || *directory == 0 || realpath(filePath.c_str(), absolutePath) == NULL)
+        return string();
+
+    uint64_t hash = IMAGE_CHECKSUM_BASIS;
+    for (const char * c = absolutePath; *c; c++)
+        hash = (hash ^ (unsigned char) *c) * CHECKSUM_PRIME;
+    char name[32];
+    snprintf(name, sizeof (name), "/%016llx", (unsigned long long) hash);
+    return directory + string(name) + IMAGE_SUFFIX;
+}
+
+/*! Adds the data to the checksum of the tables, 8 bytes are added at once (the tables are aligned to 8 bytes).
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ * \param checksum The checksum of previous data (IMAGE_CHECKSUM_BASIS at the start).
+ * \return The checksum.
+ */
+uint64_t CImage::Checksum(const char * data, size_t size, uint64_t checksum) {
+    uint64_t word;
+    for (size_t i = 0; i + sizeof (word) <= size; i += sizeof (word)) {
+        memcpy(&word, data + i, sizeof (word));
+        checksum = ((checksum << 5 | checksum >> 59) ^ word) * CHECKSUM_PRIME;
+    }
+    return checksum;
+}
+
+/*! Gets the size of a table in the image, every table is aligned to 8 bytes.
+ * \param count Count of the items.
+ * \param itemSize Size of one item.
+ */
+size_t CImage::GetTableSize(uint64_t count, size_t itemSize) {
+    return (count * itemSize + 7) & ~(uint64_t) 7;
+}
+
+/*! Gets the value, which follows from the source of the node, so it is not stored in the image.
+ * It is the text between the tags of text node (and unparsed childs of parent node), or the text of comment.
+ * \param kind Kind of the node.
+ * \param source The node in the XML data.
+ * \param tagLength Length of the start tag in the source.
+ * \return The text, empty text for other nodes.
+ */
+CText CImage::GetInnerText(int kind, const CText & source, unsigned int tagLength) {
+    const char * start = source.GetData();
+    if (kind == NEXT_IS_COMMENT) {
+        //<!-- and --> are not in the text (the space after <!-- neither)
+        return source.GetLength() > 8 ? CText(start + 5, source.GetLength() - 8) : CText();
+    }
+    if (kind != NEXT_IS_TEXTNODE && kind != NEXT_IS_PARENTNODE)
+        return CText();
+
+    //the end tag is the last tag of the source
+    const char * end = start + source.GetLength();
+    while (end > start + tagLength && *--end != 60)
+        ;
+    return end > start + tagLength ? CText(start + tagLength, end - start - tagLength) : CText();
+}
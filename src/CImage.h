@@ -0,0 +1,129 @@
+#ifndef CIMAGE_H
+#define	CIMAGE_H
+
+#include <cstdlib>
+#include <string>
+#include <stdint.h>
+
+#include "CText.h"
+
+using namespace std;
+
+///! Magic bytes at the start of the image (without the terminating zero)
+#define IMAGE_MAGIC "XMLIMAGE"
+///! Version of the image format, images of other versions are not used
+#define IMAGE_VERSION 2
+///! Suffix of the image file
+#define IMAGE_SUFFIX ".image"
+///! Environment variable with the directory of the images, images are not used, if it is not set
+#define IMAGE_DIR_VARIABLE "XMLEDITOR_IMAGES"
+///! Images are made only of smaller files, positions in them have 31 bits
+#define IMAGE_MAX_SIZE 0x7fffffffU
+///! Bit of text references, which point to the heap of the image (others point to the XML file)
+#define IMAGE_HEAP_REFERENCE 0x80000000U
+///! Count of bits of the atom of the title in the type of the node (the kind and the flags are above)
+#define IMAGE_NAME_BITS 24
+///! Mask of the atom of the title in the type of the node
+#define IMAGE_NAME_MASK ((1U << IMAGE_NAME_BITS) - 1)
+///! Mask of the kind of the node in the type (after the shift by IMAGE_NAME_BITS)
+#define IMAGE_KIND_MASK 3U
+///! Flag of parent node, whose childs were not parsed (its childs are not in the image)
+#define IMAGE_LAZY (1U << 26)
+///! Flag of node, whose value is not the text between its tags (it is in the table of values)
+#define IMAGE_VALUE (1U << 27)
+///! Start value of the checksum
+#define IMAGE_CHECKSUM_BASIS 0xcbf29ce484222325ULL
+
+///! Class, which describes the binary image of a parsed document. Images are kept only in the directory given
+///! by IMAGE_DIR_VARIABLE, their names are made from the paths of the XML files.
+///! The image is a header and five tables (names, nodes in preorder, attributes, values, which are not
+///! the texts between the tags, and the heap of texts, which are not in the XML file). Positions are 32-bit,
+///! lengths, which follow from the source, are not stored. It is mapped to memory and the nodes are built
+///! from the tables, when they are needed, without parsing the XML file again.
+
+class CImage {
+public:
+    static string GetPath(const string & filePath);
+    static uint64_t Checksum(const char * data, size_t size, uint64_t checksum);
+    static size_t GetTableSize(uint64_t count, size_t itemSize);
+    static CText GetInnerText(int kind, const CText & source, unsigned int tagLength);
+
+    ///! Header at the start of the image, it identifies the XML file by its size and modification time.
+    struct THeader {
+        ///! Magic bytes of the image
+        char m_magic[8];
+        ///! Version of the format
+        uint32_t m_version;
+        ///! Size of this header (it is checked with the version)
+        uint32_t m_headerSize;
+        ///! Size of the XML file
+        uint64_t m_sourceSize;
+        ///! Modification time of the XML file (seconds)
+        int64_t m_sourceSeconds;
+        ///! Modification time of the XML file (nanoseconds)
+        int64_t m_sourceNanoseconds;
+        ///! Count of names
+        uint64_t m_cntNames;
+        ///! Count of nodes
+        uint64_t m_cntNodes;
+        ///! Count of attributes
+        uint64_t m_cntAttributes;
+        ///! Count of values
+        uint64_t m_cntValues;
+        ///! Size of the heap (aligned to 8 bytes)
+        uint64_t m_heapSize;
+        ///! Reference of the version information
+        uint32_t m_versionData;
+        ///! Length of the version information
+        uint32_t m_versionLength;
+        ///! Checksum of the header (with zero in place of the checksum) and of the tables
+        uint64_t m_checksum;
+    };
+
+    ///! Text in the image (a name), it points to the XML file or to the heap.
+    struct TText {
+        ///! Reference of the text
+        uint32_t m_data;
+        ///! Length of the text
+        uint32_t m_length;
+    };
+
+    ///! One node of the tree, childs of a parent follow it (with their descendants).
+    struct TNode {
+        ///! Position of the node in the XML file (from its start tag to its end tag)
+        uint32_t m_source;
+        ///! Length of the node in the XML file
+        uint32_t m_sourceLength;
+        ///! Length of the start tag in the source
+        uint32_t m_tagLength;
+        ///! Index of the node after the descendants of this node (its next sibling)
+        uint32_t m_next;
+        ///! Index of the first attribute, the attributes of the node end at the first attribute of the next node
+        uint32_t m_firstAttribute;
+        ///! Atom of the title, the kind of the node (NEXT_IS_TEXTNODE, NEXT_IS_PARENTNODE, NEXT_IS_COMMENT,
+        ///! NEXT_IS_SIMPLE) and the flags (IMAGE_LAZY, IMAGE_VALUE)
+        uint32_t m_type;
+    };
+
+    ///! One attribute of a node.
+    struct TAttribute {
+        ///! Index of the name in the names
+        uint32_t m_name;
+        ///! Reference of the value, position in the XML file is counted from the start of the node
+        uint32_t m_value;
+        ///! Length of the value
+        uint32_t m_length;
+    };
+
+    ///! Value of a node, which is not the text between its tags (text with entities, for example).
+    struct TValue {
+        ///! Index of the node (the values are sorted by it)
+        uint32_t m_node;
+        ///! Reference of the value
+        uint32_t m_data;
+        ///! Length of the value
+        uint32_t m_length;
+    };
+};
+
+#endif	/* CIMAGE_H */
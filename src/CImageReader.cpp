@@ -0,0 +1,344 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "CImageReader.h"
+#include "CException.h"
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates the reader of the image of given XML data.
+ * \param data Pointer to the XML data, texts of the nodes will point to it.
+ * \param size Size of the data.
+ * \param modified Modification time of the XML file, the image has to be made from the same file.
+ */
+CImageReader::CImageReader(const char * data, size_t size, const struct timespec & modified) {
+    m_data = data;
+    m_size = size;
+    m_modified = modified;
+    m_image = NULL;
+    m_header = NULL;
+    m_names = NULL;
+    m_nodes = NULL;
+    m_attributes = NULL;
+    m_values = NULL;
+    m_heap = NULL;
+}
+
+/*! Unmaps the image.
+ */
+CImageReader::~CImageReader() {
+    delete m_image;
+}
+
+/*! Maps the image and checks it, the image can be read only if it is made from the same XML file
+ * and it is not damaged (the root and its childs are checked now, other nodes are checked, when they are read).
+ * \param imagePath Path of the image file.
+ * \return False, if there is no valid image.
+ */
+bool CImageReader::Open(const string & imagePath) {
+    try {
+        m_image = new CMappedFile(imagePath);
+    } catch (const CException & e) {
+        return false;
+    }
+    if (!CheckTables()) {
+        delete m_image;
+        m_image = NULL;
+        return false;
+    }
+    return true;
+}
+
+/*! Sends the events of the root and of its childs to the handler, they are the same as the events of the XML reader.
+ * Parent childs of the root are sent as skipped, if they have childs. The image has to be open.
+ * \param handler Pointer to the handler.
+ */
+void CImageReader::Read(CXMLHandler * handler) {
+    if (m_header->m_versionLength)
+        handler->VersionData(GetText(m_header->m_versionData, m_header->m_versionLength, 0));
+    ReadNode(0, handler, true);
+}
+
+/*! Sends the events of the childs of skipped parent node to the handler, like the XML reader would send them
+ * for its content. Parent childs are sent as skipped again, if they have childs.
+ * \param source The parent node in the XML data.
+ * \param handler Pointer to the handler.
+ * \return False, if the childs are not in the image (they were not parsed), or they are not valid.
+ */
+bool CImageReader::ReadChilds(const CText & source, CXMLHandler * handler) {
+    if (source.GetData() < m_data || source.GetData() >= m_data + m_size)
+        return false;
+    uint32_t node = FindNode(source.GetData() - m_data);
+    if (node == m_header->m_cntNodes || m_nodes[node].m_sourceLength != source.GetLength())
+        return false;
+    const CImage::TNode & item = m_nodes[node];
+    if ((item.m_type >> IMAGE_NAME_BITS & IMAGE_KIND_MASK) != NEXT_IS_PARENTNODE || item.m_type & IMAGE_LAZY
+            || !CheckNode(node, m_header->m_cntNodes) || !CheckChilds(node))
+        return false;
+
+    for (uint32_t child = node + 1; child < item.m_next; child = m_nodes[child].m_next)
+        ReadNode(child, handler, false);
+    return true;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Checks the header, the checksum of the image, the names and the root with its childs, so they can be read
+ * without checking.
+ * \return False, if the image is not valid.
+ */
+bool CImageReader::CheckTables() {
+    size_t size = m_image->GetSize();
+    const char * data = m_image->GetData();
+    if (size < sizeof (CImage::THeader))
+        return false;
+    m_header = (const CImage::THeader *) data;
+    if (memcmp(m_header->m_magic, IMAGE_MAGIC, sizeof (m_header->m_magic)) != 0 || m_header->m_version != IMAGE_VERSION
+            || m_header->m_headerSize != sizeof (CImage::THeader))
+        return false;
+
+    //the image has to be made from the same file
+    if (m_header->m_sourceSize != m_size || m_size > IMAGE_MAX_SIZE || m_header->m_sourceSeconds != m_modified.tv_sec
+            || m_header->m_sourceNanoseconds != m_modified.tv_nsec)
+        return false;
+
+    //the tables have to fill the rest of the image
+    size_t rest = size - sizeof (CImage::THeader);
+    if (m_header->m_cntNames > rest / sizeof (CImage::TText) || m_header->m_cntNodes > rest / sizeof (CImage::TNode)
+            || m_header->m_cntAttributes > rest / sizeof (CImage::TAttribute)
+            || m_header->m_cntValues > rest / sizeof (CImage::TValue) || m_header->m_heapSize > rest
+            || m_header->m_heapSize % 8 != 0 || m_header->m_cntNodes == 0 || m_header->m_cntNames > IMAGE_NAME_MASK)
+        return false;
+    size_t namesSize = CImage::GetTableSize(m_header->m_cntNames, sizeof (CImage::TText));
+    size_t nodesSize = CImage::GetTableSize(m_header->m_cntNodes, sizeof (CImage::TNode));
+    size_t attributesSize = CImage::GetTableSize(m_header->m_cntAttributes, sizeof (CImage::TAttribute));
+    size_t valuesSize = CImage::GetTableSize(m_header->m_cntValues, sizeof (CImage::TValue));
+    if (namesSize + nodesSize + attributesSize + valuesSize + m_header->m_heapSize != rest)
+        return false;
+
+    //the checksum is counted with zero in its place
+    CImage::THeader header = *m_header;
+    header.m_checksum = 0;
+    uint64_t checksum = CImage::Checksum((const char *) &header, sizeof (header), IMAGE_CHECKSUM_BASIS);
+    if (CImage::Checksum(data + sizeof (header), rest, checksum) != m_header->m_checksum)
+        return false;
+
+    m_names = (const CImage::TText *) (data + sizeof (CImage::THeader));
+    m_nodes = (const CImage::TNode *) ((const char *) m_names + namesSize);
+    m_attributes = (const CImage::TAttribute *) ((const char *) m_nodes + nodesSize);
+    m_values = (const CImage::TValue *) ((const char *) m_attributes + attributesSize);
+    m_heap = (const char *) m_values + valuesSize;
+
+    for (uint64_t i = 0; i < m_header->m_cntNames; i++) {
+        if (!CheckText(m_names[i].m_data, m_names[i].m_length, 0))
+            return false;
+    }
+    if (!CheckText(m_header->m_versionData, m_header->m_versionLength, 0))
+        return false;
+
+    //the root contains all the nodes
+    return CheckNode(0, m_header->m_cntNodes) && m_nodes[0].m_next == m_header->m_cntNodes && CheckChilds(0);
+}
+
+/*! Checks, if the text is in the XML data or in the heap.
+ * \param ref Reference of the text.
+ * \param length Length of the text.
+ * \param start Position in the XML data, from which the reference is counted.
+ */
+bool CImageReader::CheckText(uint32_t ref, uint32_t length, uint32_t start) const {
+    if (ref & IMAGE_HEAP_REFERENCE) {
+        ref &= ~IMAGE_HEAP_REFERENCE;
+        return ref <= m_header->m_heapSize && length <= m_header->m_heapSize - ref;
+    }
+    uint64_t position = (uint64_t) start + ref;
+    return position <= m_size && length <= m_size - position;
+}
+
+/*! Checks one node and its attributes, its descendants have to be before the end.
+ * \param node Index of the node.
+ * \param end Index of the node after the descendants of its parent.
+ */
+bool CImageReader::CheckNode(uint32_t node, uint32_t end) const {
+    const CImage::TNode & item = m_nodes[node];
+    uint32_t kind = item.m_type >> IMAGE_NAME_BITS & IMAGE_KIND_MASK;
+    uint32_t known = IMAGE_NAME_MASK | IMAGE_KIND_MASK << IMAGE_NAME_BITS | IMAGE_LAZY | IMAGE_VALUE;
+    if (item.m_type & ~known || item.m_next <= node || item.m_next > end || item.m_sourceLength == 0
+            || !CheckText(item.m_source, item.m_sourceLength, 0) || item.m_tagLength > item.m_sourceLength)
+        return false;
+    //only parent node has childs, unparsed childs are not in the image
+    if ((kind != NEXT_IS_PARENTNODE || item.m_type & IMAGE_LAZY) && item.m_next != node + 1)
+        return false;
+    if (kind != NEXT_IS_PARENTNODE && item.m_type & IMAGE_LAZY)
+        return false;
+    if (kind != NEXT_IS_COMMENT && (item.m_type & IMAGE_NAME_MASK) >= m_header->m_cntNames)
+        return false;
+    //the end tag of parent is after its start tag
+    if (kind == NEXT_IS_PARENTNODE && GetEndTag(node).GetData() < m_data + item.m_source + item.m_tagLength)
+        return false;
+
+    uint32_t last = GetAttributesEnd(node);
+    if (item.m_firstAttribute > last || last > m_header->m_cntAttributes || (kind == NEXT_IS_COMMENT && last > item.m_firstAttribute))
+        return false;
+    for (uint32_t i = item.m_firstAttribute; i < last; i++) {
+        const CImage::TAttribute & attribute = m_attributes[i];
+        if (attribute.m_name >= m_header->m_cntNames || !CheckText(attribute.m_value, attribute.m_length, item.m_source))
+            return false;
+    }
+
+    if (item.m_type & IMAGE_VALUE) {
+        uint32_t value = FindValue(node);
+        if (value == m_header->m_cntValues || !CheckText(m_values[value].m_data, m_values[value].m_length, 0))
+            return false;
+    }
+    return true;
+}
+
+/*! Checks the childs of parent node (without their descendants).
+ * \param node Index of the node, it has to be checked.
+ */
+bool CImageReader::CheckChilds(uint32_t node) const {
+    uint32_t end = m_nodes[node].m_next;
+    for (uint32_t child = node + 1; child < end; child = m_nodes[child].m_next) {
+        if (!CheckNode(child, end))
+            return false;
+    }
+    return true;
+}
+
+/*! Sends the events of the node, it has to be checked.
+ * \param node Index of the node.
+ * \param handler Pointer to the handler.
+ * \param isRoot Are the childs of parent node sent too? Otherwise they are skipped.
+ */
+void CImageReader::ReadNode(uint32_t node, CXMLHandler * handler, bool isRoot) {
+    const CImage::TNode & item = m_nodes[node];
+    int kind = item.m_type >> IMAGE_NAME_BITS & IMAGE_KIND_MASK;
+    CText source = GetSource(node);
+
+    if (kind == NEXT_IS_COMMENT) {
+        handler->Comment(GetValue(node));
+        handler->Markup(source);
+    } else {
+        m_list.Clear();
+        for (uint32_t i = item.m_firstAttribute; i < GetAttributesEnd(node); i++) {
+            const CImage::TAttribute & attribute = m_attributes[i];
+            m_list.Add(GetName(attribute.m_name), GetText(attribute.m_value, attribute.m_length, item.m_source));
+        }
+        CText title = GetName(item.m_type & IMAGE_NAME_MASK);
+        handler->StartElement(title, m_list, kind);
+
+        if (kind == NEXT_IS_PARENTNODE) {
+            handler->Markup(source.Sub(0, item.m_tagLength));
+            if (isRoot && !(item.m_type & IMAGE_LAZY)) {
+                handler->Position(item.m_source + item.m_tagLength);
+                for (uint32_t child = node + 1; child < item.m_next; child = m_nodes[child].m_next)
+                    ReadNode(child, handler, false);
+            } else if (item.m_type & IMAGE_LAZY || item.m_next > node + 1)
+                handler->Skipped(GetValue(node));
+            handler->EndElement(title);
+            handler->Markup(GetEndTag(node));
+        } else {
+            if (kind == NEXT_IS_TEXTNODE)
+                handler->Text(GetValue(node));
+            handler->EndElement(title);
+            handler->Markup(source);
+        }
+    }
+    handler->Position(item.m_source + item.m_sourceLength);
+}
+
+/*! Finds the node by its position in the XML data, the nodes in preorder are sorted by it.
+ * \param position Position of the node.
+ * \return Index of the node, count of the nodes, if there is no such node.
+ */
+uint32_t CImageReader::FindNode(size_t position) const {
+    uint32_t first = 0;
+    uint32_t last = m_header->m_cntNodes;
+    while (first < last) {
+        uint32_t middle = first + (last - first) / 2;
+        if (m_nodes[middle].m_source < position)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first < m_header->m_cntNodes && m_nodes[first].m_source == position ? first : m_header->m_cntNodes;
+}
+
+/*! Finds the value of the node in the table of values, they are sorted by the nodes.
+ * \param node Index of the node.
+ * \return Index of the value, count of the values, if the node has none.
+ */
+uint32_t CImageReader::FindValue(uint32_t node) const {
+    uint32_t first = 0;
+    uint32_t last = m_header->m_cntValues;
+    while (first < last) {
+        uint32_t middle = first + (last - first) / 2;
+        if (m_values[middle].m_node < node)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first < m_header->m_cntValues && m_values[first].m_node == node ? first : m_header->m_cntValues;
+}
+
+/*! Gets the text, which points to the XML data or to the heap.
+ * \param ref Reference of the text.
+ * \param length Length of the text.
+ * \param start Position in the XML data, from which the reference is counted.
+ */
+CText CImageReader::GetText(uint32_t ref, uint32_t length, uint32_t start) const {
+    if (length == 0)
+        return CText();
+    if (ref & IMAGE_HEAP_REFERENCE)
+        return CText(m_heap + (ref & ~IMAGE_HEAP_REFERENCE), length);
+    return CText(m_data + start + ref, length);
+}
+
+/*! Gets the name from the table of names.
+ * \param name Index of the name.
+ */
+CText CImageReader::GetName(uint32_t name) const {
+    return GetText(m_names[name].m_data, m_names[name].m_length, 0);
+}
+
+/*! Gets the node as it is in the XML data.
+ * \param node Index of the node.
+ */
+CText CImageReader::GetSource(uint32_t node) const {
+    return CText(m_data + m_nodes[node].m_source, m_nodes[node].m_sourceLength);
+}
+
+/*! Gets the text of text node or comment, or unparsed childs of parent node. Usually it is the text
+ * between the tags, other values are in the table of values.
+ * \param node Index of the node.
+ */
+CText CImageReader::GetValue(uint32_t node) const {
+    const CImage::TNode & item = m_nodes[node];
+    if (item.m_type & IMAGE_VALUE) {
+        const CImage::TValue & value = m_values[FindValue(node)];
+        return GetText(value.m_data, value.m_length, 0);
+    }
+    CText inner = CImage::GetInnerText(item.m_type >> IMAGE_NAME_BITS & IMAGE_KIND_MASK, GetSource(node), item.m_tagLength);
+    return inner.GetLength() ? inner : CText();
+}
+
+/*! Gets the end tag of parent node, it is the last tag of its source.
+ * \param node Index of the parent node.
+ */
+CText CImageReader::GetEndTag(uint32_t node) const {
+    const char * start = m_data + m_nodes[node].m_source;
+    const char * end = start + m_nodes[node].m_sourceLength;
+    const char * tag = end;
+    while (tag > start && *--tag != 60)
+        ;
+    return CText(tag, end - tag);
+}
+
+/*! Gets the index after the last attribute of the node, the attributes of the next node follow.
+ * \param node Index of the node.
+ */
+uint32_t CImageReader::GetAttributesEnd(uint32_t node) const {
+    return node + 1 < m_header->m_cntNodes ? m_nodes[node + 1].m_firstAttribute : m_header->m_cntAttributes;
+}
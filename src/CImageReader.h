@@ -0,0 +1,68 @@
+#ifndef CIMAGEREADER_H
+#define	CIMAGEREADER_H
+
+#include <cstdlib>
+#include <string>
+#include <ctime>
+
+#include "CImage.h"
+#include "CMappedFile.h"
+#include "CText.h"
+#include "CXMLHandler.h"
+
+using namespace std;
+
+///! Class, which reads the binary image of a document and sends the same events to the handler as the XML reader,
+///! so the nodes are built without parsing. The root and its childs are read, when the document is opened,
+///! childs of other parent nodes are read from the tables, when they are expanded (they are sent as skipped before).
+///! The checksum is checked, when the image is opened, the references of the nodes are checked, when they are read.
+///! It has to exist as long as the nodes, texts, which are not in the XML file, point to it.
+
+class CImageReader {
+public:
+    CImageReader(const char * data, size_t size, const struct timespec & modified);
+    ~CImageReader();
+
+    bool Open(const string & imagePath);
+    void Read(CXMLHandler * handler);
+    bool ReadChilds(const CText & source, CXMLHandler * handler);
+protected:
+    bool CheckTables();
+    bool CheckText(uint32_t ref, uint32_t length, uint32_t start) const;
+    bool CheckNode(uint32_t node, uint32_t end) const;
+    bool CheckChilds(uint32_t node) const;
+    void ReadNode(uint32_t node, CXMLHandler * handler, bool isRoot);
+    uint32_t FindNode(size_t position) const;
+    uint32_t FindValue(uint32_t node) const;
+    CText GetText(uint32_t ref, uint32_t length, uint32_t start) const;
+    CText GetName(uint32_t name) const;
+    CText GetSource(uint32_t node) const;
+    CText GetValue(uint32_t node) const;
+    CText GetEndTag(uint32_t node) const;
+    uint32_t GetAttributesEnd(uint32_t node) const;
+
+    ///! Pointer to the XML data
+    const char * m_data;
+    ///! Size of the XML data
+    size_t m_size;
+    ///! Modification time of the XML file
+    struct timespec m_modified;
+    ///! The mapped image, NULL if it is not open
+    CMappedFile * m_image;
+    ///! Header of the image
+    const CImage::THeader * m_header;
+    ///! Table of the names
+    const CImage::TText * m_names;
+    ///! Table of the nodes
+    const CImage::TNode * m_nodes;
+    ///! Table of the attributes
+    const CImage::TAttribute * m_attributes;
+    ///! Table of the values, which are not the texts between the tags
+    const CImage::TValue * m_values;
+    ///! Heap of the texts
+    const char * m_heap;
+    ///! Attributes of current node (they are sent with the start of the element)
+    CAttributeList m_list;
+};
+
+#endif	/* CIMAGEREADER_H */
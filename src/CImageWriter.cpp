@@ -0,0 +1,262 @@
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <new>
+
+#include "CImageWriter.h"
+#include "CXMLWriter.h"
+
+///! Default count of nodes
+#define DEFAULT_NODES_SIZE 256
+///! Default count of attributes
+#define DEFAULT_ATTRIBUTES_SIZE 64
+///! Default count of values
+#define DEFAULT_VALUES_SIZE 64
+///! Default size of the heap
+#define DEFAULT_HEAP_SIZE 256
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates empty image of the document.
+ * \param data Pointer to the XML data, texts of the nodes point to it.
+ * \param size Size of the data.
+ * \param atoms Names of the document.
+ */
+CImageWriter::CImageWriter(const char * data, size_t size, const CAtomTable * atoms) {
+    m_data = data;
+    m_size = size;
+    m_atoms = atoms;
+    memset(&m_header, 0, sizeof (m_header));
+    m_nodes = NULL;
+    m_sizeNodes = 0;
+    m_attributes = NULL;
+    m_sizeAttributes = 0;
+    m_values = NULL;
+    m_sizeValues = 0;
+    m_heap = NULL;
+    m_sizeHeap = 0;
+}
+
+/*! Frees the tables.
+ */
+CImageWriter::~CImageWriter() {
+    free(m_nodes);
+    free(m_attributes);
+    free(m_values);
+    free(m_heap);
+}
+
+/********************* MAKING THE IMAGE *******************************/
+
+/*! Adds next node in preorder, its attributes are added after it. The node has to be in the XML data.
+ * \param kind Kind of the node (NEXT_IS_TEXTNODE, NEXT_IS_PARENTNODE, NEXT_IS_COMMENT, NEXT_IS_SIMPLE).
+ * \param name Atom of the title (-1 for comments).
+ * \param source The node in the XML data.
+ * \param tagLength Length of the start tag in the source.
+ * \param value Text of text node or comment, unparsed childs of parent node.
+ * \return Index of the node.
+ */
+int CImageWriter::AddNode(int kind, int name, const CText & source, unsigned int tagLength, const CText & value) {
+    ReallocNodes();
+    uint32_t index = m_header.m_cntNodes;
+    CImage::TNode & node = m_nodes[index];
+    node.m_source = source.GetData() - m_data;
+    node.m_sourceLength = source.GetLength();
+    node.m_tagLength = tagLength;
+    node.m_next = index + 1;
+    node.m_firstAttribute = m_header.m_cntAttributes;
+    node.m_type = (name >= 0 ? name : 0) | kind << IMAGE_NAME_BITS;
+    m_source = source;
+
+    //usually the value is the text between the tags, other values are in the table of values
+    CText inner = CImage::GetInnerText(kind, source, tagLength);
+    if (value.GetLength() && (value.GetData() != inner.GetData() || value.GetLength() != inner.GetLength())) {
+        ReallocValues();
+        CImage::TValue & item = m_values[m_header.m_cntValues++];
+        item.m_node = index;
+        item.m_data = AddText(value, m_data, m_size);
+        item.m_length = value.GetLength();
+        node.m_type |= IMAGE_VALUE;
+    }
+    return m_header.m_cntNodes++;
+}
+
+/*! Adds an attribute to the last node.
+ * \param name Atom of the name.
+ * \param value The value.
+ */
+void CImageWriter::AddAttribute(int name, const CText & value) {
+    ReallocAttributes();
+    CImage::TAttribute & attribute = m_attributes[m_header.m_cntAttributes++];
+    attribute.m_name = name;
+    attribute.m_value = AddText(value, m_source.GetData(), m_source.GetLength());
+    attribute.m_length = value.GetLength();
+}
+
+/*! Ends the childs of a parent node, they are the nodes added after it.
+ * \param node Index of the node.
+ */
+void CImageWriter::EndChilds(int node) {
+    m_nodes[node].m_next = m_header.m_cntNodes;
+}
+
+/*! Marks a parent node, whose childs are not parsed, its value is the unparsed content.
+ * \param node Index of the node.
+ */
+void CImageWriter::SetLazy(int node) {
+    m_nodes[node].m_type |= IMAGE_LAZY;
+}
+
+/*! Sets the version information of the document.
+ * \param data The whole version tag.
+ */
+void CImageWriter::SetVersionData(const CText & data) {
+    m_header.m_versionData = AddText(data, m_data, m_size);
+    m_header.m_versionLength = data.GetLength();
+}
+
+/*! Writes the image to a temporary file, which replaces the image file, when it is complete.
+ * \param filePath Path of the image file.
+ * \param modified Modification time of the XML file.
+ * \return False, if the image could not be written.
+ */
+bool CImageWriter::WriteFile(const string & filePath, const struct timespec & modified) {
+    //names are copied to the heap, their atoms are their indices
+    int cntNames = m_atoms->GetCount();
+    if (m_size > IMAGE_MAX_SIZE || (uint32_t) cntNames > IMAGE_NAME_MASK)
+        return false;
+    CImage::TText * names = new CImage::TText [cntNames > 0 ? cntNames : 1];
+    for (int i = 0; i < cntNames; i++) {
+        names[i].m_data = AddText(m_atoms->Get(i), m_data, m_size);
+        names[i].m_length = m_atoms->Get(i).GetLength();
+    }
+    size_t heapUsed = m_header.m_heapSize;
+    size_t heapSize = CImage::GetTableSize(heapUsed, 1);
+    if (heapSize > IMAGE_MAX_SIZE) {
+        delete [] names;
+        return false;
+    }
+
+    memcpy(m_header.m_magic, IMAGE_MAGIC, sizeof (m_header.m_magic));
+    m_header.m_version = IMAGE_VERSION;
+    m_header.m_headerSize = sizeof (m_header);
+    m_header.m_sourceSize = m_size;
+    m_header.m_sourceSeconds = modified.tv_sec;
+    m_header.m_sourceNanoseconds = modified.tv_nsec;
+    m_header.m_cntNames = cntNames;
+    m_header.m_heapSize = heapSize;
+
+    //the tables follow each other in the file, each of them is aligned to 8 bytes by zeros
+    CText tables[5] = {CText((const char *) names, cntNames * sizeof (CImage::TText)),
+        CText((const char *) m_nodes, m_header.m_cntNodes * sizeof (CImage::TNode)),
+        CText((const char *) m_attributes, m_header.m_cntAttributes * sizeof (CImage::TAttribute)),
+        CText((const char *) m_values, m_header.m_cntValues * sizeof (CImage::TValue)),
+        CText(m_heap, heapUsed)};
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    //the checksum covers the whole image (with zeros in its place), the padding is counted too
+    m_header.m_checksum = 0;
+    uint64_t checksum = CImage::Checksum((const char *) &m_header, sizeof (m_header), IMAGE_CHECKSUM_BASIS);
+    for (int i = 0; i < 5; i++) {
+        size_t words = tables[i].GetLength() & ~(size_t) 7;
+        checksum = CImage::Checksum(tables[i].GetData(), words, checksum);
+        if (words < tables[i].GetLength()) {
+            char last[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            memcpy(last, tables[i].GetData() + words, tables[i].GetLength() - words);
+            checksum = CImage::Checksum(last, sizeof (last), checksum);
+        }
+    }
+    m_header.m_checksum = checksum;
+
+    //the written image replaces the old one, when it is complete
+    CXMLWriter writer(filePath);
+    writer.Write((const char *) &m_header, sizeof (m_header));
+    for (int i = 0; i < 5; i++) {
+        writer.WriteBlock(tables[i]);
+        writer.Write(zeros, CImage::GetTableSize(tables[i].GetLength(), 1) - tables[i].GetLength());
+    }
+
+    bool written = writer.Close();
+    delete [] names;
+    return written;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Gets the reference of the text, texts, which are not in given part of the XML data, are copied to the heap.
+ * \param text The text.
+ * \param start Start of the part of the data, the reference is counted from it.
+ * \param size Size of the part.
+ */
+uint32_t CImageWriter::AddText(const CText & text, const char * start, size_t size) {
+    const char * data = text.GetData();
+    if (text.GetLength() == 0)
+        return 0;
+    if (data >= start && data + text.GetLength() <= start + size)
+        return data - start;
+
+    size_t ref = m_header.m_heapSize;
+    ReallocHeap(ref + text.GetLength());
+    memcpy(m_heap + ref, data, text.GetLength());
+    m_header.m_heapSize += text.GetLength();
+    return ref | IMAGE_HEAP_REFERENCE;
+}
+
+/*! Nodes memory management.
+ */
+void CImageWriter::ReallocNodes() {
+    if (m_header.m_cntNodes < m_sizeNodes)
+        return;
+    size_t size = m_sizeNodes ? m_sizeNodes * REALLOC_CONSTANT : DEFAULT_NODES_SIZE;
+    CImage::TNode * tmp = (CImage::TNode *) realloc(m_nodes, size * sizeof (CImage::TNode));
+    if (tmp == NULL)
+        throw bad_alloc();
+    m_nodes = tmp;
+    m_sizeNodes = size;
+}
+
+/*! Attributes memory management.
+ */
+void CImageWriter::ReallocAttributes() {
+    if (m_header.m_cntAttributes < m_sizeAttributes)
+        return;
+    size_t size = m_sizeAttributes ? m_sizeAttributes * REALLOC_CONSTANT : DEFAULT_ATTRIBUTES_SIZE;
+    CImage::TAttribute * tmp = (CImage::TAttribute *) realloc(m_attributes, size * sizeof (CImage::TAttribute));
+    if (tmp == NULL)
+        throw bad_alloc();
+    m_attributes = tmp;
+    m_sizeAttributes = size;
+}
+
+/*! Values memory management.
+ */
+void CImageWriter::ReallocValues() {
+    if (m_header.m_cntValues < m_sizeValues)
+        return;
+    size_t size = m_sizeValues ? m_sizeValues * REALLOC_CONSTANT : DEFAULT_VALUES_SIZE;
+    CImage::TValue * tmp = (CImage::TValue *) realloc(m_values, size * sizeof (CImage::TValue));
+    if (tmp == NULL)
+        throw bad_alloc();
+    m_values = tmp;
+    m_sizeValues = size;
+}
+
+/*! Heap memory management.
+ * \param size Needed size of the heap.
+ */
+void CImageWriter::ReallocHeap(size_t size) {
+    if (size <= m_sizeHeap)
+        return;
+    size_t newSize = m_sizeHeap ? m_sizeHeap : DEFAULT_HEAP_SIZE;
+    while (newSize < size)
+        newSize *= REALLOC_CONSTANT;
+    char * tmp = (char *) realloc(m_heap, newSize);
+    if (tmp == NULL)
+        throw bad_alloc();
+    m_heap = tmp;
+    m_sizeHeap = newSize;
+}
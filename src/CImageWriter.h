@@ -0,0 +1,67 @@
+#ifndef CIMAGEWRITER_H
+#define	CIMAGEWRITER_H
+
+#include <cstdlib>
+#include <string>
+#include <ctime>
+
+#include "CImage.h"
+#include "CText.h"
+#include "CAtomTable.h"
+
+using namespace std;
+
+///! Class, which makes the binary image of a parsed document. The nodes add themselves in preorder
+///! and the tables are written to the file at once, when the tree is complete. Values, which follow
+///! from the source of the nodes, are not stored.
+
+class CImageWriter {
+public:
+    CImageWriter(const char * data, size_t size, const CAtomTable * atoms);
+    ~CImageWriter();
+
+    //making the image
+    int AddNode(int kind, int name, const CText & source, unsigned int tagLength, const CText & value);
+    void AddAttribute(int name, const CText & value);
+    void EndChilds(int node);
+    void SetLazy(int node);
+    void SetVersionData(const CText & data);
+
+    bool WriteFile(const string & filePath, const struct timespec & modified);
+protected:
+    uint32_t AddText(const CText & text, const char * start, size_t size);
+    void ReallocNodes();
+    void ReallocAttributes();
+    void ReallocValues();
+    void ReallocHeap(size_t size);
+
+    ///! Pointer to the XML data, texts in the data are not copied
+    const char * m_data;
+    ///! Size of the XML data
+    size_t m_size;
+    ///! Names of the document, atoms are the indices of the names
+    const CAtomTable * m_atoms;
+    ///! Header of the image
+    CImage::THeader m_header;
+    ///! Table of the nodes
+    CImage::TNode * m_nodes;
+    ///! Current max count of the nodes
+    size_t m_sizeNodes;
+    ///! Table of the attributes
+    CImage::TAttribute * m_attributes;
+    ///! Current max count of the attributes
+    size_t m_sizeAttributes;
+    ///! Table of the values, which are not the texts between the tags
+    CImage::TValue * m_values;
+    ///! Current max count of the values
+    size_t m_sizeValues;
+    ///! The last added node in the XML data, values of its attributes are counted from its start
+    CText m_source;
+    ///! Texts, which are not in the XML data
+    char * m_heap;
+    ///! Size of the heap
+    size_t m_sizeHeap;
+};
+
+#endif	/* CIMAGEWRITER_H */
+
@@ -0,0 +1,139 @@
+#include <cstdlib>
+#include <string>
+#include <cerrno>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CMappedFile.h"
+#include "CException.h"
+
+///! Size of the first block read from the standard input
+#define READ_BLOCK_SIZE (64 * 1024)
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Maps the whole file to memory (read only). The standard input (STDIN_PATH) is mapped, if it is redirected
+ * from a file, otherwise it is read to memory.
+ * \param filePath Specifies file to map.
+ */
+CMappedFile::CMappedFile(const string & filePath) {
+    bool isStdin = filePath == STDIN_PATH;
+    int fd = isStdin ? STDIN_FILENO : open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw InvalidFileNameException(filePath);
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (!S_ISREG(info.st_mode) && !isStdin)) {
+        if (!isStdin)
+            close(fd);
+        throw InvalidFileNameException(filePath);
+    }
+
+    m_size = 0;
+    m_modified = info.st_mtim;
+    m_data = "";
+    m_isMapped = S_ISREG(info.st_mode);
+    try {
+        if (m_isMapped)
+            Map(fd, info.st_size, filePath);
+        else
+            Read(fd, filePath);
+    } catch (const CException & e) {
+        if (!isStdin)
+            close(fd);
+        throw;
+    }
+    //mapping stays valid without the descriptor
+    if (!isStdin)
+        close(fd);
+}
+
+/*! Unmaps the file.
+ */
+CMappedFile::~CMappedFile() {
+    if (!m_isMapped)
+        free((void *) m_data);
+    else if (m_size > 0)
+        munmap((void *) m_data, m_size);
+}
+
+/********************* GETTERS *******************************/
+
+/*! Gets the pointer to the file content.
+ */
+const char * CMappedFile::GetData() const {
+    return m_data;
+}
+
+/*! Gets the size of the file.
+ */
+size_t CMappedFile::GetSize() const {
+    return m_size;
+}
+
+/*! Gets the time of the last modification of the file (when it was mapped).
+ */
+const struct timespec & CMappedFile::GetModified() const {
+    return m_modified;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Maps the regular file.
+ * \param fd Descriptor of the file.
+ * \param size Size of the file.
+ * \param filePath Specifies the file (for exceptions).
+ */
+void CMappedFile::Map(int fd, size_t size, const string & filePath) {
+    //empty file cannot be mapped, but it can be "parsed"
+    if (size == 0)
+        return;
+    void * data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        throw InvalidFileNameException(filePath);
+    //the file is read from start to the end
+    madvise(data, size, MADV_SEQUENTIAL);
+    m_data = (const char *) data;
+    m_size = size;
+}
+
+/*! Reads the file, which cannot be mapped (like a pipe), to memory until its end.
+ * \param fd Descriptor of the file.
+ * \param filePath Specifies the file (for exceptions).
+ */
+void CMappedFile::Read(int fd, const string & filePath) {
+    size_t capacity = READ_BLOCK_SIZE;
+    char * data = (char *) malloc(capacity);
+    if (data == NULL)
+        throw bad_alloc();
+    while (true) {
+        if (m_size == capacity) {
+            char * tmp = (char *) realloc(data, capacity * REALLOC_CONSTANT);
+            if (tmp == NULL) {
+                free(data);
+                throw bad_alloc();
+            }
+            data = tmp;
+            capacity *= REALLOC_CONSTANT;
+        }
+        ssize_t count = read(fd, data + m_size, capacity - m_size);
+        if (count == 0)
+            break;
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            free(data);
+            m_size = 0;
+            throw InvalidFileNameException(filePath);
+        }
+        m_size += count;
+    }
+    m_data = data;
+}
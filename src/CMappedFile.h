@@ -0,0 +1,38 @@
+#ifndef CMAPPEDFILE_H
+#define	CMAPPEDFILE_H
+
+#include <cstdlib>
+#include <string>
+#include <ctime>
+
+using namespace std;
+
+///! Path of the standard input, it is read to memory, if it cannot be mapped (like a pipe)
+#define STDIN_PATH "-"
+
+///! Class, which maps the whole file to memory, so it can be parsed without copying.
+
+class CMappedFile {
+public:
+    CMappedFile(const string & filePath);
+    ~CMappedFile();
+
+    const char * GetData() const;
+    size_t GetSize() const;
+    const struct timespec & GetModified() const;
+protected:
+    void Map(int fd, size_t size, const string & filePath);
+    void Read(int fd, const string & filePath);
+
+    ///! Pointer to the mapped file content
+    const char * m_data;
+    ///! Size of the file
+    size_t m_size;
+    ///! Time of the last modification of the file
+    struct timespec m_modified;
+    ///! Is the content mapped (or read to memory)?
+    bool m_isMapped;
+};
+
+#endif	/* CMAPPEDFILE_H */
+
@@ -1,11 +1,16 @@
 #include <cstdlib>
+#include <cstring>
 #include <string>
-#include <fstream>
+#include <pthread.h>
 
 #include "CAttribute.h"
 #include "CNode.h"
 #include "functions.h"
 #include "CException.h"
+#include "CXMLReader.h"
+#include "CTreeBuilder.h"
+#include "CScanner.h"
+#include "CImageReader.h"
 
 ///! Default count of attributes
 #define DEFAULT_ATTRIBUTES_SIZE 3
@@ -18,54 +23,63 @@ using namespace std;
 
 /********************* PUBLIC SHARED METHODS *******************************/
 
-/*! Creates new node, allocates its attributes.
+/*! Creates new node without title.
  */
 CNode::CNode() {
-    m_cntAtt = 0;
-    m_attributes = new CAttribute * [DEFAULT_ATTRIBUTES_SIZE];
-    m_sizeAtt = DEFAULT_ATTRIBUTES_SIZE;
-
-    m_id = 0;
-    m_parent = NULL;
-
-    m_output = new string;
-    m_xmloutput = new string;
-
-    m_isCollapsed = false;
+    Init(-1);
 }
 
-/*! Creates new node with given title, allocates its attributes.
+/*! Creates new node with given title.
  * \param title Title of the element.
  */
-CNode::CNode(string & title) {
-    if (IsValidTitle(title))
-        m_title = title;
-    else
-        throw InvalidXMLTitleException(title);
-    m_cntAtt = 0;
-
-    m_attributes = new CAttribute * [DEFAULT_ATTRIBUTES_SIZE];
-    m_sizeAtt = DEFAULT_ATTRIBUTES_SIZE;
-
-    m_id = 0;
-    m_parent = NULL;
-
-    m_output = new string;
-    m_xmloutput = new string;
+CNode::CNode(const CText & title) {
+    if (!IsValidTitle(title))
+        throw InvalidXMLTitleException(title.GetString());
+    Init(CArena::GetOwner(this)->GetAtoms()->Add(title));
+}
 
-    m_isCollapsed = false;
+/*! Creates new node with checked title.
+ * \param name Atom of the title of the element.
+ */
+CNode::CNode(int name) {
+    Init(name);
 }
 
-/*! Tidies up.
+/*! Tidies up, the memory is given back to the arena and the node leaves the titles index.
  */
 CNode::~CNode() {
+    CArena * arena = CArena::GetOwner(this);
+    if (m_indexPos >= 0)
+        arena->GetIndex()->Remove(m_name, this);
+    InvalidateRow();
 
     for (int i = 0; i < m_cntAtt; i++) {
         delete m_attributes[i];
     }
-    delete [] m_attributes;
-    delete m_output;
-    delete m_xmloutput;
+    arena->Free(m_attributes, m_sizeAtt * sizeof (CAttribute *));
+}
+
+/*! Allocates the node in the arena.
+ * \param size Size of the node.
+ * \param arena Pointer to the arena of the document.
+ */
+void * CNode::operator new(size_t size, CArena * arena) {
+    return arena->AllocObject(size);
+}
+
+/*! Frees the node, which could not be created.
+ * \param p Pointer to the node.
+ * \param arena Pointer to the arena of the document.
+ */
+void CNode::operator delete(void * p, CArena * arena) {
+    CArena::FreeObject(p);
+}
+
+/*! Gives the memory of the node back to its arena.
+ * \param p Pointer to the node.
+ */
+void CNode::operator delete(void * p) {
+    CArena::FreeObject(p);
 }
 
 /********************* ATTRIBUTES METHODS *******************************/
@@ -76,13 +90,13 @@ CNode::~CNode() {
 void CNode::InsertAttribute(CAttribute * attribute) {
     //is there enough space?
     ReallocAttributes();
-    string attrName = attribute->GetName();
-
     //there cannot be two attributes with same name
-    if (AttributeExists(attrName))
-        throw AttributeAlreadyExistsException(attrName);
+    if (AttributeExists(attribute->GetAtom()))
+        throw AttributeAlreadyExistsException(attribute->GetName());
 
     m_attributes[m_cntAtt++] = attribute;
+    InvalidateRow();
+    Changed();
 }
 
 /*! Removes the attribute specified by name.
@@ -91,9 +105,10 @@ void CNode::InsertAttribute(CAttribute * attribute) {
 void CNode::RemoveAttribute(string& name) {
     //if there is no attribute with given name, pos will remain negative
     int pos = -1;
+    int atom = CArena::GetOwner(this)->GetAtoms()->Find(name);
 
     for (int i = 0; i < m_cntAtt; i++) {
-        if (m_attributes[i]->GetName() == name)
+        if (m_attributes[i]->GetAtom() == atom)
             pos = i;
     }
 
@@ -106,14 +121,21 @@ void CNode::RemoveAttribute(string& name) {
         m_attributes[i] = m_attributes[i + 1];
     }
     m_cntAtt--;
+    InvalidateRow();
+    Changed();
 }
 
-/*! Sends the attributes of this element to interface.
- * \param interface Pointer to the interface.
+/*! Gets the count of attributes of this element.
  */
-void CNode::GetAttributes(CGUI* interface) {
-    for (int i = 0; i < m_cntAtt; i++)
-        interface->AddAttributeItem(m_attributes[i]->GetNamePointer(), m_attributes[i]->GetValuePointer());
+int CNode::GetAttributeCount() const {
+    return m_cntAtt;
+}
+
+/*! Gets an attribute of this element.
+ * \param id Index of the attribute (from 0 to the count of attributes).
+ */
+const CAttribute * CNode::GetAttribute(int id) const {
+    return m_attributes[id];
 }
 
 /********************* SETTERS *******************************/
@@ -122,10 +144,19 @@ void CNode::GetAttributes(CGUI* interface) {
  * \param title New title.
  */
 void CNode::SetTitle(string& title) {
-    if (IsValidTitle(title))
-        m_title = title;
-    else
+    if (!IsValidTitle(title))
         throw InvalidXMLTitleException(title);
+
+    //indexed node moves to the list of the new title
+    CArena * arena = CArena::GetOwner(this);
+    InvalidateRow();
+    if (m_indexPos >= 0) {
+        arena->GetIndex()->Remove(m_name, this);
+        m_name = arena->GetAtoms()->Add(title);
+        arena->GetIndex()->Insert(m_name, this);
+    } else
+        m_name = arena->GetAtoms()->Add(title);
+    Changed();
 }
 
 /*! Sets the id of an element.
@@ -135,6 +166,13 @@ void CNode::SetID(int id) {
     m_id = id;
 }
 
+/*! Sets the position of the node in the titles index, it is called by the index.
+ * \param position New position, -1 if the node is not indexed.
+ */
+void CNode::SetIndexPosition(int position) {
+    m_indexPos = position;
+}
+
 /*! Sets the parent of an element.
  * \param parent Pointer to new parent.
  */
@@ -147,7 +185,19 @@ void CNode::SetParent(CNode* parent) {
 /*! Gets the element title.
  */
 string CNode::GetTitle() const {
-    return m_title;
+    return GetTitleText().GetString();
+}
+
+/*! Gets the element title without copying it.
+ */
+const CText & CNode::GetTitleText() const {
+    return CArena::GetOwner(this)->GetAtoms()->Get(m_name);
+}
+
+/*! Gets the atom of the element title.
+ */
+int CNode::GetAtom() const {
+    return m_name;
 }
 
 /*! Gets the element id.
@@ -162,17 +212,72 @@ CNode * CNode::GetParent() const {
     return m_parent;
 }
 
+/*! Gets the position of the node in the titles index, -1 if the node is not indexed.
+ */
+int CNode::GetIndexPosition() const {
+    return m_indexPos;
+}
+
+/*! Finds out, if the node is collapsed.
+ */
+bool CNode::IsCollapsed() const {
+    return m_isCollapsed;
+}
+
+/*! Gets the count of visible rows of the node and its descendants.
+ */
+int CNode::GetRowCount() const {
+    return m_cntRows;
+}
+
+/*! Is the node or any of its descendants different from the file?
+ */
+bool CNode::IsDirty() const {
+    return m_isDirty;
+}
+
+/********************* SOURCE IN THE FILE *******************************/
+
+/*! Gets the node as it is in the file (from its start tag to its end tag).
+ * \return The source, empty text for new nodes.
+ */
+const CText & CNode::GetSource() const {
+    return m_source;
+}
+
+/*! Sets the start of the source, it is called by the builder, when the start tag is read.
+ * \param tag The start tag in the data.
+ */
+void CNode::StartSource(const CText & tag) {
+    m_source = tag;
+    m_tagLength = tag.GetLength();
+}
+
+/*! Sets the end of the source, it is called by the builder, when the end tag is read.
+ * The node is the same as in the file then (its descendants were read too).
+ * \param tag The end tag in the data (the whole markup for nodes without childs).
+ */
+void CNode::EndSource(const CText & tag) {
+    m_source = CText(m_source.GetData(), tag.GetData() + tag.GetLength() - m_source.GetData());
+    m_isChanged = false;
+    m_isDirty = false;
+}
+
 /********************* COLLAPSE / EXPAND TOOLS *******************************/
 
 /*! Collapses current node.
  */
 void CNode::Collapse() {
+    if (!m_isCollapsed)
+        InvalidateRow();
     m_isCollapsed = true;
 }
 
 /*! Expands current node.
  */
 void CNode::Expand() {
+    if (m_isCollapsed)
+        InvalidateRow();
     m_isCollapsed = false;
 }
 
@@ -186,287 +291,668 @@ void CNode::ExpandUp() {
 
 /********************* SHARED PRIVATE TOOLS *******************************/
 
+/*! Forgets the cached text of the row, it is made again, when the row is shown.
+ */
+void CNode::InvalidateRow() {
+    if (m_row) {
+        CArena::GetOwner(this)->Free(m_row, m_rowLength);
+        m_row = NULL;
+    }
+}
+
 /*! Finds out if an attribute exists.
- * \param name The name of the attribute.
+ * \param name The atom of the name of the attribute.
  * \return Return if attribute with specified name exists.
  */
-bool CNode::AttributeExists(string& name) const {
+bool CNode::AttributeExists(int name) const {
     for (int i = 0; i < m_cntAtt; i++) {
-        if (m_attributes[i]->GetName() == name)
+        if (m_attributes[i]->GetAtom() == name)
             return true;
     }
     return false;
 }
 
-/*! Attributes memory management.
+/*! Marks the node as changed, its tags are made again, when it is saved.
+ */
+void CNode::Changed() {
+    m_isChanged = true;
+    MarkDirty();
+}
+
+/*! Marks the node and its parents as different from the file, their sources cannot be saved as they are.
+ * Parents of dirty node are already dirty, so only the clean ones are visited.
+ */
+void CNode::MarkDirty() {
+    for (CNode * node = this; node && !node->m_isDirty; node = node->m_parent)
+        node->m_isDirty = true;
+}
+
+/*! Writes the source of the node, if neither the node, nor its descendants changed.
+ * Other formats than the source print every node.
+ * \param writer Writer of the file.
+ * \return False, if the node has to be printed.
+ */
+bool CNode::XMLPrintSource(CXMLWriter & writer) const {
+    if (m_isDirty || writer.GetFormat() != WRITER_SOURCE)
+        return false;
+    writer.WriteBlock(m_source);
+    return true;
+}
+
+/*! Prints the title and the attributes of the element, the tag is not closed.
+ * \param writer Writer of the file.
+ */
+void CNode::XMLPrintStartTag(CXMLWriter & writer) const {
+    writer.Write("<");
+    writer.Write(GetTitleText());
+    for (int i = 0; i < m_cntAtt; i++) {
+        writer.Write(" ");
+        writer.Write(m_attributes[i]->GetNameText());
+        writer.Write("=\"");
+        writer.Write(m_attributes[i]->GetValueText());
+        writer.Write("\"");
+    }
+}
+
+/*! Adds the node with its attributes to the image of the document.
+ * \param image The image.
+ * \param kind Kind of the node in the image.
+ * \param value Text of the node (or unparsed childs).
+ * \return Index of the node in the image.
+ */
+int CNode::ImagePrintNode(CImageWriter & image, int kind, const CText & value) const {
+    int node = image.AddNode(kind, m_name, m_source, m_tagLength, value);
+    for (int i = 0; i < m_cntAtt; i++)
+        image.AddAttribute(m_attributes[i]->GetAtom(), m_attributes[i]->GetValueText());
+    return node;
+}
+
+/*! Attributes memory management, the array is allocated with the first attribute.
  */
 void CNode::ReallocAttributes() {
-    if (m_cntAtt >= m_sizeAtt - 2) {
-        CAttribute ** tmp = new CAttribute * [m_sizeAtt * REALLOC_CONSTANT];
+    if (m_sizeAtt == 0) {
+        m_attributes = (CAttribute **) CArena::GetOwner(this)->Alloc(DEFAULT_ATTRIBUTES_SIZE * sizeof (CAttribute *));
+        m_sizeAtt = DEFAULT_ATTRIBUTES_SIZE;
+    } else if (m_cntAtt >= m_sizeAtt - 2) {
+        CArena * arena = CArena::GetOwner(this);
+        CAttribute ** tmp = (CAttribute **) arena->Alloc(m_sizeAtt * REALLOC_CONSTANT * sizeof (CAttribute *));
         for (int i = 0; i < m_cntAtt; i++) {
             tmp[i] = m_attributes[i];
         }
 
-        delete [] m_attributes;
+        arena->Free(m_attributes, m_sizeAtt * sizeof (CAttribute *));
         m_attributes = tmp;
         m_sizeAtt *= REALLOC_CONSTANT;
     }
 }
 
 
+/*! Initializes new node, which has no attributes yet (they are allocated, when the first one is inserted).
+ * \param name Atom of the title of the element, -1 for nodes without title.
+ */
+void CNode::Init(int name) {
+    m_name = name;
+    m_attributes = NULL;
+    m_cntAtt = 0;
+    m_sizeAtt = 0;
+
+    m_id = 0;
+    m_parent = NULL;
+    m_indexPos = -1;
+    m_cntRows = 1;
+    m_row = NULL;
+
+    //new node is not in the file, the builder sets its source
+    m_tagLength = 0;
+    m_isChanged = true;
+    m_isDirty = true;
+
+    m_isCollapsed = false;
+}
+
+/********************* VISIBLE ROWS TOOLS *******************************/
+
+/*! Gets the text of the row of the node, it is made again only if the node changed
+ * since it was made last time.
+ * \param depth Specifies how deep in the tree current node is.
+ * \return The text of the row, it is valid until the node changes.
+ */
+CText CNode::GetRow(int depth) {
+    if (m_row == NULL || m_rowDepth != depth) {
+        string output;
+        Print(output, depth);
+
+        InvalidateRow();
+        m_row = (char *) CArena::GetOwner(this)->Alloc(output.length());
+        memcpy(m_row, output.data(), output.length());
+        m_rowLength = output.length();
+        m_rowDepth = depth;
+    }
+    return CText(m_row, m_rowLength);
+}
+
+/*! Adds the change of count of visible rows to the node and its parents, the parents count them by child ids too.
+ * \param count Count of added rows (negative for removed rows).
+ */
+void CNode::ChangeRowCount(int count) {
+    for (CNode * node = this; node; node = node->m_parent) {
+        node->m_cntRows += count;
+        if (node->m_parent)
+            ((CParentNode *) node->m_parent)->ChangeChildRows(node->m_id, count);
+    }
+}
+
+/*! Sets the count of visible rows of the node and its descendants, the parent gets the change
+ * (the parents above are changed by the caller).
+ * \param count New count of rows.
+ */
+void CNode::SetRowCount(int count) {
+    if (m_parent)
+        ((CParentNode *) m_parent)->ChangeChildRows(m_id, count - m_cntRows);
+    m_cntRows = count;
+}
+
+/*! Counts the visible rows of the childs in front of the child, nodes without childs have none.
+ * \param id Child id.
+ */
+int CNode::CountRowsBefore(int id) const {
+    return 0;
+}
+
+/*! Counts the visible rows of the childs in front of the child, the Fenwick tree sums them in O(log childs).
+ * \param id Child id.
+ */
+int CParentNode::CountRowsBefore(int id) const {
+    int count = 0;
+    for (int i = id; i > 0; i -= i & -i)
+        count += m_childRows[i];
+    return count;
+}
+
+/*! Adds the change of count of visible rows of the child to the Fenwick tree.
+ * \param id Child id.
+ * \param count Count of added rows (negative for removed rows).
+ */
+void CParentNode::ChangeChildRows(int id, int count) {
+    for (int i = id + 1; i <= m_cntChilds; i += i & -i)
+        m_childRows[i] += count;
+}
+
+/*! Builds the Fenwick tree of counts of visible rows of the childs again in O(childs),
+ * it is done after the ids of the childs are changed.
+ */
+void CParentNode::SumChildRows() {
+    for (int i = 1; i <= m_cntChilds; i++)
+        m_childRows[i] = m_childs[i - 1]->GetRowCount();
+    for (int i = 1; i <= m_cntChilds; i++) {
+        int next = i + (i & -i);
+        if (next <= m_cntChilds)
+            m_childRows[next] += m_childRows[i];
+    }
+}
+
+/*! Adds the rows of the childs in given range after the rows of this node, the childs must be the last ones.
+ * \param rows The list of visible rows, rows of this node are at its end.
+ * \param depth Specifies how deep in the tree this node is.
+ * \param from Id of the first child.
+ * \param to Id after the last child.
+ */
+void CParentNode::ListChildRows(CRowList * rows, int depth, int from, int to) {
+    if (m_isCollapsed)
+        return;
+    int first = rows->GetCount();
+    for (int i = from; i < to; i++) {
+        m_childs[i]->ListRows(rows, depth + 1);
+    }
+    ChangeRowCount(rows->GetCount() - first);
+}
+
+/*! Finds a child with given title, nodes without childs have none.
+ * \param name Atom of the title.
+ * \param number Which of the childs with the title is wanted (from 1).
+ * \return Pointer to the child, NULL if there is not such child.
+ */
+CNode * CNode::FindChild(int name, int number) {
+    return NULL;
+}
+
+/*! Gets the count of childs, nodes without childs have none.
+ */
+int CNode::GetChildCount() {
+    return 0;
+}
+
+/*! Gets a child, nodes without childs have none.
+ * \param id Child id.
+ */
+CNode * CNode::GetChild(int id) {
+    throw InvalidChildID(id);
+}
+
+/*! Parses all unparsed descendants, nodes without childs have none.
+ */
+void CNode::LoadAll() {
+}
+
+/*! Finds a child with given title, unparsed childs are parsed first.
+ * \param name Atom of the title.
+ * \param number Which of the childs with the title is wanted (from 1).
+ * \return Pointer to the child, NULL if there is not such child.
+ */
+CNode * CParentNode::FindChild(int name, int number) {
+    Load();
+    for (int i = 0; i < m_cntChilds; i++) {
+        if (m_childs[i]->GetAtom() == name && --number == 0)
+            return m_childs[i];
+    }
+    return NULL;
+}
+
+/*! Gets the count of childs, unparsed childs are parsed first.
+ */
+int CParentNode::GetChildCount() {
+    Load();
+    return m_cntChilds;
+}
+
+/*! Gets a child, unparsed childs are parsed first.
+ * \param id Child id.
+ */
+CNode * CParentNode::GetChild(int id) {
+    Load();
+    if (id < 0 || id >= m_cntChilds)
+        throw InvalidChildID(id);
+    return m_childs[id];
+}
+
 /********************* VIRTUAL PUBLIC TOOLS *******************************/
 
 /********************* VIRTUAL PRINT *******************************/
 
-/*! Prints the text node to the interface menu.
- * \param interface Pointer to the interface.
+/*! Adds the row of the node to the visible rows.
+ * \param rows The list of visible rows.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CTextNode::Print(CGUI * interface, int depth) {
-    m_output->clear();
+void CNode::ListRows(CRowList * rows, int depth) {
+    rows->Add(this, depth);
+    SetRowCount(1);
+}
+
+/*! Adds the row of the parent node to the visible rows (and recursively rows of expanded childs).
+ * \param rows The list of visible rows.
+ * \param depth Specifies how deep in the tree current node is.
+ */
+void CParentNode::ListRows(CRowList * rows, int depth) {
+    int first = rows->GetCount();
+    rows->Add(this, depth);
+    if (!m_isCollapsed) {
+        for (int i = 0; i < m_cntChilds; i++) {
+            m_childs[i]->ListRows(rows, depth + 1);
+        }
+    }
+    SetRowCount(rows->GetCount() - first);
+}
+
+/*! Prints the row of the text node.
+ * \param output The text of the row.
+ * \param depth Specifies how deep in the tree current node is.
+ */
+void CTextNode::Print(string & output, int depth) const {
+    output.clear();
     for (int i = 0; i < depth; i++) {
-        m_output->append("   ");
+        output.append("   ");
     }
 
     if (m_isCollapsed)
-        m_output->append("[+] ");
+        output.append("[+] ");
     else
-        m_output->append("[-] ");
+        output.append("[-] ");
 
-    m_output->append(m_title);
+    GetTitleText().AppendTo(output);
     if (!m_isCollapsed) {
-        m_output->append(" ");
-        m_output->append("( ");
+        output.append(" ");
+        output.append("( ");
         for (int i = 0; i < m_cntAtt; i++) {
-            m_output->append(m_attributes[i]->GetName());
-            m_output->append("=");
-            m_output->append(m_attributes[i]->GetValue());
-            m_output->append(" ");
+            m_attributes[i]->GetNameText().AppendTo(output);
+            output.append("=");
+            m_attributes[i]->GetValueText().AppendTo(output);
+            output.append(" ");
         }
-        m_output->append(")");
-        m_output->append(" - ");
+        output.append(")");
+        output.append(" - ");
 
-        m_output->append(m_value);
+        m_value.AppendTo(output);
     }
-    interface->AddMenuItem(m_output, dynamic_cast<CNode *> (this), "T");
 }
 
-/*! Prints the comment node to the interface menu.
- * \param interface Pointer to the interface.
+/*! Prints the row of the comment node.
+ * \param output The text of the row.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CCommentNode::Print(CGUI * interface, int depth) {
-    m_output->clear();
+void CCommentNode::Print(string & output, int depth) const {
+    output.clear();
     for (int i = 0; i < depth; i++) {
-        m_output->append("   ");
+        output.append("   ");
     }
     if (m_isCollapsed)
-        m_output->append("[+] ");
+        output.append("[+] ");
     else
-        m_output->append("[-] ");
+        output.append("[-] ");
 
-    m_output->append("// ");
+    output.append("// ");
     if (!m_isCollapsed)
-        m_output->append(m_comment);
+        m_comment.AppendTo(output);
 
-    interface->AddMenuItem(m_output, dynamic_cast<CNode *> (this), "C");
 }
 
-/*! Prints the parent node to the interface menu (and recursively childs).
- * \param interface Pointer to the interface.
+/*! Prints the row of the parent node.
+ * \param output The text of the row.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CParentNode::Print(CGUI * interface, int depth) {
-    m_output->clear();
+void CParentNode::Print(string & output, int depth) const {
+    output.clear();
     for (int i = 0; i < depth; i++) {
-        m_output->append("   ");
+        output.append("   ");
     }
     if (m_isCollapsed)
-        m_output->append("[+] ");
+        output.append("[+] ");
     else
-        m_output->append("[-] ");
+        output.append("[-] ");
 
-    m_output->append(m_title);
+    GetTitleText().AppendTo(output);
     if (!m_isCollapsed) {
-        m_output->append(" ");
-        m_output->append("( ");
+        output.append(" ");
+        output.append("( ");
         for (int i = 0; i < m_cntAtt; i++) {
-            m_output->append(m_attributes[i]->GetName());
-            m_output->append("=");
-            m_output->append(m_attributes[i]->GetValue());
-            m_output->append(" ");
-        }
-        m_output->append(")");
-    }
-    interface->AddMenuItem(m_output, dynamic_cast<CNode *> (this), "P");
-    if (!m_isCollapsed) {
-        for (int i = 0; i < m_cntChilds; i++) {
-            m_childs[i]->Print(interface, depth + 1);
+            m_attributes[i]->GetNameText().AppendTo(output);
+            output.append("=");
+            m_attributes[i]->GetValueText().AppendTo(output);
+            output.append(" ");
         }
+        output.append(")");
     }
 }
 
-/*! Prints the simple node to the interface menu.
- * \param interface Pointer to the interface.
+/*! Prints the row of the simple node.
+ * \param output The text of the row.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CSimpleNode::Print(CGUI * interface, int depth) {
-    m_output->clear();
+void CSimpleNode::Print(string & output, int depth) const {
+    output.clear();
     for (int i = 0; i < depth; i++) {
-        m_output->append("   ");
+        output.append("   ");
     }
 
     if (m_isCollapsed)
-        m_output->append("[+] ");
+        output.append("[+] ");
     else
-        m_output->append("[-] ");
+        output.append("[-] ");
 
-    m_output->append(m_title);
+    GetTitleText().AppendTo(output);
     if (!m_isCollapsed) {
-        m_output->append(" ");
-        m_output->append("( ");
+        output.append(" ");
+        output.append("( ");
         for (int i = 0; i < m_cntAtt; i++) {
-            m_output->append(m_attributes[i]->GetName());
-            m_output->append("=");
-            m_output->append(m_attributes[i]->GetValue());
-            m_output->append(" ");
+            m_attributes[i]->GetNameText().AppendTo(output);
+            output.append("=");
+            m_attributes[i]->GetValueText().AppendTo(output);
+            output.append(" ");
         }
-        m_output->append(")");
+        output.append(")");
     }
-    interface->AddMenuItem(m_output, dynamic_cast<CNode *> (this), "S");
 }
 
 /********************* VIRTUAL XML PRINT *******************************/
 
-/*! Prints the text node to the XML file in valid XML format.
- * \param file File stream.
+/*! Prints the white spaces in front of the node, they are copied from the file, new nodes start on new line.
+ * Pretty format puts every node on new line, minified format has no white spaces.
+ * \param writer Writer of the file.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CTextNode::XMLPrint(ofstream & file, int depth) {
-    m_xmloutput->clear();
-    for (int i = 0; i < depth; i++) {
-        m_xmloutput->append("\t");
+void CNode::XMLPrintIndent(CXMLWriter & writer, int depth) const {
+    if (writer.GetFormat() == WRITER_MINIFY)
+        return;
+    if (m_source.GetLength() == 0 || writer.GetFormat() == WRITER_PRETTY) {
+        writer.WriteLine();
+        writer.WriteIndent(depth);
+        return;
     }
-    m_xmloutput->append("<");
-    m_xmloutput->append(m_title);
-    for (int i = 0; i < m_cntAtt; i++) {
-        m_xmloutput->append(" ");
-        m_xmloutput->append(m_attributes[i]->GetName());
-        m_xmloutput->append("=\"");
-        m_xmloutput->append(m_attributes[i]->GetValue());
-        m_xmloutput->append("\"");
-    }
-    m_xmloutput->append(">");
-    m_xmloutput->append(m_value);
-    m_xmloutput->append("</");
-    m_xmloutput->append(m_title);
-    m_xmloutput->append(">");
-
-    file << *m_xmloutput << endl;
+    //there is always the end of other tag in front of the white spaces
+    const char * start = CScanner::SkipWhitespacesBack(m_source.GetData());
+    writer.Write(start, m_source.GetData() - start);
 }
 
-/*! Prints the comment node to the XML file in valid XML format.
- * \param file File stream.
+/*! Prints the text node to the XML file in valid XML format, unchanged node is copied from the file.
+ * \param writer Writer of the file.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CCommentNode::XMLPrint(ofstream& file, int depth) {
-    m_xmloutput->clear();
-    for (int i = 0; i < depth; i++) {
-        m_xmloutput->append("\t");
-    }
-    m_xmloutput->append("<!-- ");
-    m_xmloutput->append(m_comment);
-    m_xmloutput->append("-->");
+void CTextNode::XMLPrint(CXMLWriter & writer, int depth) {
+    if (XMLPrintSource(writer))
+        return;
+    XMLPrintStartTag(writer);
+    writer.Write(">");
+    writer.Write(m_value);
+    writer.Write("</");
+    writer.Write(GetTitleText());
+    writer.Write(">");
+}
 
-    file << *m_xmloutput << endl;
+/*! Prints the comment node to the XML file in valid XML format, unchanged node is copied from the file.
+ * \param writer Writer of the file.
+ * \param depth Specifies how deep in the tree current node is.
+ */
+void CCommentNode::XMLPrint(CXMLWriter & writer, int depth) {
+    if (XMLPrintSource(writer))
+        return;
+    writer.Write("<!-- ");
+    writer.Write(m_comment);
+    writer.Write("-->");
 }
 
 /*! Prints the parent node to the XML file in valid XML format (and child recursively).
- * \param file File stream.
+ * Unchanged subtree is copied from the file, unchanged tags and white spaces of changed subtree too.
+ * \param writer Writer of the file.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CParentNode::XMLPrint(ofstream& file, int depth) {
-    m_xmloutput->clear();
-    for (int i = 0; i < depth; i++) {
-        m_xmloutput->append("\t");
+void CParentNode::XMLPrint(CXMLWriter & writer, int depth) {
+    if (XMLPrintSource(writer))
+        return;
+    //tags of other formats are printed again
+    bool isCopied = !m_isChanged && writer.GetFormat() == WRITER_SOURCE;
+    if (!isCopied) {
+        XMLPrintStartTag(writer);
+        writer.Write(">");
+    } else
+        writer.Write(m_source.Sub(0, m_tagLength));
+
+    //the end tag is the last tag of the source
+    const char * endTag = m_source.GetData() + m_source.GetLength();
+    if (m_source.GetLength()) {
+        while (*--endTag != 60)
+            ;
     }
-    m_xmloutput->append("<");
-    m_xmloutput->append(m_title);
-    for (int i = 0; i < m_cntAtt; i++) {
-        m_xmloutput->append(" ");
-        m_xmloutput->append(m_attributes[i]->GetName());
-        m_xmloutput->append("=\"");
-        m_xmloutput->append(m_attributes[i]->GetValue());
-        m_xmloutput->append("\"");
+
+    if (m_isLazy) {
+        //unparsed childs are copied from the source as they are
+        writer.WriteBlock(m_lazy);
+    } else {
+        int threads = depth == 0 ? CXMLWriter::CountPrintThreads(m_cntChilds) : 1;
+        if (threads > 1)
+            XMLPrintParallel(writer, depth + 1, threads);
+        else
+            XMLPrintChilds(writer, depth + 1, 0, m_cntChilds);
+        if (writer.GetFormat() == WRITER_SOURCE && m_source.GetLength()) {
+            const char * start = CScanner::SkipWhitespacesBack(endTag);
+            writer.Write(start, endTag - start);
+        } else if (writer.GetFormat() == WRITER_SOURCE || (writer.GetFormat() == WRITER_PRETTY && m_cntChilds)) {
+            writer.WriteLine();
+            writer.WriteIndent(depth);
+        }
     }
-    m_xmloutput->append(">");
 
-    file << *m_xmloutput << endl;
-    for (int i = 0; i < m_cntChilds; i++) {
-        m_childs[i]->XMLPrint(file, depth + 1);
+    if (!isCopied) {
+        writer.Write("</");
+        writer.Write(GetTitleText());
+        writer.Write(">");
+    } else
+        writer.Write(endTag, m_source.GetData() + m_source.GetLength() - endTag);
+}
+
+/*! Prints the childs (with the white spaces in front of them) to the XML file.
+ * \param writer Writer of the file.
+ * \param depth Specifies how deep in the tree the childs are.
+ * \param from Index of the first child.
+ * \param to Index after the last child.
+ */
+void CParentNode::XMLPrintChilds(CXMLWriter & writer, int depth, int from, int to) {
+    for (int i = from; i < to; i++) {
+        m_childs[i]->XMLPrintIndent(writer, depth);
+        m_childs[i]->XMLPrint(writer, depth);
     }
-    m_xmloutput->clear();
-    for (int i = 0; i < depth; i++) {
-        m_xmloutput->append("\t");
+}
+
+/*! Prints the childs by more threads, each thread prints its part of the childs to its own snapshot writer
+ * and the parts are appended to the writer in order. The tree does not change, while it is printed.
+ * \param writer Writer of the file.
+ * \param depth Specifies how deep in the tree the childs are.
+ * \param threads Count of threads to use.
+ */
+void CParentNode::XMLPrintParallel(CXMLWriter & writer, int depth, int threads) {
+    TPrintJob * jobs = new TPrintJob [threads];
+    pthread_t * ids = new pthread_t [threads];
+    bool * started = new bool [threads];
+    for (int i = 0; i < threads; i++) {
+        jobs[i].m_parent = this;
+        jobs[i].m_depth = depth;
+        jobs[i].m_from = (int) ((long) m_cntChilds * i / threads);
+        jobs[i].m_to = (int) ((long) m_cntChilds * (i + 1) / threads);
+        jobs[i].m_writer = new CXMLWriter();
+        jobs[i].m_writer->SetFormat(writer.GetFormat());
+        //the first part is printed by this thread
+        started[i] = i > 0 && pthread_create(&ids[i], NULL, PrintRangeThread, &jobs[i]) == 0;
     }
-    m_xmloutput->append("</");
-    m_xmloutput->append(m_title);
-    m_xmloutput->append(">");
-    file << *m_xmloutput << endl;
+
+    for (int i = 0; i < threads; i++) {
+        if (started[i])
+            pthread_join(ids[i], NULL);
+        else
+            PrintRangeThread(&jobs[i]);
+        writer.Append(jobs[i].m_writer);
+    }
+    delete [] jobs;
+    delete [] ids;
+    delete [] started;
+}
+
+/*! Thread function, which prints part of the childs to the snapshot writer of the job.
+ * \param job Pointer to the TPrintJob.
+ */
+void * CParentNode::PrintRangeThread(void * job) {
+    TPrintJob * printJob = (TPrintJob *) job;
+    printJob->m_parent->XMLPrintChilds(*printJob->m_writer, printJob->m_depth, printJob->m_from, printJob->m_to);
+    return NULL;
 }
 
-/*! Prints the simple node to the XML file in valid XML format (and child recursively).
- * \param file File stream.
+/*! Prints the simple node to the XML file in valid XML format, unchanged node is copied from the file.
+ * \param writer Writer of the file.
  * \param depth Specifies how deep in the tree current node is.
  */
-void CSimpleNode::XMLPrint(ofstream & file, int depth) {
-    m_xmloutput->clear();
-    for (int i = 0; i < depth; i++) {
-        m_xmloutput->append("\t");
-    }
-    m_xmloutput->append("<");
-    m_xmloutput->append(m_title);
-    for (int i = 0; i < m_cntAtt; i++) {
-        m_xmloutput->append(" ");
-        m_xmloutput->append(m_attributes[i]->GetName());
-        m_xmloutput->append("=\"");
-        m_xmloutput->append(m_attributes[i]->GetValue());
-        m_xmloutput->append("\"");
+void CSimpleNode::XMLPrint(CXMLWriter & writer, int depth) {
+    if (XMLPrintSource(writer))
+        return;
+    XMLPrintStartTag(writer);
+    writer.Write(" />");
+}
+
+/*! Adds the text node to the image of the document.
+ * \param image The image.
+ */
+void CTextNode::ImagePrint(CImageWriter & image) const {
+    ImagePrintNode(image, NEXT_IS_TEXTNODE, m_value);
+}
+
+/*! Adds the comment node to the image of the document.
+ * \param image The image.
+ */
+void CCommentNode::ImagePrint(CImageWriter & image) const {
+    ImagePrintNode(image, NEXT_IS_COMMENT, m_comment);
+}
+
+/*! Adds the parent node to the image of the document (and childs recursively), unparsed childs are added as they are.
+ * \param image The image.
+ */
+void CParentNode::ImagePrint(CImageWriter & image) const {
+    int node = ImagePrintNode(image, NEXT_IS_PARENTNODE, m_lazy);
+    if (m_isLazy) {
+        image.SetLazy(node);
+        return;
     }
-    m_xmloutput->append(" />");
-    file << *m_xmloutput << endl;
+    for (int i = 0; i < m_cntChilds; i++)
+        m_childs[i]->ImagePrint(image);
+    image.EndChilds(node);
 }
 
+/*! Adds the simple node to the image of the document.
+ * \param image The image.
+ */
+void CSimpleNode::ImagePrint(CImageWriter & image) const {
+    ImagePrintNode(image, NEXT_IS_SIMPLE, CText());
+}
 
 /********************* VIRTUAL PREPARE SEARCHING *******************************/
 
-/*! Inserts the text node's title to the search binary tree.
- * \param tree Pointer to the tree.
+/*! Inserts the text node to the titles index.
+ * \param index Pointer to the index.
  */
-void CTextNode::PrepareSearching(CSearchTree* tree) {
-    tree->Insert(m_title, this);
+void CTextNode::PrepareSearching(CTitleIndex * index) {
+    index->Insert(m_name, this);
 }
 
-/*! Inserts the simple node's title to the search binary tree.
- * \param tree Pointer to the tree.
+/*! Inserts the simple node to the titles index.
+ * \param index Pointer to the index.
  */
-void CSimpleNode::PrepareSearching(CSearchTree* tree) {
-    tree->Insert(m_title, this);
+void CSimpleNode::PrepareSearching(CTitleIndex * index) {
+    index->Insert(m_name, this);
 }
 
-/*! Inserts the parent node's title to the search binary tree (and childs recursively).
- * \param tree Pointer to the tree.
+/*! Inserts the parent node to the titles index (and childs recursively).
+ * \param index Pointer to the index.
  */
-void CParentNode::PrepareSearching(CSearchTree* tree) {
-    tree->Insert(m_title, this);
+void CParentNode::PrepareSearching(CTitleIndex * index) {
+    Load();
+    index->Insert(m_name, this);
     for (int i = 0; i < m_cntChilds; i++) {
-        m_childs[i]->PrepareSearching(tree);
+        m_childs[i]->PrepareSearching(index);
     }
 }
 
 
 /********************* VIRTUAL TYPE GETTERS *******************************/
 
+/*! Gets the type of the text node shown with its row.
+ */
+char CTextNode::GetType() const {
+    return 'T';
+}
+
+/*! Gets the type of the comment node shown with its row.
+ */
+char CCommentNode::GetType() const {
+    return 'C';
+}
+
+/*! Gets the type of the parent node shown with its row.
+ */
+char CParentNode::GetType() const {
+    return 'P';
+}
+
+/*! Gets the type of the simple node shown with its row.
+ */
+char CSimpleNode::GetType() const {
+    return 'S';
+}
+
 /*! Finds out, if the text node can have childs.
  */
 bool CTextNode::HasChilds() const {
@@ -577,21 +1063,31 @@ void CParentNode::ExpandAll() {
 /*! Creates new comment node.
  * \param comment Comment text.
  */
-CCommentNode::CCommentNode(string& comment) : CNode() {
-    m_comment = comment;
+CCommentNode::CCommentNode(const CText & comment) : CNode() {
+    m_comment = CArena::GetOwner(this)->Store(comment);
+}
+
+/*! Gives the comment text back to the arena.
+ */
+CCommentNode::~CCommentNode() {
+    CArena::GetOwner(this)->Release(m_comment);
 }
 
 /*! Gets the comment text.
  */
 string CCommentNode::GetComment() const {
-    return m_comment;
+    return m_comment.GetString();
 }
 
 /*! Sets the comment text.
  * \param comment Comment text.
  */
 void CCommentNode::SetComment(string& comment) {
-    m_comment = comment;
+    CArena * arena = CArena::GetOwner(this);
+    arena->Release(m_comment);
+    m_comment = arena->Store(comment);
+    InvalidateRow();
+    Changed();
 }
 
 
@@ -600,10 +1096,15 @@ void CCommentNode::SetComment(string& comment) {
 /*! Creates new parent node and allocates childs.
  * \param title Element title.
  */
-CParentNode::CParentNode(string & title) : CNode(title) {
-    m_cntChilds = 0;
-    m_childs = new CNode * [DEFAULT_CHILDS_SIZE];
-    m_sizeChilds = DEFAULT_CHILDS_SIZE;
+CParentNode::CParentNode(const CText & title) : CNode(title) {
+    InitChilds();
+}
+
+/*! Creates new parent node with checked title and allocates childs.
+ * \param name Atom of the element title.
+ */
+CParentNode::CParentNode(int name) : CNode(name) {
+    InitChilds();
 }
 
 /*! Deallocates childs.
@@ -611,21 +1112,38 @@ CParentNode::CParentNode(string & title) : CNode(title) {
 CParentNode::~CParentNode() {
     for(int i = 0; i < m_cntChilds; i++)
         delete m_childs[i];
-    if (m_cntChilds)
-        delete [] m_childs;
+    CArena::GetOwner(this)->Free(m_childs, m_sizeChilds * sizeof (CNode *));
+    CArena::GetOwner(this)->Free(m_childRows, (m_sizeChilds + 1) * sizeof (int));
+}
+
+/*! Allocates childs of new node.
+ */
+void CParentNode::InitChilds() {
+    m_cntChilds = 0;
+    m_childs = (CNode **) CArena::GetOwner(this)->Alloc(DEFAULT_CHILDS_SIZE * sizeof (CNode *));
+    m_childRows = (int *) CArena::GetOwner(this)->Alloc((DEFAULT_CHILDS_SIZE + 1) * sizeof (int));
+    m_sizeChilds = DEFAULT_CHILDS_SIZE;
+
+    m_isLazy = false;
+    m_lazyPath = NULL;
 }
 
 /*! Childs memory management.
  */
 void CParentNode::ReallocChilds() {
     if (m_cntChilds >= m_sizeChilds - 1) {
-        CNode ** tmp = new CNode * [m_sizeChilds * REALLOC_CONSTANT];
+        CArena * arena = CArena::GetOwner(this);
+        CNode ** tmp = (CNode **) arena->Alloc(m_sizeChilds * REALLOC_CONSTANT * sizeof (CNode *));
+        int * rows = (int *) arena->Alloc((m_sizeChilds * REALLOC_CONSTANT + 1) * sizeof (int));
         for (int i = 0; i < m_cntChilds; i++) {
             tmp[i] = m_childs[i];
+            rows[i + 1] = m_childRows[i + 1];
         }
 
-        delete [] m_childs;
+        arena->Free(m_childs, m_sizeChilds * sizeof (CNode *));
+        arena->Free(m_childRows, (m_sizeChilds + 1) * sizeof (int));
         m_childs = tmp;
+        m_childRows = rows;
         m_sizeChilds *= REALLOC_CONSTANT;
     }
 }
@@ -634,11 +1152,95 @@ void CParentNode::ReallocChilds() {
  * \param node Pointer to a new node.
  */
 void CParentNode::InsertNode(CNode* node) {
+    Load(); //new child goes after the unparsed ones
+    AppendChild(node);
+    MarkDirty();
+}
+
+/*! Adds the node after the childs, this node is not marked as changed (the builder reads the childs from the file).
+ * \param node Pointer to the node.
+ */
+void CParentNode::AppendChild(CNode * node) {
     ReallocChilds();
     m_childs[m_cntChilds] = node;
     node->SetID(m_cntChilds);
     node->SetParent(this);
     m_cntChilds++;
+
+    //the new item of the Fenwick tree sums the rows of the child and of the childs it covers
+    int last = m_cntChilds;
+    m_childRows[last] = node->GetRowCount() + CountRowsBefore(last - 1) - CountRowsBefore(last - (last & -last));
+
+    //childs of indexed node are indexed too
+    if (m_indexPos >= 0)
+        node->PrepareSearching(CArena::GetOwner(this)->GetIndex());
+}
+
+/*! Moves all childs of other node to the end of my childs, they stay as they are in the file.
+ * \param node Pointer to the node, which loses its childs.
+ */
+void CParentNode::TakeChilds(CParentNode * node) {
+    for (int i = 0; i < node->m_cntChilds; i++) {
+        AppendChild(node->m_childs[i]);
+    }
+    node->m_cntChilds = 0;
+}
+
+/*! Childs are not parsed now, they are parsed when the node is expanded, or searched.
+ * \param content The data of the childs (between start tag and end tag of this node).
+ * \param filePath File name (for exceptions), it must exist as long as this node.
+ */
+void CParentNode::SetLazy(const CText & content, const string * filePath) {
+    m_isLazy = true;
+    m_lazy = content;
+    m_lazyPath = filePath;
+    Collapse();
+}
+
+/*! Parses the childs, if they are not parsed yet.
+ */
+void CParentNode::Load() {
+    if (!m_isLazy)
+        return;
+    m_isLazy = false;
+
+    CArena * arena = CArena::GetOwner(this);
+    CTreeBuilder builder(this, arena);
+    try {
+        //childs in the image are built without parsing, their childs are built, when they are expanded
+        CImageReader * image = arena->GetImage();
+        builder.SetLazy(m_lazyPath);
+        if (image == NULL || !image->ReadChilds(m_source, &builder)) {
+            //the end tag follows the content, so its < is given to the reader too
+            CXMLReader reader(m_lazy.GetData(), m_lazy.GetLength() + 1, *m_lazyPath, &builder);
+            reader.ReadRange(0, m_lazy.GetLength());
+        }
+    } catch (const CException & e) {
+        //the node stays unparsed
+        for (int i = 0; i < m_cntChilds; i++)
+            delete m_childs[i];
+        m_cntChilds = 0;
+        m_isLazy = true;
+        throw;
+    }
+    m_lazy = CText();
+}
+
+/*! Parses unparsed childs of the node and of all its descendants, so the whole subtree can be printed
+ * or walked without parsing.
+ */
+void CParentNode::LoadAll() {
+    Load();
+    for (int i = 0; i < m_cntChilds; i++) {
+        m_childs[i]->LoadAll();
+    }
+}
+
+/*! Expands the node, its childs are parsed first.
+ */
+void CParentNode::Expand() {
+    Load();
+    CNode::Expand();
 }
 
 /*! Deletes a child.
@@ -656,6 +1258,8 @@ void CParentNode::DeleteNode(int id) {
     }
 
     m_cntChilds--;
+    SumChildRows();
+    MarkDirty();
 }
 
 
@@ -664,7 +1268,13 @@ void CParentNode::DeleteNode(int id) {
 /*! Creates new simple node.
  * \param title Element title.
  */
-CSimpleNode::CSimpleNode(string& title) : CNode(title) {
+CSimpleNode::CSimpleNode(const CText & title) : CNode(title) {
+}
+
+/*! Creates new simple node with checked title.
+ * \param name Atom of the element title.
+ */
+CSimpleNode::CSimpleNode(int name) : CNode(name) {
 }
 
 /*************************** TEXT NODE METHODS *************************/
@@ -673,19 +1283,44 @@ CSimpleNode::CSimpleNode(string& title) : CNode(title) {
  * \param title Element title.
  * \param value Value of the text node. 
  */
-CTextNode::CTextNode(string & title, string & value) : CNode(title) {
-    m_value = value;
+CTextNode::CTextNode(const CText & title, const CText & value) : CNode(title) {
+    m_value = CArena::GetOwner(this)->Store(value);
+}
+
+/*! Creates new text node with checked title.
+ * \param name Atom of the element title.
+ * \param value Value of the text node.
+ */
+CTextNode::CTextNode(int name, const CText & value) : CNode(name) {
+    m_value = CArena::GetOwner(this)->Store(value);
+}
+
+/*! Gives the value back to the arena.
+ */
+CTextNode::~CTextNode() {
+    CArena::GetOwner(this)->Release(m_value);
 }
 
 /*! Sets the text node value.
  * \param value Value of the text node. 
  */
 void CTextNode::SetValue(string& value) {
-    m_value = value;
+    SetValue(CText(value));
+}
+
+/*! Sets the text node value, texts pointing to the data are not copied.
+ * \param value Value of the text node (it may point to the data).
+ */
+void CTextNode::SetValue(const CText & value) {
+    CArena * arena = CArena::GetOwner(this);
+    arena->Release(m_value);
+    m_value = arena->Store(value);
+    InvalidateRow();
+    Changed();
 }
 
 /*! Gets the text node value. 
  */
 string CTextNode::GetValue() const {
-    return m_value;
+    return m_value.GetString();
 }
\ No newline at end of file
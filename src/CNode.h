@@ -5,9 +5,13 @@
 #include <iostream>
 #include <string>
 
+#include "CArena.h"
 #include "CAttribute.h"
-#include "CGUI.h"
-#include "CSearchTree.h"
+#include "CText.h"
+#include "CRowList.h"
+#include "CTitleIndex.h"
+#include "CXMLWriter.h"
+#include "CImageWriter.h"
 
 using namespace std;
 
@@ -17,53 +21,93 @@ class CParentNode;
 class CNode {
 public:
     CNode();
-    CNode(string & title);
-    ~CNode();
+    CNode(const CText & title);
+    CNode(int name);
+    virtual ~CNode();
+
+    //nodes live in the arena of the document
+    static void * operator new(size_t size, CArena * arena);
+    static void operator delete(void * p, CArena * arena);
+    static void operator delete(void * p);
 
     //getters
     string GetTitle() const;
+    const CText & GetTitleText() const;
+    int GetAtom() const;
     int GetID() const;
     CNode * GetParent() const;
+    int GetIndexPosition() const;
+    bool IsCollapsed() const;
+    int GetRowCount() const;
+    bool IsDirty() const;
 
     //setters
     void SetTitle(string & title);
     void SetID(int id);
     void SetParent(CNode * parent);
+    void SetIndexPosition(int position);
 
     //collapse / expand tools
     void ExpandUp();
     void Collapse();
-    void Expand();
+    virtual void Expand();
 
     //public attribute tools
     void InsertAttribute(CAttribute * attribute);
     void RemoveAttribute(string & name);
-    void GetAttributes(CGUI * interface);
+    int GetAttributeCount() const;
+    const CAttribute * GetAttribute(int id) const;
+
+    //source in the file
+    const CText & GetSource() const;
+    void StartSource(const CText & tag);
+    void EndSource(const CText & tag);
+
+    //visible rows tools
+    CText GetRow(int depth);
+    void ChangeRowCount(int count);
+    void SetRowCount(int count);
+    virtual int CountRowsBefore(int id) const;
 
     //virtual Print tools
-    virtual void Print(CGUI * interface, int depth) = 0;
-    virtual void XMLPrint(ofstream & file, int depth) = 0;
-    virtual void PrepareSearching(CSearchTree * tree) = 0;
+    virtual void ListRows(CRowList * rows, int depth);
+    virtual void Print(string & output, int depth) const = 0;
+    virtual void XMLPrint(CXMLWriter & writer, int depth) = 0;
+    void XMLPrintIndent(CXMLWriter & writer, int depth) const;
+    virtual void ImagePrint(CImageWriter & image) const = 0;
+    virtual void PrepareSearching(CTitleIndex * index) = 0;
 
     //virtual type getters
+    virtual char GetType() const = 0;
     virtual bool HasChilds() const = 0;
     virtual bool HasAttributes() const = 0;
 
     //virtual tools for child nodes
     virtual void InsertNode(CNode * node) = 0;
     virtual void DeleteNode(int id) = 0;
+    virtual CNode * FindChild(int name, int number);
+    virtual int GetChildCount();
+    virtual CNode * GetChild(int id);
+    virtual void LoadAll();
 
     //virtual collapse / expand "recursive" tools
     virtual void CollapseAll() = 0;
     virtual void ExpandAll() = 0;
 protected:
-    bool AttributeExists(string & name) const;
+    void Init(int name);
+    bool AttributeExists(int name) const;
     void ReallocAttributes();
+    void InvalidateRow();
+    void Changed();
+    void MarkDirty();
+    bool XMLPrintSource(CXMLWriter & writer) const;
+    void XMLPrintStartTag(CXMLWriter & writer) const;
+    int ImagePrintNode(CImageWriter & image, int kind, const CText & value) const;
 
     //node information
-    ///! Title of the element
-    string m_title;
-    ///! Array of element attributes
+    ///! Atom of the title of the element
+    int m_name;
+    ///! Array of element attributes, NULL until the first one is inserted
     CAttribute ** m_attributes;
     ///! Count of element attributes
     int m_cntAtt;
@@ -75,12 +119,24 @@ protected:
     CNode * m_parent;
     ///! Child id of the node
     int m_id;
-
-    //output strings
-    ///! Pointer to tree output string
-    string * m_output;
-    ///! Pointer to XML output string
-    string * m_xmloutput;
+    ///! Position in the titles index, -1 if the node is not indexed
+    int m_indexPos;
+    ///! Count of visible rows of the node and its descendants (it is right only for visible nodes)
+    int m_cntRows;
+    ///! Cached text of the row (in the arena), NULL if it has to be made again
+    char * m_row;
+    ///! Length of the cached text of the row
+    unsigned int m_rowLength;
+    ///! Depth, for which the text of the row was made
+    int m_rowDepth;
+    ///! The node as it is in the file (from its start tag to its end tag), empty for new nodes
+    CText m_source;
+    ///! Length of the start tag in the source
+    unsigned int m_tagLength;
+    ///! Are the tags or the text of the node different from the source?
+    bool m_isChanged;
+    ///! Is the node or any of its descendants different from the source?
+    bool m_isDirty;
 };
 
 /************************** TEXT NODES **************************/
@@ -88,15 +144,19 @@ protected:
 ///! Class, which represents text XML elements - like <title>text</title>
 class CTextNode : public CNode {
 public:
-    CTextNode(string & title, string & value);
+    CTextNode(const CText & title, const CText & value);
+    CTextNode(int name, const CText & value);
+    ~CTextNode();
 
     string GetValue() const;
     void SetValue(string & value);
+    void SetValue(const CText & value);
 
     //virtual Print tools
-    virtual void Print(CGUI * interface, int depth);
-    virtual void XMLPrint(ofstream & file, int depth);
-    virtual void PrepareSearching(CSearchTree * tree);
+    virtual void Print(string & output, int depth) const;
+    virtual void XMLPrint(CXMLWriter & writer, int depth);
+    virtual void ImagePrint(CImageWriter & image) const;
+    virtual void PrepareSearching(CTitleIndex * index);
 
     //virtual child nodes tool (not used here)
 
@@ -107,6 +167,7 @@ public:
     };
 
     //virtual type getters
+    virtual char GetType() const;
     virtual bool HasChilds() const;
     virtual bool HasAttributes() const;
 
@@ -115,7 +176,7 @@ public:
     virtual void ExpandAll();
 protected:
     ///! Text value of the text node
-    string m_value;
+    CText m_value;
 };
 
 /************************** COMMENT NODES **************************/
@@ -123,16 +184,18 @@ protected:
 ///! Class, which represents comment XML elements - like <!-- Comment -->
 class CCommentNode : public CNode {
 public:
-    CCommentNode(string & comment);
+    CCommentNode(const CText & comment);
+    ~CCommentNode();
 
     string GetComment() const;
     void SetComment(string & comment);
 
     //virtual Print tools
-    virtual void Print(CGUI * interface, int depth);
-    virtual void XMLPrint(ofstream & file, int depth);
+    virtual void Print(string & output, int depth) const;
+    virtual void XMLPrint(CXMLWriter & writer, int depth);
+    virtual void ImagePrint(CImageWriter & image) const;
 
-    virtual void PrepareSearching(CSearchTree * tree) {
+    virtual void PrepareSearching(CTitleIndex * index) {
     }; //comment node is not filtered
 
     //virtual child nodes tool (not used here)
@@ -144,6 +207,7 @@ public:
     };
 
     //virtual type getters
+    virtual char GetType() const;
     virtual bool HasChilds() const;
     virtual bool HasAttributes() const;
 
@@ -152,7 +216,7 @@ public:
     virtual void ExpandAll();
 protected:
     ///! Comment text
-    string m_comment;
+    CText m_comment;
 };
 
 /************************* PARENT NODE ***************************/
@@ -160,19 +224,39 @@ protected:
 ///! Class, which represents parent XML elements - like <node>...more nodes...</node>
 class CParentNode : public CNode {
 public:
-    CParentNode(string & title);
+    CParentNode(const CText & title);
+    CParentNode(int name);
     ~CParentNode();
 
+    //visible rows tools
+    virtual int CountRowsBefore(int id) const;
+    void ChangeChildRows(int id, int count);
+    void ListChildRows(CRowList * rows, int depth, int from, int to);
+
     //virtual Print tools
-    virtual void Print(CGUI * interface, int depth);
-    virtual void XMLPrint(ofstream & file, int depth);
-    virtual void PrepareSearching(CSearchTree * tree);
+    virtual void ListRows(CRowList * rows, int depth);
+    virtual void Print(string & output, int depth) const;
+    virtual void XMLPrint(CXMLWriter & writer, int depth);
+    virtual void ImagePrint(CImageWriter & image) const;
+    virtual void PrepareSearching(CTitleIndex * index);
 
     //virtual child nodes tools
     virtual void InsertNode(CNode * node);
     virtual void DeleteNode(int id);
+    virtual CNode * FindChild(int name, int number);
+    virtual int GetChildCount();
+    virtual CNode * GetChild(int id);
+    void AppendChild(CNode * node);
+    void TakeChilds(CParentNode * node);
+
+    //lazy parsing of the childs
+    void SetLazy(const CText & content, const string * filePath);
+    void Load();
+    virtual void LoadAll();
+    virtual void Expand();
 
     //virtual type getters
+    virtual char GetType() const;
     virtual bool HasChilds() const;
     virtual bool HasAttributes() const;
 
@@ -180,7 +264,27 @@ public:
     virtual void CollapseAll();
     virtual void ExpandAll();
 protected:
+    void InitChilds();
     void ReallocChilds();
+    void SumChildRows();
+    void XMLPrintChilds(CXMLWriter & writer, int depth, int from, int to);
+    void XMLPrintParallel(CXMLWriter & writer, int depth, int threads);
+
+    static void * PrintRangeThread(void * job);
+
+    ///! Structure, which specifies part of the childs printed by one thread.
+    struct TPrintJob {
+        ///! Parent of the printed childs
+        CParentNode * m_parent;
+        ///! Depth of the childs
+        int m_depth;
+        ///! Index of the first child
+        int m_from;
+        ///! Index after the last child
+        int m_to;
+        ///! Snapshot writer of the thread
+        CXMLWriter * m_writer;
+    };
 
     ///! Array of childs
     CNode ** m_childs;
@@ -188,6 +292,14 @@ protected:
     int m_cntChilds;
     ///! Max count of childs
     int m_sizeChilds;
+    ///! Fenwick tree of the counts of visible rows of the childs, item i sums the childs from i - (i & -i) + 1 to i (from 1)
+    int * m_childRows;
+    ///! Are the childs still unparsed?
+    bool m_isLazy;
+    ///! Unparsed childs (they point to the data)
+    CText m_lazy;
+    ///! File name of unparsed childs (for exceptions)
+    const string * m_lazyPath;
 };
 
 /************************* SIMPLE NODE ***************************/
@@ -195,13 +307,14 @@ protected:
 ///! Class, which represents simple XML elements - like <title blabla />
 class CSimpleNode : public CNode {
 public:
-    CSimpleNode(string & title);
-    ~CSimpleNode();
+    CSimpleNode(const CText & title);
+    CSimpleNode(int name);
 
     //virtual Print tools
-    virtual void Print(CGUI * interface, int depth);
-    virtual void XMLPrint(ofstream & file, int depth);
-    virtual void PrepareSearching(CSearchTree * tree);
+    virtual void Print(string & output, int depth) const;
+    virtual void XMLPrint(CXMLWriter & writer, int depth);
+    virtual void ImagePrint(CImageWriter & image) const;
+    virtual void PrepareSearching(CTitleIndex * index);
 
     //virtual child nodes tools (not used here)
     virtual void InsertNode(CNode * node) {
@@ -210,6 +323,7 @@ public:
     };
 
     //virtual type getters
+    virtual char GetType() const;
     virtual bool HasChilds() const;
     virtual bool HasAttributes() const;
     
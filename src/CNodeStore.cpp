@@ -0,0 +1,683 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <pthread.h>
+
+#include "CNodeStore.h"
+#include "CXMLHandler.h"
+#include "CScanner.h"
+#include "functions.h"
+
+///! Default count of nodes
+#define DEFAULT_NODES_SIZE 256
+///! Default count of attributes
+#define DEFAULT_ATTRIBUTES_SIZE 64
+///! Default size of the heap
+#define DEFAULT_HEAP_SIZE 256
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+///! Bit of text references, which point to the heap
+#define HEAP_REFERENCE 0x80000000U
+///! Max offset of a reference from the base of its block
+#define MAX_REFERENCE 0x7fffffffU
+///! Max length of a text or a node in the source
+#define MAX_LENGTH 0xffffffffU
+///! Position of the nodes, which are not in the source
+#define NO_SOURCE 0xffffffffU
+///! Count of nodes in a block with the same bases is 2^BLOCK_SHIFT
+#define BLOCK_SHIFT 8
+
+using namespace std;
+
+/********************* TOOLS *******************************/
+
+/*! Changes the size of an array of plain items.
+ * \param array The array.
+ * \param count New count of items.
+ */
+template <class T>
+static void ReallocArray(T * & array, size_t count) {
+    T * tmp = (T *) realloc(array, count * sizeof (T));
+    if (tmp == NULL)
+        throw bad_alloc();
+    array = tmp;
+}
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty store.
+ * \param source Pointer to the source data, texts pointing to it are not copied.
+ * \param size Size of the source data.
+ */
+CNodeStore::CNodeStore(const char * source, size_t size) {
+    m_source = source;
+    m_sourceSize = size;
+    m_lastSource = 0;
+    m_rootLength = 0;
+
+    m_kinds = NULL;
+    m_names = m_parents = m_firstChilds = m_nextSiblings = m_firstAttributes = NULL;
+    m_values = m_valueLengths = m_sources = m_sourceLengths = NULL;
+    m_sourceBases = m_heapBases = NULL;
+    m_cnt = m_size = 0;
+
+    m_attributeNames = NULL;
+    m_attributeValues = NULL;
+    m_attributeLengths = NULL;
+    m_cntAtt = m_sizeAtt = 0;
+
+    m_heap = NULL;
+    m_heapUsed = m_heapSize = 0;
+}
+
+/*! Deallocates the store.
+ */
+CNodeStore::~CNodeStore() {
+    free(m_kinds);
+    free(m_names);
+    free(m_parents);
+    free(m_firstChilds);
+    free(m_nextSiblings);
+    free(m_values);
+    free(m_valueLengths);
+    free(m_firstAttributes);
+    free(m_sources);
+    free(m_sourceLengths);
+    free(m_sourceBases);
+    free(m_heapBases);
+    free(m_attributeNames);
+    free(m_attributeValues);
+    free(m_attributeLengths);
+    free(m_heap);
+}
+
+/********************* BUILDING *******************************/
+
+/*! Adds new node.
+ * \param kind Kind of the node.
+ * \param title Title of the node (not used by comments).
+ * \param parent Parent of the node, -1 for the root.
+ * \param previous Previous sibling of the node, -1 if the node is the first child.
+ * \return Index of the node.
+ */
+int CNodeStore::AddNode(int kind, const CText & title, int parent, int previous) {
+    ReallocNodes();
+    int node = m_cnt++;
+    //texts of the block are after everything stored before it
+    if ((node & ((1 << BLOCK_SHIFT) - 1)) == 0) {
+        m_sourceBases[node >> BLOCK_SHIFT] = m_lastSource;
+        m_heapBases[node >> BLOCK_SHIFT] = m_heapUsed;
+    }
+
+    m_kinds[node] = kind;
+    m_names[node] = kind == NEXT_IS_COMMENT ? -1 : GetAtom(title);
+    m_parents[node] = parent;
+    m_firstChilds[node] = -1;
+    m_nextSiblings[node] = -1;
+    m_values[node] = 0;
+    m_valueLengths[node] = 0;
+    m_firstAttributes[node] = m_cntAtt;
+    m_sources[node] = NO_SOURCE;
+    m_sourceLengths[node] = 0;
+
+    if (previous >= 0)
+        m_nextSiblings[previous] = node;
+    else if (parent >= 0)
+        m_firstChilds[parent] = node;
+    return node;
+}
+
+/*! Adds an attribute to the node, the node has to be the last one (attributes of nodes are in their order).
+ * \param node Index of the node.
+ * \param name Name of the attribute.
+ * \param value Value of the attribute.
+ */
+void CNodeStore::AddAttribute(int node, const CText & name, const CText & value) {
+    ReallocAttributes();
+    m_attributeNames[m_cntAtt] = GetAtom(name);
+    m_attributeValues[m_cntAtt] = StoreText(node, value);
+    m_attributeLengths[m_cntAtt] = value.GetLength();
+    m_cntAtt++;
+}
+
+/*! Sets the value of text node or comment.
+ * \param node Index of the node.
+ * \param value The value.
+ */
+void CNodeStore::SetValue(int node, const CText & value) {
+    m_values[node] = StoreText(node, value);
+    m_valueLengths[node] = value.GetLength();
+}
+
+/*! Remembers the start tag of the node, tags outside of the source are not remembered.
+ * \param node Index of the node.
+ * \param tag The start tag (the whole comment).
+ */
+void CNodeStore::StartSource(int node, const CText & tag) {
+    if (m_source == NULL || tag.GetData() < m_source || tag.GetData() >= m_source + m_sourceSize)
+        return;
+    size_t position = tag.GetData() - m_source;
+    size_t base = m_sourceBases[node >> BLOCK_SHIFT];
+    if (position < base || position - base >= NO_SOURCE)
+        return;
+    m_sources[node] = position - base;
+    m_lastSource = position;
+}
+
+/*! Ends the node in the source, the node is printed from the source then.
+ * \param node Index of the node.
+ * \param tag The end tag (the same tag as the start one for simple nodes and comments).
+ */
+void CNodeStore::EndSource(int node, const CText & tag) {
+    if (m_source == NULL || tag.GetData() < m_source || tag.GetData() >= m_source + m_sourceSize
+            || m_sources[node] == NO_SOURCE)
+        return;
+    size_t length = tag.GetData() + tag.GetLength() - (m_source + m_sourceBases[node >> BLOCK_SHIFT] + m_sources[node]);
+    //too long nodes are printed by their childs, only the root is copied
+    if (node == 0)
+        m_rootLength = length;
+    m_sourceLengths[node] = length <= MAX_LENGTH ? length : 0;
+}
+
+/*! Saves the version information.
+ * \param versionData The whole version tag.
+ */
+void CNodeStore::SetVersionData(const string & versionData) {
+    m_versionData = versionData;
+}
+
+/*! Frees unused memory of the arrays, when the store is complete.
+ */
+void CNodeStore::Shrink() {
+    if (m_cnt > 0 && m_cnt < m_size) {
+        ReallocArray(m_kinds, m_cnt);
+        ReallocArray(m_names, m_cnt);
+        ReallocArray(m_parents, m_cnt);
+        ReallocArray(m_firstChilds, m_cnt);
+        ReallocArray(m_nextSiblings, m_cnt);
+        ReallocArray(m_values, m_cnt);
+        ReallocArray(m_valueLengths, m_cnt);
+        ReallocArray(m_firstAttributes, m_cnt);
+        ReallocArray(m_sources, m_cnt);
+        ReallocArray(m_sourceLengths, m_cnt);
+        ReallocArray(m_sourceBases, ((m_cnt - 1) >> BLOCK_SHIFT) + 1);
+        ReallocArray(m_heapBases, ((m_cnt - 1) >> BLOCK_SHIFT) + 1);
+        m_size = m_cnt;
+    }
+    if (m_cntAtt > 0 && m_cntAtt < m_sizeAtt) {
+        ReallocArray(m_attributeNames, m_cntAtt);
+        ReallocArray(m_attributeValues, m_cntAtt);
+        ReallocArray(m_attributeLengths, m_cntAtt);
+        m_sizeAtt = m_cntAtt;
+    }
+    if (m_heapUsed > 0 && m_heapUsed < m_heapSize) {
+        ReallocArray(m_heap, m_heapUsed);
+        m_heapSize = m_heapUsed;
+    }
+}
+
+/********************* GETTERS *******************************/
+
+/*! Gets the count of nodes.
+ */
+int CNodeStore::GetCount() const {
+    return m_cnt;
+}
+
+/*! Gets the kind of the node.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetKind(int node) const {
+    return m_kinds[node];
+}
+
+/*! Gets the atom of the node title.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetName(int node) const {
+    return m_names[node];
+}
+
+/*! Gets the title of the node.
+ * \param node Index of the node.
+ */
+CText CNodeStore::GetTitle(int node) const {
+    if (m_names[node] < 0)
+        return CText();
+    const CText & title = m_atoms.Get(m_names[node]);
+    return CText(title.GetData(), title.GetLength());
+}
+
+/*! Gets the value of text node or comment.
+ * \param node Index of the node.
+ */
+CText CNodeStore::GetValue(int node) const {
+    return GetText(node, m_values[node], m_valueLengths[node]);
+}
+
+/*! Gets the node as it is in the source, empty if it is not there.
+ * \param node Index of the node.
+ */
+CText CNodeStore::GetSource(int node) const {
+    size_t length = GetSourceLength(node);
+    if (length == 0)
+        return CText();
+    return CText(m_source + m_sourceBases[node >> BLOCK_SHIFT] + m_sources[node], length);
+}
+
+/*! Gets the parent of the node.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetParent(int node) const {
+    return m_parents[node];
+}
+
+/*! Gets the first child of the node.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetFirstChild(int node) const {
+    return m_firstChilds[node];
+}
+
+/*! Gets the next sibling of the node.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetNextSibling(int node) const {
+    return m_nextSiblings[node];
+}
+
+/*! Gets the count of attributes of the node.
+ * \param node Index of the node.
+ */
+int CNodeStore::GetAttributeCount(int node) const {
+    return (node + 1 < m_cnt ? m_firstAttributes[node + 1] : m_cntAtt) - m_firstAttributes[node];
+}
+
+/*! Gets the name of an attribute.
+ * \param node Index of the node.
+ * \param i Index of the attribute of the node.
+ */
+CText CNodeStore::GetAttributeName(int node, int i) const {
+    const CText & name = m_atoms.Get(m_attributeNames[m_firstAttributes[node] + i]);
+    return CText(name.GetData(), name.GetLength());
+}
+
+/*! Gets the value of an attribute.
+ * \param node Index of the node.
+ * \param i Index of the attribute of the node.
+ */
+CText CNodeStore::GetAttributeValue(int node, int i) const {
+    int att = m_firstAttributes[node] + i;
+    return GetText(node, m_attributeValues[att], m_attributeLengths[att]);
+}
+
+/*! Gets the names of elements and attributes.
+ */
+const CAtomTable & CNodeStore::GetAtoms() const {
+    return m_atoms;
+}
+
+/********************* TRAVERSALS *******************************/
+
+/*! Prints the whole document to the writer in its format like CXML::Print. Source format copies the root
+ * and everything around it from the source, other formats print every node. Childs of a root with many
+ * childs are printed by more threads.
+ * \param writer The writer.
+ */
+void CNodeStore::Print(CXMLWriter & writer) const {
+    if (writer.GetFormat() == WRITER_SOURCE && m_cnt > 0 && m_rootLength) {
+        const char * start = m_source + m_sourceBases[0] + m_sources[0];
+        const char * end = start + m_rootLength;
+        writer.WriteBlock(CText(m_source, start - m_source));
+        writer.WriteBlock(CText(start, end - start));
+        writer.WriteBlock(CText(end, m_source + m_sourceSize - end));
+        return;
+    }
+
+    if (m_versionData.length() > 0) {
+        writer.Write(m_versionData.data(), m_versionData.length());
+        if (writer.GetFormat() != WRITER_MINIFY)
+            writer.WriteLine();
+    }
+    if (m_cnt == 0)
+        return;
+    int childs = 0;
+    if (m_kinds[0] == NEXT_IS_PARENTNODE) {
+        for (int node = m_firstChilds[0]; node >= 0; node = m_nextSiblings[node])
+            childs++;
+    }
+
+    int threads = CXMLWriter::CountPrintThreads(childs);
+    if (threads > 1)
+        XMLPrintParallel(writer, threads);
+    else
+        XMLPrintRange(writer, 0, -1, 0, false);
+    writer.WriteLine();
+}
+
+/*! Prints the node with its subtree like CNode::XMLPrint at depth 0. Source format copies it from the source.
+ * \param node Index of the node.
+ * \param writer The writer.
+ */
+void CNodeStore::XMLPrint(int node, CXMLWriter & writer) const {
+    XMLPrintRange(writer, node, m_nextSiblings[node], 0, false);
+}
+
+/*! Finds the child with the title like CParentNode::FindChild.
+ * \param node Index of the parent.
+ * \param name Atom of the title.
+ * \param number Which of the childs with the title is wanted (from 1).
+ * \return Index of the child, -1 if there is not such child.
+ */
+int CNodeStore::FindChild(int node, int name, int number) const {
+    for (int child = m_firstChilds[node]; child >= 0; child = m_nextSiblings[child]) {
+        if (m_names[child] == name && --number == 0)
+            return child;
+    }
+    return -1;
+}
+
+/*! Finds the node by its path like /catalog/cd[2]/title (like CXML::FindPath).
+ * \param path The path from the root.
+ * \return Index of the node, -1 if there is not such node.
+ */
+int CNodeStore::FindPath(const string & path) const {
+    int node = -1;
+    size_t pos = 0;
+    string title;
+    int number;
+    while (pos < path.length()) {
+        if (!ReadPathStep(path, pos, title, number))
+            return -1;
+        int name = m_atoms.Find(title);
+        if (name < 0)
+            return -1;
+
+        if (node < 0) {
+            if (m_cnt == 0 || m_names[0] != name || number != 1)
+                return -1;
+            node = 0;
+        } else if ((node = FindChild(node, name, number)) < 0)
+            return -1;
+    }
+    return node;
+}
+
+/*! Finds next node with given title, the flat array of titles is searched.
+ * \param name Atom of the title.
+ * \param from Index of the first searched node.
+ * \return Index of the node, -1 if there is none.
+ */
+int CNodeStore::FindNext(int name, int from) const {
+    for (int i = from; i < m_cnt; i++) {
+        if (m_names[i] == name)
+            return i;
+    }
+    return -1;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Prints the siblings with their subtrees to the XML file, the walk does not go above them.
+ * The tree is walked by the links, so the depth of the document is not limited by the stack.
+ * \param writer Writer of the file.
+ * \param first The first printed sibling.
+ * \param last Sibling after the last printed one (-1 prints all following siblings).
+ * \param depth Depth of the siblings.
+ * \param isIndented Are the white spaces printed in front of the first sibling?
+ */
+void CNodeStore::XMLPrintRange(CXMLWriter & writer, int first, int last, int depth, bool isIndented) const {
+    int node = first;
+    int top = depth;
+
+    while (node >= 0 && node != last) {
+        if (isIndented)
+            WriteIndent(node, writer, depth);
+        isIndented = true;
+
+        //node in the source is copied with its subtree
+        bool isCopied = writer.GetFormat() == WRITER_SOURCE && GetSourceLength(node);
+        if (isCopied)
+            writer.WriteBlock(GetSource(node));
+        else if (m_kinds[node] == NEXT_IS_COMMENT) {
+            writer.Write("<!-- ");
+            writer.Write(GetValue(node));
+            writer.Write("-->");
+        } else {
+            WriteStartTag(node, writer);
+            if (m_kinds[node] == NEXT_IS_TEXTNODE) {
+                writer.Write(">");
+                writer.Write(GetValue(node));
+                writer.Write("</");
+                writer.Write(GetTitle(node));
+                writer.Write(">");
+            } else if (m_kinds[node] == NEXT_IS_SIMPLE) {
+                writer.Write(" />");
+            } else {
+                writer.Write(">");
+            }
+        }
+
+        //parent goes down to its childs
+        bool isParent = !isCopied && m_kinds[node] == NEXT_IS_PARENTNODE;
+        if (isParent && m_firstChilds[node] >= 0) {
+            node = m_firstChilds[node];
+            depth++;
+            continue;
+        }
+
+        //empty parent is ended at once, then the walk goes up until there is next sibling
+        int ended = isParent ? node : -1;
+        while (true) {
+            if (ended >= 0)
+                WriteEndTag(ended, writer, depth);
+            if (m_nextSiblings[node] >= 0 || depth == top)
+                break;
+            node = m_parents[node];
+            ended = node;
+            depth--;
+        }
+        node = m_nextSiblings[node];
+    }
+}
+
+/*! Prints the root and its childs split to parts, each part is printed by other thread to its
+ * own snapshot writer and the parts are appended to the writer in order.
+ * \param writer Writer of the file.
+ * \param threads Count of threads to use.
+ */
+void CNodeStore::XMLPrintParallel(CXMLWriter & writer, int threads) const {
+    int childs = 0;
+    for (int node = m_firstChilds[0]; node >= 0; node = m_nextSiblings[node])
+        childs++;
+
+    //the first child of each part is found by the links
+    TPrintJob * jobs = new TPrintJob [threads];
+    int node = m_firstChilds[0];
+    int index = 0;
+    for (int i = 0; i < threads; i++) {
+        int from = (int) ((long) childs * i / threads);
+        for (; index < from; index++)
+            node = m_nextSiblings[node];
+        jobs[i].m_store = this;
+        jobs[i].m_first = node;
+        jobs[i].m_writer = new CXMLWriter();
+        jobs[i].m_writer->SetFormat(writer.GetFormat());
+        if (i > 0)
+            jobs[i - 1].m_last = node;
+    }
+    jobs[threads - 1].m_last = -1;
+
+    pthread_t * ids = new pthread_t [threads];
+    bool * started = new bool [threads];
+    //the first part is printed by this thread
+    for (int i = 0; i < threads; i++)
+        started[i] = i > 0 && pthread_create(&ids[i], NULL, PrintRangeThread, &jobs[i]) == 0;
+
+    WriteStartTag(0, writer);
+    writer.Write(">");
+    for (int i = 0; i < threads; i++) {
+        if (started[i])
+            pthread_join(ids[i], NULL);
+        else
+            PrintRangeThread(&jobs[i]);
+        writer.Append(jobs[i].m_writer);
+    }
+    WriteEndTag(0, writer, 0);
+
+    delete [] jobs;
+    delete [] ids;
+    delete [] started;
+}
+
+/*! Thread function, which prints the siblings of the job to its snapshot writer.
+ * \param job Pointer to the TPrintJob.
+ */
+void * CNodeStore::PrintRangeThread(void * job) {
+    TPrintJob * printJob = (TPrintJob *) job;
+    printJob->m_store->XMLPrintRange(*printJob->m_writer, printJob->m_first, printJob->m_last, 1, true);
+    return NULL;
+}
+
+/*! Gets the atom of the name, the table is not locked for known names.
+ * \param name The name.
+ */
+int CNodeStore::GetAtom(const CText & name) {
+    int atom = m_atoms.Find(name);
+    return atom >= 0 ? atom : m_atoms.Add(name);
+}
+
+/*! Gets the reference to the text, texts outside of the source (or before the block of the node) are copied to the heap.
+ * \param node Index of the node, references are offsets from the bases of its block.
+ * \param text The text.
+ * \return The reference.
+ */
+uint32_t CNodeStore::StoreText(int node, const CText & text) {
+    if (text.GetLength() > MAX_LENGTH)
+        throw bad_alloc();
+    size_t base = m_sourceBases[node >> BLOCK_SHIFT];
+    if (m_source != NULL && text.GetData() >= m_source + base && text.GetData() + text.GetLength() <= m_source + m_sourceSize
+            && (size_t) (text.GetData() - m_source) - base <= MAX_REFERENCE) {
+        m_lastSource = text.GetData() - m_source;
+        return m_lastSource - base;
+    }
+
+    base = m_heapBases[node >> BLOCK_SHIFT];
+    if (m_heapUsed - base > MAX_REFERENCE)
+        throw bad_alloc();
+    if (m_heapUsed + text.GetLength() > m_heapSize) {
+        size_t size = m_heapSize ? m_heapSize : DEFAULT_HEAP_SIZE;
+        while (m_heapUsed + text.GetLength() > size)
+            size *= REALLOC_CONSTANT;
+        ReallocArray(m_heap, size);
+        m_heapSize = size;
+    }
+    uint32_t ref = (m_heapUsed - base) | HEAP_REFERENCE;
+    memcpy(m_heap + m_heapUsed, text.GetData(), text.GetLength());
+    m_heapUsed += text.GetLength();
+    return ref;
+}
+
+/*! Gets the text of the reference.
+ * \param node Index of the node of the text.
+ * \param ref The reference.
+ * \param length Length of the text.
+ */
+CText CNodeStore::GetText(int node, uint32_t ref, uint32_t length) const {
+    if (length == 0)
+        return CText();
+    if (ref & HEAP_REFERENCE)
+        return CText(m_heap + m_heapBases[node >> BLOCK_SHIFT] + (ref & ~HEAP_REFERENCE), length);
+    return CText(m_source + m_sourceBases[node >> BLOCK_SHIFT] + ref, length);
+}
+
+/*! Gets the length of the node in the source, 0 if it is not copied from the source.
+ * \param node Index of the node.
+ */
+size_t CNodeStore::GetSourceLength(int node) const {
+    return node == 0 ? m_rootLength : m_sourceLengths[node];
+}
+
+/*! Prints the white spaces in front of the node like CNode::XMLPrintIndent, they are copied from the source.
+ * \param node Index of the node.
+ * \param writer Writer of the file.
+ * \param depth Depth of the node.
+ */
+void CNodeStore::WriteIndent(int node, CXMLWriter & writer, int depth) const {
+    if (writer.GetFormat() == WRITER_MINIFY)
+        return;
+    if (GetSourceLength(node) == 0 || writer.GetFormat() == WRITER_PRETTY) {
+        writer.WriteLine();
+        writer.WriteIndent(depth);
+        return;
+    }
+    //there is always the end of other tag in front of the white spaces
+    const char * data = m_source + m_sourceBases[node >> BLOCK_SHIFT] + m_sources[node];
+    const char * start = CScanner::SkipWhitespacesBack(data);
+    writer.Write(start, data - start);
+}
+
+/*! Writes the start tag of the node without the closing character.
+ * \param node Index of the node.
+ * \param writer Writer of the file.
+ */
+void CNodeStore::WriteStartTag(int node, CXMLWriter & writer) const {
+    writer.Write("<");
+    writer.Write(GetTitle(node));
+    int cnt = GetAttributeCount(node);
+    for (int i = 0; i < cnt; i++) {
+        writer.Write(" ");
+        writer.Write(GetAttributeName(node, i));
+        writer.Write("=\"");
+        writer.Write(GetAttributeValue(node, i));
+        writer.Write("\"");
+    }
+}
+
+/*! Writes the end tag of the parent node, which is not copied from the source, like CParentNode::XMLPrint.
+ * \param node Index of the node.
+ * \param writer Writer of the file.
+ * \param depth Depth of the node.
+ */
+void CNodeStore::WriteEndTag(int node, CXMLWriter & writer, int depth) const {
+    if (writer.GetFormat() == WRITER_SOURCE || (writer.GetFormat() == WRITER_PRETTY && m_firstChilds[node] >= 0)) {
+        writer.WriteLine();
+        writer.WriteIndent(depth);
+    }
+    writer.Write("</");
+    writer.Write(GetTitle(node));
+    writer.Write(">");
+}
+
+/*! Nodes memory management.
+ */
+void CNodeStore::ReallocNodes() {
+    if (m_cnt >= m_size) {
+        size_t size = m_size ? m_size * REALLOC_CONSTANT : DEFAULT_NODES_SIZE;
+        ReallocArray(m_kinds, size);
+        ReallocArray(m_names, size);
+        ReallocArray(m_parents, size);
+        ReallocArray(m_firstChilds, size);
+        ReallocArray(m_nextSiblings, size);
+        ReallocArray(m_values, size);
+        ReallocArray(m_valueLengths, size);
+        ReallocArray(m_firstAttributes, size);
+        ReallocArray(m_sources, size);
+        ReallocArray(m_sourceLengths, size);
+        ReallocArray(m_sourceBases, (size >> BLOCK_SHIFT) + 1);
+        ReallocArray(m_heapBases, (size >> BLOCK_SHIFT) + 1);
+        m_size = size;
+    }
+}
+
+/*! Attributes memory management.
+ */
+void CNodeStore::ReallocAttributes() {
+    if (m_cntAtt >= m_sizeAtt) {
+        size_t size = m_sizeAtt ? m_sizeAtt * REALLOC_CONSTANT : DEFAULT_ATTRIBUTES_SIZE;
+        ReallocArray(m_attributeNames, size);
+        ReallocArray(m_attributeValues, size);
+        ReallocArray(m_attributeLengths, size);
+        m_sizeAtt = size;
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef CNODESTORE_H
+#define	CNODESTORE_H
+
+#include <cstdlib>
+#include <stdint.h>
+#include <string>
+
+#include "CText.h"
+#include "CAtomTable.h"
+#include "CXMLWriter.h"
+
+using namespace std;
+
+///! Class, which stores the whole document in flat arrays (one item per node), nodes are linked by indices.
+///! Kinds of the nodes are the types of the reader (NEXT_IS_TEXTNODE, NEXT_IS_PARENTNODE, NEXT_IS_COMMENT, NEXT_IS_SIMPLE),
+///! the first node is the root and the nodes are in the order of the document. Texts point to the source data,
+///! or to the own heap of the store. Positions are 32-bit offsets from the bases of blocks of nodes (like in CImage),
+///! so big documents do not need 64-bit items. It is the read-only model of the documents of the command line tool.
+
+class CNodeStore {
+public:
+    CNodeStore(const char * source, size_t size);
+    ~CNodeStore();
+
+    //building
+    int AddNode(int kind, const CText & title, int parent, int previous);
+    void AddAttribute(int node, const CText & name, const CText & value);
+    void SetValue(int node, const CText & value);
+    void StartSource(int node, const CText & tag);
+    void EndSource(int node, const CText & tag);
+    void SetVersionData(const string & versionData);
+    void Shrink();
+
+    //getters
+    int GetCount() const;
+    int GetKind(int node) const;
+    int GetName(int node) const;
+    CText GetTitle(int node) const;
+    CText GetValue(int node) const;
+    CText GetSource(int node) const;
+    int GetParent(int node) const;
+    int GetFirstChild(int node) const;
+    int GetNextSibling(int node) const;
+    int GetAttributeCount(int node) const;
+    CText GetAttributeName(int node, int i) const;
+    CText GetAttributeValue(int node, int i) const;
+    const CAtomTable & GetAtoms() const;
+
+    //traversals
+    void Print(CXMLWriter & writer) const;
+    void XMLPrint(int node, CXMLWriter & writer) const;
+    int FindChild(int node, int name, int number) const;
+    int FindPath(const string & path) const;
+    int FindNext(int name, int from) const;
+protected:
+    int GetAtom(const CText & name);
+    uint32_t StoreText(int node, const CText & text);
+    CText GetText(int node, uint32_t ref, uint32_t length) const;
+    size_t GetSourceLength(int node) const;
+    void WriteIndent(int node, CXMLWriter & writer, int depth) const;
+    void WriteStartTag(int node, CXMLWriter & writer) const;
+    void WriteEndTag(int node, CXMLWriter & writer, int depth) const;
+    void XMLPrintRange(CXMLWriter & writer, int first, int last, int depth, bool isIndented) const;
+    void XMLPrintParallel(CXMLWriter & writer, int threads) const;
+    void ReallocNodes();
+    void ReallocAttributes();
+
+    static void * PrintRangeThread(void * job);
+
+    ///! Structure, which specifies the siblings printed by one thread.
+    struct TPrintJob {
+        ///! The printed store
+        const CNodeStore * m_store;
+        ///! The first printed sibling
+        int m_first;
+        ///! Sibling after the last printed one (-1 for the end)
+        int m_last;
+        ///! Snapshot writer of the thread
+        CXMLWriter * m_writer;
+    };
+
+    //nodes
+    ///! Kinds of the nodes
+    char * m_kinds;
+    ///! Atoms of the titles (-1 for comments)
+    int * m_names;
+    ///! Parents of the nodes (-1 for the root)
+    int * m_parents;
+    ///! First childs of the nodes (-1 if there is none)
+    int * m_firstChilds;
+    ///! Next siblings of the nodes (-1 if there is none)
+    int * m_nextSiblings;
+    ///! Values of text nodes and comments (references to texts)
+    uint32_t * m_values;
+    ///! Lengths of the values
+    uint32_t * m_valueLengths;
+    ///! Index of the first attribute of the nodes (attributes of the node end at the first one of next node)
+    int * m_firstAttributes;
+    ///! Positions of the nodes in the source (from the start tag to the end tag), offsets from the source base
+    uint32_t * m_sources;
+    ///! Lengths of the nodes in the source, 0 if the node is not in the source
+    uint32_t * m_sourceLengths;
+    ///! Positions in the source, from which the offsets of the blocks of nodes are counted
+    size_t * m_sourceBases;
+    ///! Positions in the heap, from which the references of the blocks of nodes are counted
+    size_t * m_heapBases;
+    ///! Count of nodes
+    int m_cnt;
+    ///! Current max count of nodes
+    int m_size;
+
+    //attributes (attributes of one node are together)
+    ///! Atoms of the names of attributes
+    int * m_attributeNames;
+    ///! Values of attributes (references to texts)
+    uint32_t * m_attributeValues;
+    ///! Lengths of the values of attributes
+    uint32_t * m_attributeLengths;
+    ///! Count of attributes
+    int m_cntAtt;
+    ///! Current max count of attributes
+    int m_sizeAtt;
+
+    ///! Names of the elements and attributes
+    CAtomTable m_atoms;
+    ///! XML version information
+    string m_versionData;
+
+    //texts
+    ///! Pointer to the source data, NULL if all the texts are copied
+    const char * m_source;
+    ///! Size of the source data
+    size_t m_sourceSize;
+    ///! The last position stored from the source, base of the next block
+    size_t m_lastSource;
+    ///! Length of the root in the source, it may not fit to 32 bits
+    size_t m_rootLength;
+    ///! Texts, which are not in the source
+    char * m_heap;
+    ///! Used bytes of the heap
+    size_t m_heapUsed;
+    ///! Size of the heap
+    size_t m_heapSize;
+};
+
+#endif	/* CNODESTORE_H */
+
@@ -0,0 +1,350 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <pthread.h>
+
+#include "CParser.h"
+#include "CStructuralIndex.h"
+#include "CXMLReader.h"
+#include "CXMLPushReader.h"
+#include "CTreeBuilder.h"
+#include "CStoreBuilder.h"
+#include "CScanner.h"
+#include "CException.h"
+#include "functions.h"
+
+///! Minimal count of bytes parsed by one thread
+#define PARALLEL_MIN_PART (2 * 1024 * 1024)
+///! Maximal count of parsing threads
+#define PARALLEL_MAX_THREADS 64
+///! In bigger files, childs of the root are parsed when they are expanded
+#define LAZY_MIN_SIZE (64 * 1024 * 1024)
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new parser of given data.
+ * \param data Pointer to the data, texts of the nodes will point to it.
+ * \param size Size of the data.
+ * \param filePath File name (for exceptions), it must exist as long as the nodes (they may be parsed later).
+ * \param arena Pointer to the arena of the document, where the nodes are allocated.
+ */
+CParser::CParser(const char * data, size_t size, const string & filePath, CArena * arena) {
+    m_data = data;
+    m_size = size;
+    m_filePath = &filePath;
+    m_arena = arena;
+    m_progress = NULL;
+}
+
+/*! Parsed bytes and nodes will be counted and the loading can be canceled.
+ * \param progress Pointer to the progress shared with the interface.
+ */
+void CParser::SetProgress(CProgress * progress) {
+    m_progress = progress;
+}
+
+/*! Parses the whole data into a tree, big files with parent root are parsed by more threads
+ * and childs of the root in huge files are parsed only when they are needed.
+ * \param versionData To this string is saved XML version information (if there are any).
+ * \return Pointer to the root of the tree.
+ */
+CNode * CParser::Parse(string & versionData) {
+    if (m_size >= LAZY_MIN_SIZE)
+        return ParseDocument(versionData, true);
+
+    long threads = CountProcessors();
+    if (threads > (long) (m_size / PARALLEL_MIN_PART))
+        threads = m_size / PARALLEL_MIN_PART;
+    if (threads > PARALLEL_MAX_THREADS)
+        threads = PARALLEL_MAX_THREADS;
+
+    if (m_size >= PARALLEL_MIN_SIZE && threads > 1) {
+        CNode * root = ParseParallel(versionData, threads);
+        if (root)
+            return root;
+        if (m_progress && m_progress->IsCanceled())
+            throw LoadingCanceledException();
+    }
+    //parsing by one thread also finds the right error
+    return ParseDocument(versionData, false);
+}
+
+/*! Parses the whole data into the flat node store, it needs much less memory than the tree of nodes.
+ * Texts of the store point to the data.
+ * \return Pointer to the new store.
+ * \throws InvalidXMLFormatException The error with its line and column, like from the checker.
+ */
+CNodeStore * CParser::ParseStore() {
+    CNodeStore * store = new CNodeStore(m_data, m_size);
+    CStoreBuilder builder(store);
+    CXMLReader reader(m_data, m_size, *m_filePath, &builder);
+
+    try {
+        reader.Read();
+    } catch (InvalidXMLFormatException & e) {
+        delete store;
+        e.Locate(m_data, m_size);
+        throw;
+    } catch (const CException & e) {
+        delete store;
+        throw;
+    }
+    store->Shrink();
+    return store;
+}
+
+/*! Parses the data decompressed by the decoder thread into the flat node store, the texts are copied to the store.
+ * \param decoder Pointer to the decoder of the data.
+ * \return Pointer to the new store.
+ */
+CNodeStore * CParser::ParseStore(CDecoder * decoder) {
+    CNodeStore * store = new CNodeStore(NULL, 0);
+    CStoreBuilder builder(store);
+    CXMLPushReader reader(*m_filePath, &builder);
+
+    try {
+        decoder->Start();
+        const char * data;
+        size_t size;
+        while ((data = decoder->Next(size)) != NULL) {
+            reader.Feed(data, size);
+            decoder->Release();
+        }
+        reader.Finish();
+    } catch (const CException & e) {
+        delete store;
+        throw;
+    }
+    store->Shrink();
+    return store;
+}
+
+/*! Builds the tree from the image of the data without parsing, the image has to be open.
+ * \param image Pointer to the reader of the image.
+ * \param versionData To this string is saved XML version information (if there are any).
+ * \return Pointer to the root of the tree.
+ */
+CNode * CParser::ReadImage(CImageReader * image, string & versionData) {
+    CTreeBuilder builder(NULL, m_arena);
+    //childs of the childs of the root are built, when they are expanded
+    builder.SetLazy(m_filePath);
+    if (m_progress) {
+        m_progress->Start(m_size);
+        builder.SetProgress(m_progress, 0);
+    }
+
+    try {
+        image->Read(&builder);
+    } catch (const CException & e) {
+        delete builder.GetRoot();
+        throw;
+    }
+    versionData = builder.GetVersionData();
+    return builder.GetRoot();
+}
+
+/*! Builds the tree from the data decompressed by the decoder thread. The parts of the data are read by
+ * the push reader as they come (meanwhile the next parts are decompressed), the texts are copied to the arena.
+ * \param decoder Pointer to the decoder of the data.
+ * \param versionData To this string is saved XML version information (if there are any).
+ * \return Pointer to the root of the tree.
+ */
+CNode * CParser::ParseDecoded(CDecoder * decoder, string & versionData) {
+    CTreeBuilder builder(NULL, m_arena);
+    builder.SetCopying(true);
+    if (m_progress) {
+        m_progress->Start(decoder->GetSizeHint());
+        builder.SetProgress(m_progress, 0);
+    }
+    CXMLPushReader reader(*m_filePath, &builder);
+
+    try {
+        decoder->Start();
+        const char * data;
+        size_t size;
+        while ((data = decoder->Next(size)) != NULL) {
+            reader.Feed(data, size);
+            decoder->Release();
+        }
+        reader.Finish();
+    } catch (const CException & e) {
+        delete builder.GetRoot();
+        throw;
+    }
+    versionData = builder.GetVersionData();
+    return builder.GetRoot();
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Parses the whole data into a tree by this thread.
+ * \param versionData To this string is saved XML version information (if there are any).
+ * \param lazy Are parent childs of the root only skipped (their content is checked when they are parsed)?
+ * \return Pointer to the root of the tree.
+ */
+CNode * CParser::ParseDocument(string & versionData, bool lazy) {
+    //the tree is built from the events of the reader
+    CTreeBuilder builder(NULL, m_arena);
+    if (lazy)
+        builder.SetLazy(m_filePath);
+    if (m_progress) {
+        m_progress->Start(m_size);
+        builder.SetProgress(m_progress, 0);
+    }
+    CXMLReader reader(m_data, m_size, *m_filePath, &builder);
+
+    try {
+        reader.Read();
+    } catch (const CException & e) {
+        delete builder.GetRoot();
+        throw;
+    }
+    versionData = builder.GetVersionData();
+    return builder.GetRoot();
+}
+
+/*! Parses the data in two stages. First the structural index finds childs of the root
+ * and then the childs are split to parts read by more threads.
+ * \param versionData To this string is saved XML version information (if there are any).
+ * \param threads Count of threads to use.
+ * \return Pointer to the root of the tree, NULL if the data has to be parsed by one thread.
+ */
+CNode * CParser::ParseParallel(string & versionData, int threads) {
+    CTreeBuilder builder(NULL, m_arena);
+    CXMLReader reader(m_data, m_size, *m_filePath, &builder);
+    CParentNode * root = NULL;
+    size_t * cuts = new size_t [threads + 1];
+    int cntCuts = 0;
+    size_t rootEnd = 0;
+    size_t next = 0;
+    if (m_progress)
+        m_progress->Start(m_size);
+
+    try {
+        //root start tag is read here, it must be a parent node
+        size_t pos = reader.ReadRootStart();
+        root = (CParentNode *) builder.GetRoot();
+        if (pos == 0) {
+            delete [] cuts;
+            return NULL;
+        }
+        string title = root->GetTitle();
+
+        //stage one - index of all < and > characters
+        CStructuralIndex index(m_data, m_size, threads);
+
+        //the childs of the root are cut to parts of similar size
+        int depth = 1;
+        next = pos;
+        while (depth > 0) {
+            size_t start = index.FindTagStart(next);
+            size_t end = index.FindTagEnd(start + 1);
+            if (end >= m_size) //root is not closed
+                break;
+
+            if (m_data[start + 1] == 47) { //end tag
+                depth--;
+                rootEnd = start;
+            } else {
+                if (depth == 1 && cntCuts < threads && start >= pos + (m_size - pos) / threads * cntCuts)
+                    cuts[cntCuts++] = start;
+                bool simple = m_data[end - 1] == 47;
+                bool comment = end - start > 3 && m_data[start + 1] == 33 && m_data[start + 2] == 45 && m_data[start + 3] == 45;
+                if (!simple && !comment)
+                    depth++;
+            }
+            next = end + 1;
+        }
+
+        //root end tag must be the last one and it must match
+        if (depth > 0 || CText(m_data + rootEnd + 2, next - 1 - (rootEnd + 2)).Compare(title) != 0
+                || CScanner::SkipWhitespaces(m_data, m_size, next) < m_size || cntCuts < 2) {
+            delete root;
+            delete [] cuts;
+            return NULL;
+        }
+        cuts[cntCuts] = rootEnd;
+    } catch (const CException & e) {
+        delete root;
+        delete [] cuts;
+        return NULL;
+    }
+
+    //stage two - every part is parsed to its own temporary parent in its own arena, the arenas
+    //are kept by the document only if all the parts are parsed
+    TJob * jobs = new TJob [cntCuts];
+    pthread_t * ids = new pthread_t [cntCuts];
+    for (int i = 0; i < cntCuts; i++) {
+        jobs[i].m_data = m_data;
+        jobs[i].m_size = m_size;
+        jobs[i].m_filePath = m_filePath;
+        jobs[i].m_begin = cuts[i];
+        jobs[i].m_end = cuts[i + 1];
+        jobs[i].m_arena = m_arena->CreateChild();
+        jobs[i].m_parent = new (jobs[i].m_arena) CParentNode(root->GetAtom());
+        jobs[i].m_progress = m_progress;
+        jobs[i].m_failed = false;
+    }
+    int started = 1;
+    for (; started < cntCuts; started++) {
+        if (pthread_create(&ids[started], NULL, ParseRangeThread, &jobs[started]) != 0)
+            break;
+    }
+    //the first part is parsed by this thread
+    ParseRangeThread(&jobs[0]);
+    for (int i = 1; i < started; i++)
+        pthread_join(ids[i], NULL);
+    //if a thread could not be started, its part is parsed here
+    for (int i = started; i < cntCuts; i++)
+        ParseRangeThread(&jobs[i]);
+
+    //childs are moved to the root in the right order
+    bool failed = false;
+    for (int i = 0; i < cntCuts; i++) {
+        if (jobs[i].m_failed)
+            failed = true;
+        else if (!failed)
+            root->TakeChilds(jobs[i].m_parent);
+        delete jobs[i].m_parent;
+    }
+    if (failed)
+        delete root;
+    //partial nodes are freed before the document is parsed again by one thread
+    for (int i = 0; i < cntCuts; i++) {
+        if (failed)
+            delete jobs[i].m_arena;
+        else
+            m_arena->AddChild(jobs[i].m_arena);
+    }
+    delete [] jobs;
+    delete [] ids;
+    delete [] cuts;
+
+    if (failed)
+        return NULL;
+    //the root end tag was found by the index
+    root->EndSource(CText(m_data + rootEnd, next - rootEnd));
+    versionData = builder.GetVersionData();
+    return root;
+}
+
+/********************* THREAD FUNCTION *******************************/
+
+/*! Thread function, which parses one part of the root childs by its own reader.
+ * \param job Pointer to TJob.
+ */
+void * CParser::ParseRangeThread(void * job) {
+    TJob * j = (TJob *) job;
+    CTreeBuilder builder(j->m_parent, j->m_arena);
+    if (j->m_progress)
+        builder.SetProgress(j->m_progress, j->m_begin);
+    CXMLReader reader(j->m_data, j->m_size, *j->m_filePath, &builder);
+    try {
+        reader.ReadRange(j->m_begin, j->m_end);
+    } catch (const CException & e) {
+        j->m_failed = true;
+    }
+    return NULL;
+}
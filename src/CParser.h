@@ -0,0 +1,73 @@
+#ifndef CPARSER_H
+#define	CPARSER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CArena.h"
+#include "CNode.h"
+#include "CNodeStore.h"
+#include "CProgress.h"
+#include "CImageReader.h"
+#include "CDecoder.h"
+
+using namespace std;
+
+///! Smaller files are always parsed by one thread
+#define PARALLEL_MIN_SIZE (8 * 1024 * 1024)
+
+///! Class, which parses XML data (usually mapped file) into a tree of nodes by the XML reader, big files are parsed by more threads.
+///! The command line tool parses the data into the flat node store.
+
+class CParser {
+public:
+    CParser(const char * data, size_t size, const string & filePath, CArena * arena);
+
+    void SetProgress(CProgress * progress);
+    CNode * Parse(string & versionData);
+    CNodeStore * ParseStore();
+    CNodeStore * ParseStore(CDecoder * decoder);
+    CNode * ReadImage(CImageReader * image, string & versionData);
+    CNode * ParseDecoded(CDecoder * decoder, string & versionData);
+protected:
+    CNode * ParseDocument(string & versionData, bool lazy);
+    CNode * ParseParallel(string & versionData, int threads);
+
+    static void * ParseRangeThread(void * job);
+
+    ///! Structure, which specifies part of the root childs parsed by one thread.
+    struct TJob {
+        ///! Pointer to the parsed data
+        const char * m_data;
+        ///! Size of the parsed data
+        size_t m_size;
+        ///! File name (for exceptions)
+        const string * m_filePath;
+        ///! Position of the first child
+        size_t m_begin;
+        ///! Position after the last child
+        size_t m_end;
+        ///! Arena of the thread, where its nodes are allocated
+        CArena * m_arena;
+        ///! Temporary parent of parsed childs
+        CParentNode * m_parent;
+        ///! Progress of the loading (NULL if it is not counted)
+        CProgress * m_progress;
+        ///! Did the parsing fail?
+        bool m_failed;
+    };
+
+    ///! Pointer to the parsed data
+    const char * m_data;
+    ///! Size of the parsed data
+    size_t m_size;
+    ///! File name (for exceptions)
+    const string * m_filePath;
+    ///! Pointer to the arena of the document
+    CArena * m_arena;
+    ///! Progress of the loading, NULL if it is not counted
+    CProgress * m_progress;
+};
+
+#endif	/* CPARSER_H */
+
@@ -0,0 +1,207 @@
+#include <cstdlib>
+#include <ctime>
+#include <pthread.h>
+
+#include "CProgress.h"
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new progress, nobody owns the document yet.
+ */
+CProgress::CProgress() {
+    m_busy = false;
+    m_waiting = 0;
+    m_bytes = 0;
+    m_size = 0;
+    m_nodes = 0;
+    m_canceled = false;
+    m_finished = false;
+    m_root = NULL;
+    m_complete = 0;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_released, NULL);
+}
+
+/*! Destroys the locks.
+ */
+CProgress::~CProgress() {
+    pthread_cond_destroy(&m_released);
+    pthread_mutex_destroy(&m_lock);
+}
+
+/********************* THE DOCUMENT *******************************/
+
+/*! Waits, until the document is free and takes it.
+ */
+void CProgress::Lock() {
+    pthread_mutex_lock(&m_lock);
+    m_waiting++;
+    while (m_busy)
+        pthread_cond_wait(&m_released, &m_lock);
+    m_waiting--;
+    m_busy = true;
+    pthread_mutex_unlock(&m_lock);
+}
+
+/*! Waits for the document at most given time, the loading thread lets it go after the next nodes.
+ * \param timeout Maximal time to wait (in milliseconds).
+ * \return True, if the document was taken.
+ */
+bool CProgress::TryLock(int timeout) {
+    timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += timeout / 1000;
+    until.tv_nsec += (long) (timeout % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    m_waiting++;
+    while (m_busy) {
+        if (pthread_cond_timedwait(&m_released, &m_lock, &until) != 0 && m_busy)
+            break;
+    }
+    m_waiting--;
+    bool taken = !m_busy;
+    if (taken)
+        m_busy = true;
+    pthread_mutex_unlock(&m_lock);
+    return taken;
+}
+
+/*! Releases the document.
+ */
+void CProgress::Unlock() {
+    pthread_mutex_lock(&m_lock);
+    m_busy = false;
+    pthread_cond_broadcast(&m_released);
+    pthread_mutex_unlock(&m_lock);
+}
+
+/********************* LOADING THREAD *******************************/
+
+/*! Starts counting from zero, the data may be parsed again in another way.
+ * \param size Size of the data.
+ */
+void CProgress::Start(size_t size) {
+    pthread_mutex_lock(&m_lock);
+    m_size = size;
+    m_bytes = 0;
+    m_nodes = 0;
+    pthread_mutex_unlock(&m_lock);
+}
+
+/*! Adds parsed bytes and nodes, more threads can add at once.
+ * \param bytes Count of newly parsed bytes.
+ * \param nodes Count of newly parsed nodes.
+ * \return False, if the loading was canceled.
+ */
+bool CProgress::Add(size_t bytes, int nodes) {
+    pthread_mutex_lock(&m_lock);
+    m_bytes += bytes;
+    m_nodes += nodes;
+    bool canceled = m_canceled;
+    pthread_mutex_unlock(&m_lock);
+    return !canceled;
+}
+
+/*! Publishes the complete part of the tree, the owner of the document lets the waiting threads in
+ * and takes the document back, when they release it.
+ * \param root Pointer to the root of the tree being built.
+ * \param complete Count of the first childs of the root, which won't change any more.
+ */
+void CProgress::Publish(CNode * root, int complete) {
+    pthread_mutex_lock(&m_lock);
+    m_root = root;
+    m_complete = complete;
+    if (m_waiting > 0) {
+        m_busy = false;
+        pthread_cond_broadcast(&m_released);
+        while (m_busy || m_waiting > 0)
+            pthread_cond_wait(&m_released, &m_lock);
+        m_busy = true;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+/*! Marks the end of the loading thread, the tree is not published any more.
+ */
+void CProgress::Finish() {
+    pthread_mutex_lock(&m_lock);
+    m_root = NULL;
+    m_complete = 0;
+    m_finished = true;
+    pthread_mutex_unlock(&m_lock);
+}
+
+/********************* INTERFACE *******************************/
+
+/*! Asks the loading thread to stop, it stops after the next nodes.
+ */
+void CProgress::Cancel() {
+    pthread_mutex_lock(&m_lock);
+    m_canceled = true;
+    pthread_mutex_unlock(&m_lock);
+}
+
+/*! Was the loading canceled?
+ */
+bool CProgress::IsCanceled() const {
+    pthread_mutex_lock(&m_lock);
+    bool canceled = m_canceled;
+    pthread_mutex_unlock(&m_lock);
+    return canceled;
+}
+
+/*! Has the loading thread finished?
+ */
+bool CProgress::IsFinished() const {
+    pthread_mutex_lock(&m_lock);
+    bool finished = m_finished;
+    pthread_mutex_unlock(&m_lock);
+    return finished;
+}
+
+/*! Gets the count of parsed bytes.
+ */
+size_t CProgress::GetBytes() const {
+    pthread_mutex_lock(&m_lock);
+    size_t bytes = m_bytes;
+    pthread_mutex_unlock(&m_lock);
+    return bytes;
+}
+
+/*! Gets the size of the data (0 until the loading starts).
+ */
+size_t CProgress::GetSize() const {
+    pthread_mutex_lock(&m_lock);
+    size_t size = m_size;
+    pthread_mutex_unlock(&m_lock);
+    return size;
+}
+
+/*! Gets the count of parsed nodes.
+ */
+int CProgress::GetNodes() const {
+    pthread_mutex_lock(&m_lock);
+    int nodes = m_nodes;
+    pthread_mutex_unlock(&m_lock);
+    return nodes;
+}
+
+/*! Gets the root of the tree being built, the caller must own the document.
+ * \return Pointer to the root, NULL if no part of the tree is published.
+ */
+CNode * CProgress::GetRoot() const {
+    return m_root;
+}
+
+/*! Gets the count of the first childs of the root, which won't change any more, the caller must own the document.
+ */
+int CProgress::GetComplete() const {
+    return m_complete;
+}
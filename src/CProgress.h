@@ -0,0 +1,65 @@
+#ifndef CPROGRESS_H
+#define	CPROGRESS_H
+
+#include <cstdlib>
+#include <pthread.h>
+
+using namespace std;
+
+class CNode;
+
+///! Class, which is shared by the loading thread and the interface. The loading thread owns the document,
+///! counts parsed bytes and nodes and lets the waiting interface in between the nodes (the tree is consistent then).
+
+class CProgress {
+public:
+    CProgress();
+    ~CProgress();
+
+    //the document
+    void Lock();
+    bool TryLock(int timeout);
+    void Unlock();
+
+    //loading thread
+    void Start(size_t size);
+    bool Add(size_t bytes, int nodes);
+    void Publish(CNode * root, int complete);
+    void Finish();
+
+    //interface
+    void Cancel();
+    bool IsCanceled() const;
+    bool IsFinished() const;
+    size_t GetBytes() const;
+    size_t GetSize() const;
+    int GetNodes() const;
+    CNode * GetRoot() const;
+    int GetComplete() const;
+protected:
+    ///! Lock of the members
+    mutable pthread_mutex_t m_lock;
+    ///! Signals, that the document was released
+    pthread_cond_t m_released;
+    ///! Is the document used by a thread?
+    bool m_busy;
+    ///! Count of threads waiting for the document
+    int m_waiting;
+    ///! Count of parsed bytes
+    size_t m_bytes;
+    ///! Size of the data
+    size_t m_size;
+    ///! Count of parsed nodes
+    int m_nodes;
+    ///! Should the loading stop?
+    bool m_canceled;
+    ///! Has the loading thread finished?
+    bool m_finished;
+    ///! Root of the tree being built (only for the owner of the document)
+    CNode * m_root;
+    ///! Count of childs of the root, which are complete (only for the owner of the document)
+    int m_complete;
+};
+
+#endif	/* CPROGRESS_H */
+
@@ -0,0 +1,158 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "CRowList.h"
+
+///! Default count of rows
+#define DEFAULT_ROWS_COUNT 128
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty list.
+ */
+CRowList::CRowList() {
+    m_nodes = new CNode * [DEFAULT_ROWS_COUNT];
+    m_depths = new int [DEFAULT_ROWS_COUNT];
+    m_cnt = 0;
+    m_size = DEFAULT_ROWS_COUNT;
+    m_gap = 0;
+}
+
+/*! Deletes the list, nodes are not deleted.
+ */
+CRowList::~CRowList() {
+    delete [] m_nodes;
+    delete [] m_depths;
+}
+
+/*! Removes all the rows, the memory is kept for next rows.
+ */
+void CRowList::Clear() {
+    m_cnt = 0;
+    m_gap = 0;
+}
+
+/*! Adds a row to the end of the list.
+ * \param node Pointer to the node of the row.
+ * \param depth Specifies how deep in the tree the node is.
+ */
+void CRowList::Add(CNode * node, int depth) {
+    MoveGap(m_cnt);
+    ReallocRows(1);
+    m_nodes[m_gap] = node;
+    m_depths[m_gap++] = depth;
+    m_cnt++;
+}
+
+/*! Inserts the rows of other list in front of the row.
+ * \param row Index of the row, the count of rows inserts them to the end.
+ * \param rows The inserted rows.
+ */
+void CRowList::Insert(int row, const CRowList & rows) {
+    MoveGap(row);
+    ReallocRows(rows.m_cnt);
+    for (int i = 0; i < rows.m_cnt; i++) {
+        m_nodes[m_gap] = rows.GetNode(i);
+        m_depths[m_gap++] = rows.GetDepth(i);
+    }
+    m_cnt += rows.m_cnt;
+}
+
+/*! Removes the rows, the gap takes their place.
+ * \param row Index of the first removed row.
+ * \param count Count of removed rows.
+ */
+void CRowList::Remove(int row, int count) {
+    MoveGap(row);
+    m_cnt -= count;
+}
+
+/*! Gets the count of rows.
+ */
+int CRowList::GetCount() const {
+    return m_cnt;
+}
+
+/*! Gets the node of the row.
+ * \param row Index of the row.
+ */
+CNode * CRowList::GetNode(int row) const {
+    return m_nodes[GetIndex(row)];
+}
+
+/*! Gets the depth of the node of the row.
+ * \param row Index of the row.
+ */
+int CRowList::GetDepth(int row) const {
+    return m_depths[GetIndex(row)];
+}
+
+/*! Finds the end of the rows of the node and its visible descendants.
+ * \param row Index of the row of the node.
+ * \return Index of the first row after the rows of the descendants.
+ */
+int CRowList::GetSubtreeEnd(int row) const {
+    int depth = GetDepth(row);
+    row++;
+    while (row < m_cnt && GetDepth(row) > depth)
+        row++;
+    return row;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Gets the index of the row in the arrays.
+ * \param row Index of the row.
+ */
+int CRowList::GetIndex(int row) const {
+    return row < m_gap ? row : row + m_size - m_cnt;
+}
+
+/*! Moves the gap in front of the row, rows between the old and new place of the gap are moved.
+ * \param row Index of the row.
+ */
+void CRowList::MoveGap(int row) {
+    int gapSize = m_size - m_cnt;
+    if (row < m_gap) {
+        memmove(m_nodes + row + gapSize, m_nodes + row, (m_gap - row) * sizeof (CNode *));
+        memmove(m_depths + row + gapSize, m_depths + row, (m_gap - row) * sizeof (int));
+    } else if (row > m_gap) {
+        memmove(m_nodes + m_gap, m_nodes + m_gap + gapSize, (row - m_gap) * sizeof (CNode *));
+        memmove(m_depths + m_gap, m_depths + m_gap + gapSize, (row - m_gap) * sizeof (int));
+    }
+    m_gap = row;
+}
+
+/*! Rows memory management, ensures that the gap has space for given count of rows.
+ * \param count Count of rows, which will be inserted.
+ */
+void CRowList::ReallocRows(int count) {
+    if (m_cnt + count > m_size) {
+        int size = m_size * REALLOC_CONSTANT;
+        while (m_cnt + count > size)
+            size *= REALLOC_CONSTANT;
+
+        //rows after the gap go to the end of new arrays
+        CNode ** tmp = new CNode * [size];
+        int * tmpDepths = new int [size];
+        int after = m_cnt - m_gap;
+        for (int i = 0; i < m_gap; i++) {
+            tmp[i] = m_nodes[i];
+            tmpDepths[i] = m_depths[i];
+        }
+        for (int i = 0; i < after; i++) {
+            tmp[size - after + i] = m_nodes[m_size - after + i];
+            tmpDepths[size - after + i] = m_depths[m_size - after + i];
+        }
+
+        delete [] m_nodes;
+        delete [] m_depths;
+        m_nodes = tmp;
+        m_depths = tmpDepths;
+        m_size = size;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CROWLIST_H
+#define	CROWLIST_H
+
+#include <cstdlib>
+
+class CNode;
+
+using namespace std;
+
+///! Class, which represents the visible rows of the tree (expanded parts of it) as a flat list.
+///! Every row is a node and its depth, the text of the row is made only when it is shown.
+///! Rows are kept in a gap buffer, so rows can be inserted and removed anywhere, only the rows
+///! between the last change and the next one are moved (changes are made near the cursor).
+
+class CRowList {
+public:
+    CRowList();
+    ~CRowList();
+
+    void Clear();
+    void Add(CNode * node, int depth);
+    void Insert(int row, const CRowList & rows);
+    void Remove(int row, int count);
+
+    int GetCount() const;
+    CNode * GetNode(int row) const;
+    int GetDepth(int row) const;
+    int GetSubtreeEnd(int row) const;
+protected:
+    int GetIndex(int row) const;
+    void MoveGap(int row);
+    void ReallocRows(int count);
+
+    ///! Nodes of the rows
+    CNode ** m_nodes;
+    ///! Depths of the nodes
+    int * m_depths;
+    ///! Count of rows
+    int m_cnt;
+    ///! Current max count of rows
+    int m_size;
+    ///! Row, where the gap starts (rows after it are at the end of the arrays)
+    int m_gap;
+};
+
+#endif	/* CROWLIST_H */
+
@@ -0,0 +1,224 @@
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_X86
+#endif
+
+#include "CScanner.h"
+
+using namespace std;
+
+/********************* BLOCK SCANNERS *******************************/
+
+///! Pointer to the function, which fills the masks for one block.
+typedef void (*TScanBlock)(const char * block, CScanner::TMasks & masks);
+
+/*! Fills the masks for one block, one character at a time (used when there is no SIMD).
+ * \param block Pointer to SCANNER_BLOCK_SIZE characters.
+ * \param masks The masks to be filled.
+ */
+static void ScanBlockScalar(const char * block, CScanner::TMasks & masks) {
+    masks.m_open = masks.m_close = masks.m_space = 0;
+    for (int i = 0; i < SCANNER_BLOCK_SIZE; i++) {
+        uint64_t bit = (uint64_t) 1 << i;
+        char c = block[i];
+        if (c == 60)
+            masks.m_open |= bit;
+        else if (c == 62)
+            masks.m_close |= bit;
+        else if (c == 32 || c == 10 || c == 9 || c == 13) //SPACE, TAB, CR, LF
+            masks.m_space |= bit;
+    }
+}
+
+#ifdef SCANNER_X86
+
+/*! Fills the masks for one block, 16 characters at a time.
+ * \param block Pointer to SCANNER_BLOCK_SIZE characters.
+ * \param masks The masks to be filled.
+ */
+__attribute__((target("sse2")))
+static void ScanBlockSSE2(const char * block, CScanner::TMasks & masks) {
+    const __m128i open = _mm_set1_epi8(60);
+    const __m128i close = _mm_set1_epi8(62);
+    const __m128i space = _mm_set1_epi8(32);
+    const __m128i tab = _mm_set1_epi8(9);
+    const __m128i lf = _mm_set1_epi8(10);
+    const __m128i cr = _mm_set1_epi8(13);
+
+    masks.m_open = masks.m_close = masks.m_space = 0;
+    for (int i = 0; i < SCANNER_BLOCK_SIZE; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (block + i));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)));
+        masks.m_open |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, open)) << i;
+        masks.m_close |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, close)) << i;
+        masks.m_space |= (uint64_t) (uint16_t) _mm_movemask_epi8(ws) << i;
+    }
+}
+
+/*! Fills the masks for one block, 32 characters at a time.
+ * \param block Pointer to SCANNER_BLOCK_SIZE characters.
+ * \param masks The masks to be filled.
+ */
+__attribute__((target("avx2")))
+static void ScanBlockAVX2(const char * block, CScanner::TMasks & masks) {
+    const __m256i open = _mm256_set1_epi8(60);
+    const __m256i close = _mm256_set1_epi8(62);
+    const __m256i space = _mm256_set1_epi8(32);
+    const __m256i tab = _mm256_set1_epi8(9);
+    const __m256i lf = _mm256_set1_epi8(10);
+    const __m256i cr = _mm256_set1_epi8(13);
+
+    masks.m_open = masks.m_close = masks.m_space = 0;
+    for (int i = 0; i < SCANNER_BLOCK_SIZE; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (block + i));
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(x, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)));
+        masks.m_open |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, open)) << i;
+        masks.m_close |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, close)) << i;
+        masks.m_space |= (uint64_t) (uint32_t) _mm256_movemask_epi8(ws) << i;
+    }
+}
+
+#endif
+
+/*! Chooses the best block scanner supported by the processor.
+ * \return Pointer to the block scanner.
+ */
+static TScanBlock ChooseScanBlock() {
+#ifdef SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return ScanBlockAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return ScanBlockSSE2;
+#endif
+    return ScanBlockScalar;
+}
+
+///! Block scanner chosen at runtime.
+static const TScanBlock BlockScanner = ChooseScanBlock();
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new scanner over given data, nothing is scanned yet.
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ */
+CScanner::CScanner(const char * data, size_t size) {
+    m_data = data;
+    m_size = size;
+    m_base = (size_t) -1;
+    m_masks.m_open = m_masks.m_close = m_masks.m_space = 0;
+}
+
+/*! Finds next < character.
+ * \param pos Position, where to start.
+ * \return Position of the character, or size of the data if there is none.
+ */
+size_t CScanner::FindTagStart(size_t pos) {
+    return Find(&TMasks::m_open, false, pos);
+}
+
+/*! Finds next > character.
+ * \param pos Position, where to start.
+ * \return Position of the character, or size of the data if there is none.
+ */
+size_t CScanner::FindTagEnd(size_t pos) {
+    return Find(&TMasks::m_close, false, pos);
+}
+
+/*! Ignores white spaces in the data.
+ * \param pos Position, where to start.
+ * \return Position after white spaces, or size of the data if there are only white spaces.
+ */
+size_t CScanner::SkipWhitespaces(size_t pos) {
+    return Find(&TMasks::m_space, true, pos);
+}
+
+/*! Ignores white spaces in any data (without remembering the blocks).
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ * \param pos Position, where to start.
+ * \return Position after white spaces, or size of the data if there are only white spaces.
+ */
+size_t CScanner::SkipWhitespaces(const char * data, size_t size, size_t pos) {
+    TMasks masks;
+    //whole blocks are scanned at once
+    while (pos + SCANNER_BLOCK_SIZE <= size) {
+        BlockScanner(data + pos, masks);
+        if (~masks.m_space)
+            return pos + __builtin_ctzll(~masks.m_space);
+        pos += SCANNER_BLOCK_SIZE;
+    }
+    //the rest is short
+    while (pos < size && (data[pos] == 32 || data[pos] == 10 || data[pos] == 9 || data[pos] == 13)) {
+        pos++;
+    }
+    return pos;
+}
+
+/*! Moves back over the white spaces in front of the position, there must be other character in front of them.
+ * \param pos Pointer to the data.
+ * \return Pointer to the first of the white spaces (pos, if there are none).
+ */
+const char * CScanner::SkipWhitespacesBack(const char * pos) {
+    while (pos[-1] == 32 || pos[-1] == 10 || pos[-1] == 9 || pos[-1] == 13) {
+        pos--;
+    }
+    return pos;
+}
+
+/*! Fills the masks for the block starting at given position.
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ * \param base Start of the block (multiple of SCANNER_BLOCK_SIZE).
+ * \param masks The masks to be filled.
+ */
+void CScanner::ScanBlock(const char * data, size_t size, size_t base, TMasks & masks) {
+    if (base + SCANNER_BLOCK_SIZE <= size) {
+        BlockScanner(data + base, masks);
+    } else {
+        //last block is copied, so nothing after the data is read
+        char block[SCANNER_BLOCK_SIZE];
+        memset(block, 0, SCANNER_BLOCK_SIZE);
+        memcpy(block, data + base, size - base);
+        BlockScanner(block, masks);
+    }
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Finds next position marked in given mask of the blocks.
+ * \param mask Which mask is used.
+ * \param inverse Look for unmarked positions instead.
+ * \param pos Position, where to start.
+ * \return Found position, or size of the data if there is none.
+ */
+size_t CScanner::Find(uint64_t TMasks::* mask, bool inverse, size_t pos) {
+    while (pos < m_size) {
+        size_t base = pos - pos % SCANNER_BLOCK_SIZE;
+        if (base != m_base)
+            LoadBlock(base);
+
+        uint64_t bits = inverse ? ~(m_masks.*mask) : m_masks.*mask;
+        bits &= ~(uint64_t) 0 << (pos - base); //ignore positions before pos
+        if (bits) {
+            pos = base + __builtin_ctzll(bits);
+            return pos < m_size ? pos : m_size;
+        }
+        pos = base + SCANNER_BLOCK_SIZE;
+    }
+    return m_size;
+}
+
+/*! Scans the block starting at given position.
+ * \param base Start of the block (multiple of SCANNER_BLOCK_SIZE).
+ */
+void CScanner::LoadBlock(size_t base) {
+    m_base = base;
+    ScanBlock(m_data, m_size, base, m_masks);
+}
@@ -0,0 +1,51 @@
+#ifndef CSCANNER_H
+#define	CSCANNER_H
+
+#include <cstdlib>
+#include <stdint.h>
+
+using namespace std;
+
+///! Size of the block, which is scanned at once.
+#define SCANNER_BLOCK_SIZE 64
+
+///! Class, which finds structural characters (< > and white spaces) in the file using SIMD instructions.
+
+class CScanner {
+public:
+    CScanner(const char * data, size_t size);
+
+    size_t FindTagStart(size_t pos);
+    size_t FindTagEnd(size_t pos);
+    size_t SkipWhitespaces(size_t pos);
+
+    static size_t SkipWhitespaces(const char * data, size_t size, size_t pos);
+    static const char * SkipWhitespacesBack(const char * pos);
+
+    ///! Bit masks of structural characters in one block, bit i is for i-th character.
+    struct TMasks {
+        ///! Positions of < characters
+        uint64_t m_open;
+        ///! Positions of > characters
+        uint64_t m_close;
+        ///! Positions of white spaces (SPACE, TAB, CR, LF)
+        uint64_t m_space;
+    };
+
+    static void ScanBlock(const char * data, size_t size, size_t base, TMasks & masks);
+protected:
+    size_t Find(uint64_t TMasks::* mask, bool inverse, size_t pos);
+    void LoadBlock(size_t base);
+
+    ///! Pointer to the scanned data
+    const char * m_data;
+    ///! Size of the scanned data
+    size_t m_size;
+    ///! Start of the currently loaded block
+    size_t m_base;
+    ///! Masks of the currently loaded block
+    TMasks m_masks;
+};
+
+#endif	/* CSCANNER_H */
+
@@ -0,0 +1,136 @@
+#include <cstdlib>
+
+#include "CStoreBuilder.h"
+
+///! Default size of the stack of open nodes
+#define DEFAULT_STACK_SIZE 32
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new builder.
+ * \param store Pointer to the empty store.
+ */
+CStoreBuilder::CStoreBuilder(CNodeStore * store) {
+    m_store = store;
+    m_parents = new int [DEFAULT_STACK_SIZE];
+    m_lasts = new int [DEFAULT_STACK_SIZE];
+    m_stackSize = DEFAULT_STACK_SIZE;
+    m_depth = 0;
+    m_current = -1;
+    m_started = -1;
+    m_ended = -1;
+}
+
+/*! Deallocates the stack.
+ */
+CStoreBuilder::~CStoreBuilder() {
+    delete [] m_parents;
+    delete [] m_lasts;
+}
+
+/*! Saves the version information to the store.
+ * \param data The whole version tag.
+ */
+void CStoreBuilder::VersionData(const CText & data) {
+    m_store->SetVersionData(data.GetString());
+}
+
+/*! Adds the node of started element.
+ * \param title Element title.
+ * \param attributes Element attributes.
+ * \param type Type of the element.
+ * \return Always true, the whole document is stored.
+ */
+bool CStoreBuilder::StartElement(const CText & title, const CAttributeList & attributes, int type) {
+    int node = AddNode(type, title);
+    for (int i = 0; i < attributes.GetCount(); i++)
+        m_store->AddAttribute(node, attributes.GetName(i), attributes.GetValue(i));
+
+    //next nodes will be childs of parent node
+    if (type == NEXT_IS_PARENTNODE) {
+        ReallocStack();
+        m_parents[m_depth] = node;
+        m_lasts[m_depth] = -1;
+        m_depth++;
+    } else
+        m_current = node;
+    m_started = node;
+    return true;
+}
+
+/*! Sets the value of started text node.
+ * \param value The text.
+ */
+void CStoreBuilder::Text(const CText & value) {
+    m_store->SetValue(m_current, value);
+}
+
+/*! Adds comment node.
+ * \param comment Comment text.
+ */
+void CStoreBuilder::Comment(const CText & comment) {
+    int node = AddNode(NEXT_IS_COMMENT, CText());
+    m_store->SetValue(node, comment);
+    m_started = m_ended = node;
+}
+
+/*! Ends the element, next nodes are added to its parent.
+ * \param title Element title.
+ */
+void CStoreBuilder::EndElement(const CText & title) {
+    if (m_current >= 0) {
+        m_ended = m_current;
+        m_current = -1;
+    } else
+        m_ended = m_parents[--m_depth];
+}
+
+/*! Remembers, where the nodes are in the source, so they are printed from it.
+ * \param markup The markup of the last read tag.
+ */
+void CStoreBuilder::Markup(const CText & markup) {
+    if (m_started >= 0)
+        m_store->StartSource(m_started, markup);
+    if (m_ended >= 0)
+        m_store->EndSource(m_ended, markup);
+    m_started = m_ended = -1;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Adds the node as the last child of current parent.
+ * \param kind Kind of the node.
+ * \param title Title of the node.
+ * \return Index of the node.
+ */
+int CStoreBuilder::AddNode(int kind, const CText & title) {
+    if (m_depth == 0)
+        return m_store->AddNode(kind, title, -1, -1);
+
+    int node = m_store->AddNode(kind, title, m_parents[m_depth - 1], m_lasts[m_depth - 1]);
+    m_lasts[m_depth - 1] = node;
+    return node;
+}
+
+/*! Stack memory management.
+ */
+void CStoreBuilder::ReallocStack() {
+    if (m_depth >= m_stackSize) {
+        int * tmpParents = new int [m_stackSize * REALLOC_CONSTANT];
+        int * tmpLasts = new int [m_stackSize * REALLOC_CONSTANT];
+        for (int i = 0; i < m_depth; i++) {
+            tmpParents[i] = m_parents[i];
+            tmpLasts[i] = m_lasts[i];
+        }
+
+        delete [] m_parents;
+        delete [] m_lasts;
+        m_parents = tmpParents;
+        m_lasts = tmpLasts;
+        m_stackSize *= REALLOC_CONSTANT;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef CSTOREBUILDER_H
+#define	CSTOREBUILDER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CNodeStore.h"
+#include "CText.h"
+#include "CXMLHandler.h"
+
+using namespace std;
+
+///! Class, which fills the flat node store from the events of the XML reader.
+
+class CStoreBuilder : public CXMLHandler {
+public:
+    CStoreBuilder(CNodeStore * store);
+    ~CStoreBuilder();
+
+    //events of the reader
+    virtual void VersionData(const CText & data);
+    virtual bool StartElement(const CText & title, const CAttributeList & attributes, int type);
+    virtual void Text(const CText & value);
+    virtual void Comment(const CText & comment);
+    virtual void EndElement(const CText & title);
+    virtual void Markup(const CText & markup);
+protected:
+    int AddNode(int kind, const CText & title);
+    void ReallocStack();
+
+    ///! Pointer to the filled store
+    CNodeStore * m_store;
+    ///! Stack of open parent nodes
+    int * m_parents;
+    ///! Last childs of open parent nodes (-1 if there is none yet)
+    int * m_lasts;
+    ///! Count of open parent nodes
+    int m_depth;
+    ///! Current max count of open parent nodes
+    int m_stackSize;
+    ///! Started text or simple node, which is not ended yet (-1 if there is none)
+    int m_current;
+    ///! The node, whose start tag was read last (its markup comes next), -1 if there is none
+    int m_started;
+    ///! The node, whose end tag was read last (its markup comes next), -1 if there is none
+    int m_ended;
+};
+
+#endif	/* CSTOREBUILDER_H */
+
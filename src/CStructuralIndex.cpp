@@ -0,0 +1,116 @@
+#include <cstdlib>
+#include <pthread.h>
+
+#include "CStructuralIndex.h"
+#include "CScanner.h"
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Indexes the whole data, every thread scans its own part of blocks.
+ * \param data Pointer to the data.
+ * \param size Size of the data.
+ * \param threads Count of threads to use.
+ */
+CStructuralIndex::CStructuralIndex(const char * data, size_t size, int threads) {
+    m_data = data;
+    m_size = size;
+    m_blocks = (size + SCANNER_BLOCK_SIZE - 1) / SCANNER_BLOCK_SIZE;
+    m_open = new uint64_t [m_blocks + 1];
+    m_close = new uint64_t [m_blocks + 1];
+
+    if (threads < 1)
+        threads = 1;
+    TJob * jobs = new TJob [threads];
+    pthread_t * ids = new pthread_t [threads];
+    size_t part = (m_blocks + threads - 1) / threads;
+
+    for (int i = 0; i < threads; i++) {
+        jobs[i].m_index = this;
+        jobs[i].m_from = part * i < m_blocks ? part * i : m_blocks;
+        jobs[i].m_to = part * (i + 1) < m_blocks ? part * (i + 1) : m_blocks;
+    }
+    int started = 1;
+    for (; started < threads; started++) {
+        if (pthread_create(&ids[started], NULL, BuildThread, &jobs[started]) != 0)
+            break;
+    }
+    //the first part is indexed by this thread
+    Build(jobs[0].m_from, jobs[0].m_to);
+    for (int i = 1; i < started; i++)
+        pthread_join(ids[i], NULL);
+    //if a thread could not be started, its part is indexed here
+    for (int i = started; i < threads; i++)
+        Build(jobs[i].m_from, jobs[i].m_to);
+
+    delete [] jobs;
+    delete [] ids;
+}
+
+/*! Frees the index.
+ */
+CStructuralIndex::~CStructuralIndex() {
+    delete [] m_open;
+    delete [] m_close;
+}
+
+/*! Finds next < character.
+ * \param pos Position, where to start.
+ * \return Position of the character, or size of the data if there is none.
+ */
+size_t CStructuralIndex::FindTagStart(size_t pos) const {
+    return Find(m_open, pos);
+}
+
+/*! Finds next > character.
+ * \param pos Position, where to start.
+ * \return Position of the character, or size of the data if there is none.
+ */
+size_t CStructuralIndex::FindTagEnd(size_t pos) const {
+    return Find(m_close, pos);
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Indexes given blocks.
+ * \param from First block.
+ * \param to Block after the last one.
+ */
+void CStructuralIndex::Build(size_t from, size_t to) {
+    CScanner::TMasks masks;
+    for (size_t i = from; i < to; i++) {
+        CScanner::ScanBlock(m_data, m_size, i * SCANNER_BLOCK_SIZE, masks);
+        m_open[i] = masks.m_open;
+        m_close[i] = masks.m_close;
+    }
+}
+
+/*! Finds next position marked in the bits.
+ * \param bits The index of the character.
+ * \param pos Position, where to start.
+ * \return Found position, or size of the data if there is none.
+ */
+size_t CStructuralIndex::Find(const uint64_t * bits, size_t pos) const {
+    if (pos >= m_size)
+        return m_size;
+
+    size_t block = pos / SCANNER_BLOCK_SIZE;
+    uint64_t word = bits[block] & (~(uint64_t) 0 << (pos % SCANNER_BLOCK_SIZE)); //ignore positions before pos
+    while (!word) {
+        if (++block >= m_blocks)
+            return m_size;
+        word = bits[block];
+    }
+    pos = block * SCANNER_BLOCK_SIZE + __builtin_ctzll(word);
+    return pos < m_size ? pos : m_size;
+}
+
+/*! Thread function, which indexes the blocks of one job.
+ * \param job Pointer to TJob.
+ */
+void * CStructuralIndex::BuildThread(void * job) {
+    TJob * j = (TJob *) job;
+    j->m_index->Build(j->m_from, j->m_to);
+    return NULL;
+}
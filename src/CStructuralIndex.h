@@ -0,0 +1,47 @@
+#ifndef CSTRUCTURALINDEX_H
+#define	CSTRUCTURALINDEX_H
+
+#include <cstdlib>
+#include <stdint.h>
+
+using namespace std;
+
+///! Class, which indexes positions of all < and > characters in the file (one bit per character).
+
+class CStructuralIndex {
+public:
+    CStructuralIndex(const char * data, size_t size, int threads);
+    ~CStructuralIndex();
+
+    size_t FindTagStart(size_t pos) const;
+    size_t FindTagEnd(size_t pos) const;
+protected:
+    void Build(size_t from, size_t to);
+    size_t Find(const uint64_t * bits, size_t pos) const;
+
+    static void * BuildThread(void * job);
+
+    ///! Structure, which specifies blocks indexed by one thread.
+    struct TJob {
+        ///! Pointer to the index
+        CStructuralIndex * m_index;
+        ///! First block
+        size_t m_from;
+        ///! Block after the last one
+        size_t m_to;
+    };
+
+    ///! Pointer to the indexed data
+    const char * m_data;
+    ///! Size of the indexed data
+    size_t m_size;
+    ///! Count of blocks (SCANNER_BLOCK_SIZE characters)
+    size_t m_blocks;
+    ///! Positions of < characters, one word per block
+    uint64_t * m_open;
+    ///! Positions of > characters, one word per block
+    uint64_t * m_close;
+};
+
+#endif	/* CSTRUCTURALINDEX_H */
+
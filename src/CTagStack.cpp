@@ -7,10 +7,10 @@
 
 /********************* PUBLIC METHODS *******************************/
 
-/*! Creates and allocates new string stack.
+/*! Creates and allocates new text stack.
  */
 CTagStack::CTagStack(){
-    m_stack = new string [DEFAULT_STACK_SIZE];
+    m_stack = new CText [DEFAULT_STACK_SIZE];
     
     m_stackSize = DEFAULT_STACK_SIZE;
     m_stackCnt = 0;
@@ -22,20 +22,20 @@ CTagStack::~CTagStack(){
     delete [] m_stack;
 }
 
-/*! Insert new string on the top of the stack.
+/*! Insert new text on the top of the stack.
  * \param tag XML element title.
  */
-void CTagStack::Push(string& tag){
+void CTagStack::Push(const CText & tag){
     ReallocStack();
     m_stack[m_stackCnt++] = tag;
 }
 
-/*! Gets the string from the top of the stack.
+/*! Gets the text from the top of the stack.
  * \return XML element title from the top of the stack.
  */
-string CTagStack::Pop(){
+CText CTagStack::Pop(){
     if (m_stackCnt == 0){
-        return "0";
+        return CText("0", 1);
     }
     return m_stack[--m_stackCnt];
 }
@@ -53,7 +53,7 @@ int CTagStack::GetStackCnt() const{
  */
 void CTagStack::ReallocStack(){
     if (m_stackCnt > m_stackSize - 1) {
-        string * tmp = new string [m_stackSize * REALLOC_CONSTANT];
+        CText * tmp = new CText [m_stackSize * REALLOC_CONSTANT];
         for (int i = 0; i < m_stackCnt; i++) {
             tmp[i] = m_stack[i];
         }
@@ -4,24 +4,26 @@
 #include <cstdlib>
 #include <string>
 
+#include "CText.h"
+
 using namespace std;
 
-///! Class, which implements a simple strings stack.
+///! Class, which implements a simple texts stack.
 class CTagStack{
 public:
     CTagStack();
     ~CTagStack();
     
-    void Push(string & tag);
-    string Pop();
+    void Push(const CText & tag);
+    CText Pop();
     
     int GetStackCnt() const;
 protected:
     void ReallocStack();
     
     
-    ///! Array of strings representing the stack.
-    string * m_stack;
+    ///! Array of texts representing the stack.
+    CText * m_stack;
     ///! Current max stack element count.
     int m_stackSize;
     ///! Count of elements in stack.
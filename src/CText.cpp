@@ -0,0 +1,204 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "CText.h"
+
+using namespace std;
+
+///! Mark of the texts copied to an arena, they are not owned by the text, but they are released by their node
+static string s_stored;
+#define TEXT_STORED (&s_stored)
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty text.
+ */
+CText::CText() {
+    m_data = "";
+    m_length = 0;
+    m_owned = NULL;
+}
+
+/*! Creates new text pointing to given characters (they are not copied).
+ * \param data Pointer to the first character, it must live as long as the text.
+ * \param length Count of characters.
+ */
+CText::CText(const char * data, size_t length) {
+    m_data = data;
+    m_length = length;
+    m_owned = NULL;
+}
+
+/*! Creates new text with its own copy of given string.
+ * \param str String to be copied.
+ */
+CText::CText(const string & str) {
+    m_owned = new string(str);
+    m_data = m_owned->data();
+    m_length = m_owned->length();
+}
+
+/*! Copies the text, own copy is copied again, pointer to the file (or to an arena) is shared.
+ * \param text Text to be copied.
+ */
+CText::CText(const CText & text) {
+    if (!text.IsView()) {
+        m_owned = new string(*text.m_owned);
+        m_data = m_owned->data();
+    } else {
+        m_owned = text.m_owned;
+        m_data = text.m_data;
+    }
+    m_length = text.m_length;
+}
+
+/*! Frees own copy of the text.
+ */
+CText::~CText() {
+    if (!IsView())
+        delete m_owned;
+}
+
+/*! Assigns the text, own copy is copied again, pointer to the file (or to an arena) is shared.
+ * \param text Text to be assigned.
+ */
+CText & CText::operator =(const CText & text) {
+    if (this == &text)
+        return *this;
+
+    if (!IsView())
+        delete m_owned;
+    if (!text.IsView()) {
+        m_owned = new string(*text.m_owned);
+        m_data = m_owned->data();
+    } else {
+        m_owned = text.m_owned;
+        m_data = text.m_data;
+    }
+    m_length = text.m_length;
+    return *this;
+}
+
+/********************* GETTERS *******************************/
+
+/*! Gets the pointer to the first character, the text does not have to end with zero.
+ */
+const char * CText::GetData() const {
+    return m_data;
+}
+
+/*! Gets the count of characters.
+ */
+size_t CText::GetLength() const {
+    return m_length;
+}
+
+/*! Gets the copy of the text.
+ */
+string CText::GetString() const {
+    return string(m_data, m_length);
+}
+
+/*! Finds out, if the text still points to the loaded file (or to an arena).
+ */
+bool CText::IsView() const {
+    return m_owned == NULL || m_owned == TEXT_STORED;
+}
+
+/*! Finds out, if the text points to a copy in an arena, which is released by its node.
+ */
+bool CText::IsStored() const {
+    return m_owned == TEXT_STORED;
+}
+
+/********************* SETTERS *******************************/
+
+/*! Sets new text, it is always copied.
+ * \param str New text.
+ */
+void CText::Set(const string & str) {
+    if (!IsView())
+        *m_owned = str;
+    else
+        m_owned = new string(str);
+    m_data = m_owned->data();
+    m_length = m_owned->length();
+}
+
+/*! Marks the text pointing to its copy in an arena (made by CArena::Copy).
+ */
+void CText::SetStored() {
+    if (IsView())
+        m_owned = TEXT_STORED;
+}
+
+/********************* TOOLS *******************************/
+
+/*! Gets the part of the text, it points to the file, if this text does.
+ * \param from Position of the first character.
+ * \param length Count of characters.
+ * \return The part of the text.
+ */
+CText CText::Sub(size_t from, size_t length) const {
+    if (from > m_length)
+        from = m_length;
+    if (length > m_length - from)
+        length = m_length - from;
+
+    if (!IsView())
+        return CText(m_owned->substr(from, length));
+    return CText(m_data + from, length);
+}
+
+/*! Appends the text to the end of given string.
+ * \param str String, where the text is appended.
+ */
+void CText::AppendTo(string & str) const {
+    str.append(m_data, m_length);
+}
+
+/*! Compares the text with given characters (like string::compare).
+ * \param data Pointer to the first character.
+ * \param length Count of characters.
+ * \return Negative, zero or positive number, if the text is smaller, same or bigger.
+ */
+int CText::Compare(const char * data, size_t length) const {
+    size_t shorter = m_length < length ? m_length : length;
+    int ret = shorter ? memcmp(m_data, data, shorter) : 0;
+    if (ret != 0)
+        return ret;
+    if (m_length < length)
+        return -1;
+    if (m_length > length)
+        return 1;
+    return 0;
+}
+
+/*! Compares the text with other text.
+ * \param text Other text.
+ */
+int CText::Compare(const CText & text) const {
+    return Compare(text.m_data, text.m_length);
+}
+
+/*! Compares the text with a string.
+ * \param str The string.
+ */
+int CText::Compare(const string & str) const {
+    return Compare(str.data(), str.length());
+}
+
+/*! Finds out, if the texts are same.
+ * \param text Other text.
+ */
+bool CText::operator ==(const CText & text) const {
+    return m_length == text.m_length && Compare(text) == 0;
+}
+
+/*! Finds out, if the texts are different.
+ * \param text Other text.
+ */
+bool CText::operator !=(const CText & text) const {
+    return !(*this == text);
+}
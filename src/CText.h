@@ -0,0 +1,50 @@
+#ifndef CTEXT_H
+#define	CTEXT_H
+
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+///! Class for text, which points to the loaded file, until it is edited and gets its own copy.
+
+class CText {
+public:
+    CText();
+    CText(const char * data, size_t length);
+    CText(const string & str);
+    CText(const CText & text);
+    ~CText();
+    CText & operator =(const CText & text);
+
+    //getters
+    const char * GetData() const;
+    size_t GetLength() const;
+    string GetString() const;
+    bool IsView() const;
+    bool IsStored() const;
+
+    //setters
+    void Set(const string & str);
+    void SetStored();
+
+    //tools
+    CText Sub(size_t from, size_t length) const;
+    void AppendTo(string & str) const;
+    int Compare(const char * data, size_t length) const;
+    int Compare(const CText & text) const;
+    int Compare(const string & str) const;
+
+    bool operator ==(const CText & text) const;
+    bool operator !=(const CText & text) const;
+protected:
+    ///! Pointer to the first character (into the file, or into own copy)
+    const char * m_data;
+    ///! Count of characters
+    size_t m_length;
+    ///! Own copy of the text, NULL if the text points to the file (or TEXT_STORED, if it points to an arena)
+    string * m_owned;
+};
+
+#endif	/* CTEXT_H */
+
@@ -0,0 +1,117 @@
+#include <cstdlib>
+
+#include "CTitleIndex.h"
+#include "CNode.h"
+
+using namespace std;
+
+///! Default count of lists
+#define DEFAULT_LISTS_COUNT 64
+///! Default count of nodes in one list
+#define DEFAULT_NODES_COUNT 4
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new empty index.
+ */
+CTitleIndex::CTitleIndex() {
+    m_lists = NULL;
+    m_cntLists = 0;
+}
+
+/*! Deletes all the lists, the nodes are not indexed any more.
+ */
+CTitleIndex::~CTitleIndex() {
+    for (int i = 0; i < m_cntLists; i++) {
+        for (int j = 0; j < m_lists[i].m_cnt; j++)
+            m_lists[i].m_nodes[j]->SetIndexPosition(-1);
+        delete [] m_lists[i].m_nodes;
+    }
+    delete [] m_lists;
+}
+
+/*! Inserts a node to the list of its title, indexed node is not inserted again.
+ * \param title Atom of the title.
+ * \param node Pointer to the XML node.
+ */
+void CTitleIndex::Insert(int title, CNode * node) {
+    if (node->GetIndexPosition() >= 0)
+        return;
+
+    ReallocLists(title);
+    TList & list = m_lists[title];
+    if (list.m_cnt >= list.m_size) {
+        int size = list.m_size ? list.m_size * REALLOC_CONSTANT : DEFAULT_NODES_COUNT;
+        CNode ** tmp = new CNode * [size];
+        for (int i = 0; i < list.m_cnt; i++) {
+            tmp[i] = list.m_nodes[i];
+        }
+
+        delete [] list.m_nodes;
+        list.m_nodes = tmp;
+        list.m_size = size;
+    }
+    node->SetIndexPosition(list.m_cnt);
+    list.m_nodes[list.m_cnt++] = node;
+}
+
+/*! Removes a node from the list of its title, the last node of the list takes its place.
+ * \param title Atom of the title, under which the node was inserted.
+ * \param node Pointer to the XML node.
+ */
+void CTitleIndex::Remove(int title, CNode * node) {
+    int position = node->GetIndexPosition();
+    if (position < 0)
+        return;
+
+    TList & list = m_lists[title];
+    CNode * last = list.m_nodes[--list.m_cnt];
+    list.m_nodes[position] = last;
+    last->SetIndexPosition(position);
+    node->SetIndexPosition(-1);
+}
+
+/*! Expands the nodes with given title all the way up to the root.
+ * \param title Atom of the title.
+ */
+void CTitleIndex::Filter(int title) {
+    if (title < 0 || title >= m_cntLists)
+        return;
+
+    TList & list = m_lists[title];
+    for (int i = 0; i < list.m_cnt; i++) {
+        list.m_nodes[i]->ExpandAll();
+        if (list.m_nodes[i]->GetParent())
+            list.m_nodes[i]->GetParent()->ExpandUp();
+    }
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Lists memory management, ensures that there is a list for the title.
+ * \param title Atom of the title.
+ */
+void CTitleIndex::ReallocLists(int title) {
+    if (title >= m_cntLists) {
+        int cnt = m_cntLists ? m_cntLists : DEFAULT_LISTS_COUNT;
+        while (cnt <= title)
+            cnt *= REALLOC_CONSTANT;
+
+        TList * tmp = new TList [cnt];
+        for (int i = 0; i < cnt; i++) {
+            if (i < m_cntLists) {
+                tmp[i] = m_lists[i];
+            } else {
+                tmp[i].m_nodes = NULL;
+                tmp[i].m_size = 0;
+                tmp[i].m_cnt = 0;
+            }
+        }
+
+        delete [] m_lists;
+        m_lists = tmp;
+        m_cntLists = cnt;
+    }
+}
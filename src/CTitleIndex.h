@@ -0,0 +1,42 @@
+#ifndef CTITLEINDEX_H
+#define	CTITLEINDEX_H
+
+#include <cstdlib>
+#include <string>
+
+class CNode;
+
+using namespace std;
+
+///! Class, which finds the nodes by the atoms of their titles. Atoms are small numbers,
+///! so they index an array of lists of nodes directly. Every node knows its position in its list,
+///! so it is removed without searching, when it is deleted or renamed.
+class CTitleIndex {
+public:
+    CTitleIndex();
+    ~CTitleIndex();
+    void Insert(int title, CNode * node);
+    void Remove(int title, CNode * node);
+    void Filter(int title);
+
+protected:
+    void ReallocLists(int title);
+
+    ///! Structure, which represents the list of nodes with one title.
+    struct TList {
+        ///! Pointers to XML nodes with the title (in no order)
+        CNode ** m_nodes;
+        ///! Current max count of XML nodes pointers
+        int m_size;
+        ///! Count of XML nodes pointers
+        int m_cnt;
+    };
+
+    ///! Lists of nodes, index is the atom of the title
+    TList * m_lists;
+    ///! Count of lists
+    int m_cntLists;
+};
+
+#endif	/* CTITLEINDEX_H */
+
@@ -0,0 +1,259 @@
+#include <cstdlib>
+
+#include "CTreeBuilder.h"
+#include "CException.h"
+
+///! Default count of atoms
+#define DEFAULT_ATOMS_SIZE 64
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+///! Count of nodes, after which the progress is updated (and the complete part of the tree is published)
+#define PROGRESS_STEP 1024
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new builder.
+ * \param parent Pointer to the node, where built nodes are inserted, NULL if the first node is the root.
+ * \param arena Pointer to the arena, where nodes are allocated.
+ */
+CTreeBuilder::CTreeBuilder(CNode * parent, CArena * arena) {
+    m_arena = arena;
+    m_root = NULL;
+    m_previous = parent;
+    m_current = NULL;
+    m_started = NULL;
+    m_ended = NULL;
+    m_lazyPath = NULL;
+    m_isCopying = false;
+    m_progress = NULL;
+    m_position = 0;
+    m_cntNodes = 0;
+    m_cntComplete = 0;
+
+    m_atoms = new int [DEFAULT_ATOMS_SIZE];
+    m_atomsSize = DEFAULT_ATOMS_SIZE;
+}
+
+/*! Deallocates the atoms.
+ */
+CTreeBuilder::~CTreeBuilder() {
+    delete [] m_atoms;
+}
+
+/*! Gets the root of built tree.
+ * \return Pointer to the root, NULL if there is none.
+ */
+CNode * CTreeBuilder::GetRoot() const {
+    return m_root;
+}
+
+/*! Gets the version information of the document.
+ */
+string CTreeBuilder::GetVersionData() const {
+    return m_versionData;
+}
+
+/*! Parent childs of the root won't be parsed now, they are parsed when they are expanded.
+ * \param filePath File name (for exceptions), it must exist as long as the tree.
+ */
+void CTreeBuilder::SetLazy(const string * filePath) {
+    m_lazyPath = filePath;
+}
+
+/*! Texts will be copied to the arena, because the data are freed after the tags are read (like data
+ * of the push reader). The nodes do not remember their source then, so they are printed again, when they are saved.
+ * \param isCopying Are the texts copied?
+ */
+void CTreeBuilder::SetCopying(bool isCopying) {
+    m_isCopying = isCopying;
+}
+
+/*! Parsed bytes and nodes will be counted, a builder of the whole document also publishes its complete part.
+ * \param progress Pointer to the progress of the loading.
+ * \param position Position in the data, where the parsing starts.
+ */
+void CTreeBuilder::SetProgress(CProgress * progress, size_t position) {
+    m_progress = progress;
+    m_position = position;
+}
+
+/*! Saves the version information.
+ * \param data The whole version tag.
+ */
+void CTreeBuilder::VersionData(const CText & data) {
+    m_versionData = data.GetString();
+}
+
+/*! Creates the node of started element.
+ * \param title Element title.
+ * \param attributes Element attributes.
+ * \param type Type of the element.
+ * \return False, if the content of the element is not parsed now.
+ */
+bool CTreeBuilder::StartElement(const CText & title, const CAttributeList & attributes, int type) {
+    //in lazy mode, childs of the root are only skipped
+    bool parseContent = m_lazyPath == NULL || type != NEXT_IS_PARENTNODE || m_root == NULL || m_previous != m_root;
+
+    //the reader has checked the title
+    int name = GetAtom(title);
+    CNode * node;
+    if (type == NEXT_IS_PARENTNODE)
+        node = new (m_arena) CParentNode(name);
+    else if (type == NEXT_IS_TEXTNODE)
+        node = new (m_arena) CTextNode(name, CText());
+    else
+        node = new (m_arena) CSimpleNode(name);
+
+    InsertAttributes(node, attributes);
+    InsertNode(node);
+    m_cntNodes++;
+
+    //next nodes will be childs of parent node
+    if (type == NEXT_IS_PARENTNODE)
+        m_previous = node;
+    else
+        m_current = node;
+    m_started = node;
+    return parseContent;
+}
+
+/*! Sets the value of started text node.
+ * \param value The text.
+ */
+void CTreeBuilder::Text(const CText & value) {
+    ((CTextNode *) m_current)->SetValue(m_isCopying ? m_arena->Copy(value) : value);
+}
+
+/*! Creates comment node.
+ * \param comment Comment text.
+ */
+void CTreeBuilder::Comment(const CText & comment) {
+    CNode * node = new (m_arena) CCommentNode(m_isCopying ? m_arena->Copy(comment) : comment);
+    InsertNode(node);
+    m_started = m_ended = node;
+    m_cntNodes++;
+    if (m_root != NULL && m_previous == m_root)
+        m_cntComplete++;
+}
+
+/*! Saves the skipped childs of current parent node, they are parsed when it is expanded.
+ * \param content The data of the childs.
+ */
+void CTreeBuilder::Skipped(const CText & content) {
+    ((CParentNode *) m_previous)->SetLazy(content, m_lazyPath);
+}
+
+/*! Ends the element, next nodes are inserted to its parent.
+ * \param title Element title.
+ */
+void CTreeBuilder::EndElement(const CText & title) {
+    CNode * node;
+    if (m_current != NULL) {
+        node = m_current;
+        m_current = NULL;
+    } else {
+        node = m_previous;
+        m_previous = m_previous->GetParent();
+    }
+    m_ended = node;
+    if (m_root != NULL && node->GetParent() == m_root)
+        m_cntComplete++;
+}
+
+/*! Remembers, where the nodes are in the data, so unchanged nodes are saved as they are.
+ * \param markup The markup of the last read tag.
+ */
+void CTreeBuilder::Markup(const CText & markup) {
+    if (m_isCopying) {
+        m_started = m_ended = NULL;
+        return;
+    }
+    if (m_started != NULL)
+        m_started->StartSource(markup);
+    if (m_ended != NULL)
+        m_ended->EndSource(markup);
+    m_started = m_ended = NULL;
+}
+
+/*! Counts parsed bytes and nodes after every few nodes and lets the interface see the complete childs of the root.
+ * \param pos Position in the data after the last tag.
+ */
+void CTreeBuilder::Position(size_t pos) {
+    if (m_progress == NULL || m_cntNodes < PROGRESS_STEP)
+        return;
+
+    bool running = m_progress->Add(pos - m_position, m_cntNodes);
+    m_position = pos;
+    m_cntNodes = 0;
+    if (!running)
+        throw LoadingCanceledException();
+    if (m_root != NULL)
+        m_progress->Publish(m_root, m_cntComplete);
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Gets the atom of the name in the document, the names of the document are locked only for new names.
+ * \param name The name.
+ */
+int CTreeBuilder::GetAtom(const CText & name) {
+    int local = m_localAtoms.Find(name);
+    if (local < 0) {
+        local = m_localAtoms.Add(name);
+        ReallocAtoms();
+        m_atoms[local] = m_arena->GetAtoms()->Add(name);
+    }
+    return m_atoms[local];
+}
+
+/*! Atoms memory management.
+ */
+void CTreeBuilder::ReallocAtoms() {
+    if (m_localAtoms.GetCount() > m_atomsSize) {
+        int * tmp = new int [m_atomsSize * REALLOC_CONSTANT];
+        for (int i = 0; i < m_atomsSize; i++) {
+            tmp[i] = m_atoms[i];
+        }
+
+        delete [] m_atoms;
+        m_atoms = tmp;
+        m_atomsSize *= REALLOC_CONSTANT;
+    }
+}
+
+/*! Inserts the node to current parent, or makes it the root.
+ * \param node Pointer to the node.
+ */
+void CTreeBuilder::InsertNode(CNode * node) {
+    node->SetParent(m_previous);
+    if (m_previous != NULL) {
+        //the parent does not change, the node is read from its data
+        ((CParentNode *) m_previous)->AppendChild(node);
+    } else if (m_root == NULL) {
+        m_root = node;
+    }
+}
+
+/*! Adds attributes to a node, which is not inserted in the tree yet, so it is deleted, if they are not valid.
+ * \param node Pointer to the node.
+ * \param attributes The attributes.
+ */
+void CTreeBuilder::InsertAttributes(CNode * node, const CAttributeList & attributes) {
+    try {
+        for (int i = 0; i < attributes.GetCount(); i++) {
+            CText value = m_isCopying ? m_arena->Copy(attributes.GetValue(i)) : attributes.GetValue(i);
+            CAttribute * attribute = new (m_arena) CAttribute(GetAtom(attributes.GetName(i)), value);
+            try {
+                node->InsertAttribute(attribute);
+            } catch (const CException & e) {
+                delete attribute;
+                throw;
+            }
+        }
+    } catch (const CException & e) {
+        delete node;
+        throw;
+    }
+}
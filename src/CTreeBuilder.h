@@ -0,0 +1,79 @@
+#ifndef CTREEBUILDER_H
+#define	CTREEBUILDER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CArena.h"
+#include "CAtomTable.h"
+#include "CNode.h"
+#include "CProgress.h"
+#include "CText.h"
+#include "CXMLHandler.h"
+
+using namespace std;
+
+///! Class, which builds a tree of nodes from the events of the XML reader.
+
+class CTreeBuilder : public CXMLHandler {
+public:
+    CTreeBuilder(CNode * parent, CArena * arena);
+    ~CTreeBuilder();
+
+    CNode * GetRoot() const;
+    string GetVersionData() const;
+    void SetLazy(const string * filePath);
+    void SetCopying(bool isCopying);
+    void SetProgress(CProgress * progress, size_t position);
+
+    //events of the reader
+    virtual void VersionData(const CText & data);
+    virtual bool StartElement(const CText & title, const CAttributeList & attributes, int type);
+    virtual void Text(const CText & value);
+    virtual void Comment(const CText & comment);
+    virtual void Skipped(const CText & content);
+    virtual void EndElement(const CText & title);
+    virtual void Markup(const CText & markup);
+    virtual void Position(size_t pos);
+protected:
+    int GetAtom(const CText & name);
+    void ReallocAtoms();
+    void InsertNode(CNode * node);
+    void InsertAttributes(CNode * node, const CAttributeList & attributes);
+
+    ///! Pointer to the arena, where nodes are allocated
+    CArena * m_arena;
+    ///! Names seen by this builder (the names of the document are locked, when they are changed)
+    CAtomTable m_localAtoms;
+    ///! Atoms of the document for the local atoms
+    int * m_atoms;
+    ///! Current max count of the atoms
+    int m_atomsSize;
+    ///! Pointer to the root of the tree, NULL if nodes are inserted to given parent
+    CNode * m_root;
+    ///! Pointer to current parent
+    CNode * m_previous;
+    ///! Pointer to started text or simple node, which is not ended yet
+    CNode * m_current;
+    ///! Pointer to the node, whose start tag was read last (its markup comes next)
+    CNode * m_started;
+    ///! Pointer to the node, whose end tag was read last (its markup comes next)
+    CNode * m_ended;
+    ///! XML version information
+    string m_versionData;
+    ///! File name for parsing the childs of the root later, NULL if everything is parsed now
+    const string * m_lazyPath;
+    ///! Are the texts copied to the arena (the data do not stay), so the nodes have no source?
+    bool m_isCopying;
+    ///! Progress of the loading, NULL if nothing is counted
+    CProgress * m_progress;
+    ///! Position in the data, where the counted bytes end
+    size_t m_position;
+    ///! Count of nodes, which are not counted in the progress yet
+    int m_cntNodes;
+    ///! Count of childs of the root, which are complete
+    int m_cntComplete;
+};
+
+#endif	/* CTREEBUILDER_H */
+
@@ -0,0 +1,161 @@
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+
+#include "CWorkPool.h"
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates the pool, the threads are started with the tasks.
+ * \param threads Count of threads (at least 1).
+ */
+CWorkPool::CWorkPool(int threads) {
+    m_cntWorkers = threads > 0 ? threads : 1;
+    m_workers = new TWorker [m_cntWorkers];
+    for (int i = 0; i < m_cntWorkers; i++) {
+        m_workers[i].m_pool = this;
+        pthread_mutex_init(&m_workers[i].m_lock, NULL);
+        m_workers[i].m_tasks = NULL;
+        m_workers[i].m_head = 0;
+        m_workers[i].m_tail = 0;
+        m_workers[i].m_started = false;
+    }
+    m_task = NULL;
+    m_context = NULL;
+}
+
+/*! Waits for the threads and frees the queues.
+ */
+CWorkPool::~CWorkPool() {
+    Join();
+    for (int i = 0; i < m_cntWorkers; i++) {
+        pthread_mutex_destroy(&m_workers[i].m_lock);
+        delete [] m_workers[i].m_tasks;
+    }
+    delete [] m_workers;
+}
+
+/*! Deals the tasks to the queues and starts the threads, they do the tasks meanwhile.
+ * Queues of threads, which could not be started, are stolen by the others. If no thread could be started,
+ * all the tasks are done here.
+ * \param cntTasks Count of the tasks.
+ * \param task Function doing one task, it is called by more threads at once.
+ * \param context Context given to the function.
+ */
+void CWorkPool::Start(int cntTasks, TTask task, void * context) {
+    m_task = task;
+    m_context = context;
+    for (int i = 0; i < m_cntWorkers; i++) {
+        TWorker & worker = m_workers[i];
+        worker.m_tasks = new int [cntTasks / m_cntWorkers + 1];
+        worker.m_head = worker.m_tail = 0;
+        for (int j = i; j < cntTasks; j += m_cntWorkers)
+            worker.m_tasks[worker.m_tail++] = j;
+    }
+
+    int started = 0;
+    for (int i = 0; i < m_cntWorkers; i++) {
+        m_workers[i].m_started = pthread_create(&m_workers[i].m_thread, NULL, WorkerThread, &m_workers[i]) == 0;
+        if (m_workers[i].m_started)
+            started++;
+    }
+    if (!started)
+        WorkerThread(&m_workers[0]);
+}
+
+/*! Waits, until all the tasks are done.
+ */
+void CWorkPool::Join() {
+    for (int i = 0; i < m_cntWorkers; i++) {
+        if (m_workers[i].m_started) {
+            pthread_join(m_workers[i].m_thread, NULL);
+            m_workers[i].m_started = false;
+        }
+    }
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Thread function, which does the tasks of its queue and then steals the tasks of the others,
+ * it ends, when there is no task left.
+ * \param worker Pointer to the TWorker.
+ */
+void * CWorkPool::WorkerThread(void * worker) {
+    TWorker * self = (TWorker *) worker;
+    CWorkPool * pool = self->m_pool;
+    int task;
+    while (true) {
+        //stolen tasks may be stolen again, before they are taken
+        if (!pool->Take(self, task)) {
+            if (!pool->Steal(self))
+                break;
+            continue;
+        }
+        pool->m_task(pool->m_context, task);
+    }
+    return NULL;
+}
+
+/*! Takes the next task of the queue.
+ * \param worker The thread.
+ * \param task The task is stored here.
+ * \return False, if the queue is empty.
+ */
+bool CWorkPool::Take(TWorker * worker, int & task) {
+    pthread_mutex_lock(&worker->m_lock);
+    bool isTaken = worker->m_head < worker->m_tail;
+    if (isTaken)
+        task = worker->m_tasks[worker->m_head++];
+    pthread_mutex_unlock(&worker->m_lock);
+    return isTaken;
+}
+
+/*! Moves the first half of the longest queue to the empty queue of the thief.
+ * The first tasks are stolen, so the tasks are still done nearly in order.
+ * \param thief The thread with empty queue.
+ * \return False, if all the queues are empty (the tasks do not make new tasks, so the work is done).
+ */
+bool CWorkPool::Steal(TWorker * thief) {
+    while (true) {
+        TWorker * victim = NULL;
+        int longest = 0;
+        for (int i = 0; i < m_cntWorkers; i++) {
+            TWorker * worker = &m_workers[i];
+            if (worker == thief)
+                continue;
+            pthread_mutex_lock(&worker->m_lock);
+            int count = worker->m_tail - worker->m_head;
+            pthread_mutex_unlock(&worker->m_lock);
+            if (count > longest) {
+                longest = count;
+                victim = worker;
+            }
+        }
+        if (victim == NULL)
+            return false;
+
+        //the victim may have done its tasks meanwhile, then other queue is tried
+        pthread_mutex_lock(&victim->m_lock);
+        int count = (victim->m_tail - victim->m_head + 1) / 2;
+        int * stolen = NULL;
+        if (count > 0) {
+            stolen = new int [count];
+            memcpy(stolen, victim->m_tasks + victim->m_head, count * sizeof (int));
+            victim->m_head += count;
+        }
+        pthread_mutex_unlock(&victim->m_lock);
+        if (stolen == NULL)
+            continue;
+
+        //only the thief fills its queue
+        pthread_mutex_lock(&thief->m_lock);
+        delete [] thief->m_tasks;
+        thief->m_tasks = stolen;
+        thief->m_head = 0;
+        thief->m_tail = count;
+        pthread_mutex_unlock(&thief->m_lock);
+        return true;
+    }
+}
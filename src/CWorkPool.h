@@ -0,0 +1,57 @@
+#ifndef CWORKPOOL_H
+#define	CWORKPOOL_H
+
+#include <cstdlib>
+#include <pthread.h>
+
+using namespace std;
+
+///! Class, which does independent tasks (numbered from 0) by more threads. Each thread has its own queue
+///! of tasks, the tasks are dealt round, so the threads go through them nearly in order. Thread, whose queue
+///! is empty, steals the first half of the longest queue of other thread.
+
+class CWorkPool {
+public:
+    ///! Function, which does one task.
+    typedef void (*TTask)(void * context, int task);
+
+    CWorkPool(int threads);
+    ~CWorkPool();
+
+    void Start(int cntTasks, TTask task, void * context);
+    void Join();
+protected:
+    ///! Structure of one thread of the pool with its queue of tasks.
+    struct TWorker {
+        ///! The pool
+        CWorkPool * m_pool;
+        ///! Lock of the queue
+        pthread_mutex_t m_lock;
+        ///! The queue of tasks
+        int * m_tasks;
+        ///! Index of the next task in the queue
+        int m_head;
+        ///! Index after the last task in the queue
+        int m_tail;
+        ///! The thread
+        pthread_t m_thread;
+        ///! Was the thread started?
+        bool m_started;
+    };
+
+    static void * WorkerThread(void * worker);
+    bool Take(TWorker * worker, int & task);
+    bool Steal(TWorker * thief);
+
+    ///! Threads of the pool
+    TWorker * m_workers;
+    ///! Count of threads
+    int m_cntWorkers;
+    ///! Function doing the tasks
+    TTask m_task;
+    ///! Context given to the function
+    void * m_context;
+};
+
+#endif	/* CWORKPOOL_H */
+
@@ -1,405 +1,527 @@
-#include <fstream>
 #include <cstdlib>
+#include <cstdio>
+#include <exception>
 
 #include "CXML.h"
 #include "CException.h"
 #include "functions.h"
+#include "CParser.h"
+#include "CXMLWriter.h"
+#include "CImage.h"
+#include "CImageWriter.h"
 
 ///! When reallocing, how many times will new array will be bigger
 #define REALLOC_CONSTANT 2
-
-///! Specifies that next node is text node.
-#define NEXT_IS_TEXTNODE 0
-///! Specifies that next node is parent node.
-#define NEXT_IS_PARENTNODE 1
-///! Specifies that next node is comment node.
-#define NEXT_IS_COMMENT 2
-///! Specifies that next node is simple node.
-#define NEXT_IS_SIMPLE 3
-///! Specifies that next node is end node.
-#define NEXT_IS_ENDTAG 4
-///! Specifies that parser reached end of file.
-#define END_OF_FILE -1
+///! Images are used only for bigger files, smaller files are parsed fast enough
+#define IMAGE_MIN_SIZE (8 * 1024 * 1024)
 
 using namespace std;
 
 /********************* PUBLIC METHODS *******************************/
 
-/*! Loads XML file to memory and starts the parsing into a tree.
+/*! Starts loading of XML file by the loading thread, the file is mapped to memory and parsed into a tree there.
+ * The thread owns the document, until it is loaded, the interface sees only its complete part meanwhile.
+ * The document does not know the interface, so it is used also without it.
  * \param filePath Specifies file to open.
- * \param interface Pointer to graphic interface.
  */
-CXML::CXML(string & filePath, CGUI * interface){
-    m_interface = interface;
-    m_interface->AddXML(this); //tells the interface about XML file
-
+CXML::CXML(string & filePath){
     m_root = NULL;
-    m_titlesSearchTree = NULL;
+    m_titlesIndex = NULL;
+    m_source = NULL;
+    m_compression = DECODER_NONE;
+    m_image = NULL;
+    m_rows = new CRowList();
     
     m_filePath = filePath;
-   
-    CNode * current = NULL;
-    CNode * previous = NULL;
-
-    //tries to open the file
-    ifstream file(filePath.c_str());
-    if (file.fail() || !file.is_open()) {
-        throw InvalidFileNameException(filePath);
+
+    //texts of the nodes will point to the mapped file
+    m_arena = new CArena();
+    m_atoms = new CAtomTable();
+    m_arena->SetAtoms(m_atoms);
+
+    m_snapshot = NULL;
+    m_savingProgress = NULL;
+    m_saving = false;
+    m_saved = false;
+
+    m_progress = new CProgress();
+    m_cntLoaded = 0;
+    m_loading = pthread_create(&m_loadingThread, NULL, LoadingThread, this) == 0;
+    //if the thread could not be started, the file is loaded here
+    if (!m_loading)
+        Load();
+}
+
+/*! Stops the loading, waits for the saving, removes the titles index, the whole XML tree is freed at once with its arena.
+ */
+CXML::~CXML() {
+    if (m_loading) {
+        m_progress->Cancel();
+        pthread_join(m_loadingThread, NULL);
     }
-    
-    //saves version data, if there are any
-    StoreVersionData(file);
-
-    //starts parsing XML
-    string * nextTag = new string("");
-    int nextTagType = TellTypeOfNextNode(file, nextTag);
-
-    //parsing continues until EOF, or when an format error is detected
-    while (nextTagType != END_OF_FILE) {
-        //ncurses has problems with characters outside ASCII table, so remove them
-        *nextTag = MakeASCII(*nextTag);
-        if (nextTagType == NEXT_IS_PARENTNODE) {
-            //get the title
-            string title = ExtractXMLTitle(*nextTag);
-            
-            //create new parent node
-            current = new CParentNode(title);
-            current->SetParent(previous);
-
-            m_stack.Push(title); //next end tag will have to be at the top of the stack
-
-            //parse attributes of this node
-            ParseAttributes(current, *nextTag);
-
-            //next tags will be childs of this node
-            previous = current;
-            
-            //if there is a parent, tell him, this is his child
-            if (current->GetParent() != NULL) {
-                current->GetParent()->InsertNode(current);
-            }
-        } else if (nextTagType == NEXT_IS_TEXTNODE) {
-            //get the title and value
-            string title = ExtractXMLTitle(*nextTag);
-            string value = ExtractTextNodeValue(file);
-            //make value only ASCII
-            value = MakeASCII(value);
-            
-            //create new text node
-            current = new CTextNode(title, value);
-            current->SetParent(previous);
-
-            //parse attributes of this node
-            ParseAttributes(current, *nextTag);
-
-            //insert this node to a possible parent
-            if (current->GetParent() != NULL) {
-                current->GetParent()->InsertNode(current);
-            }
-            //extract the end tag of the text node from the file stream
-            ExtractTextNodeEndTag(file, title);
-        } else if (nextTagType == NEXT_IS_COMMENT) {
-            //get the comment text
-            string value = ExtractCommentNodeValue(*nextTag);
-            
-            //make comment only ASCII
-            value = MakeASCII(value);
-            
-            //create new comment
-            current = new CCommentNode(value);
-            current->SetParent(previous);
-
-            //insert comment to a possible parent
-            if (current->GetParent() != NULL) {
-                current->GetParent()->InsertNode(current);
-            }
-        } else if (nextTagType == NEXT_IS_SIMPLE) {
-            //remove the '/' from the end of tag
-            nextTag->resize(nextTag->length() - 1);
-            
-            //get the title
-            string title = ExtractXMLTitle(*nextTag);
-            
-            //create new simple node
-            current = new CSimpleNode(title);       
-            current->SetParent(previous);
-
-            //parse attributes of this node
-            ParseAttributes(current, *nextTag);
-
-            //insert to a possible parent
-            if (current->GetParent() != NULL) {
-                current->GetParent()->InsertNode(current);
-            }
-        } else if (nextTagType == NEXT_IS_ENDTAG) {
-            //this endtag must be on the top of the stack, or it is an error!
-            //erase removes the '/' from the start of the tag
-            if (nextTag->erase(0, 1) != m_stack.Pop())
-                throw InvalidXMLFormatException(m_filePath);
-
-            //root end tag won't be read here, so stack cannot be free here
-            //there can be only one root element!
-            if (m_stack.GetStackCnt() == 0)
-                throw InvalidXMLFormatException(m_filePath);
-            
-            //inserting to this tag ends now
-            previous = previous->GetParent();
-        }
+    //the snapshot may point to the mapped file
+    FinishSaving();
+    delete m_titlesIndex;
+    delete m_arena;
+    delete m_atoms;
+    delete m_source;
+    delete m_image;
+    delete m_rows;
+    delete m_progress;
+}
 
-        //was it the first node?
-        if (m_root == NULL) {
-            m_root = current;
-        }
-        
-        //continue parsing...
-        nextTag->clear();
-        nextTagType = TellTypeOfNextNode(file, nextTag);
-        
-        //if root element is not parent, there can be only one element at all
-        if (nextTagType != END_OF_FILE && !m_root->HasChilds())
-            throw InvalidXMLFormatException(m_filePath);
+/********************* LOADING IN THE BACKGROUND *******************************/
+
+/*! Lists the rows of the childs of the root, which were completed by the loading thread since the last call.
+ * The caller must own the document.
+ */
+void CXML::ShowLoaded() {
+    CNode * root = m_progress->GetRoot();
+    if (root == NULL)
+        return;
+    if (!m_rows->GetCount())
+        m_rows->Add(root, 0);
+
+    //the last child of the root is not complete, its rows are listed later
+    int complete = m_progress->GetComplete();
+    if (root->HasChilds() && complete > m_cntLoaded)
+        ((CParentNode *) root)->ListChildRows(m_rows, 0, m_cntLoaded, complete);
+    m_cntLoaded = complete;
+}
+
+/*! Waits for the end of the loading thread and shows the whole tree, errors of the loading are thrown here.
+ */
+void CXML::FinishLoading() {
+    if (m_loading) {
+        pthread_join(m_loadingThread, NULL);
+        m_loading = false;
     }
 
-    //the file has ended, stack must be free (after poping the root...)
-    if (nextTag->erase(0, 1) != m_stack.Pop())
-        throw InvalidXMLFormatException(m_filePath);
-    if (m_stack.GetStackCnt() > 0) {
-        throw InvalidXMLFormatException(m_filePath);
+    //rows of the loaded part may point to freed nodes
+    m_rows->Clear();
+    m_cntLoaded = 0;
+    if (m_loadingError)
+        rethrow_exception(m_loadingError);
+    Show();
+}
+
+/*! Gets the progress of the loading, the interface reads it and uses it to own the document.
+ */
+CProgress * CXML::GetProgress() const {
+    return m_progress;
+}
+
+/********************* SAVING IN THE BACKGROUND *******************************/
+
+/*! Waits for the end of the saving thread and frees the snapshot.
+ * \return False, if the file could not be written (true, if nothing was saved).
+ */
+bool CXML::FinishSaving() {
+    if (m_snapshot == NULL)
+        return true;
+    if (m_saving) {
+        pthread_join(m_savingThread, NULL);
+        m_saving = false;
     }
-    delete nextTag;
+
+    delete m_snapshot;
+    delete m_savingProgress;
+    m_snapshot = NULL;
+    m_savingProgress = NULL;
+    return m_saved;
 }
 
-/*! Removes the whole XML tree and search tree.
+/*! Waits, until the saving thread has the snapshot of the tree, the tree must not change before.
+ * Nothing is waited for, if nothing is saved.
  */
-CXML::~CXML() {
-    delete m_root;
-    delete m_titlesSearchTree;
+void CXML::WaitForSnapshot() const {
+    if (m_savingProgress == NULL)
+        return;
+    m_savingProgress->Lock();
+    m_savingProgress->Unlock();
+}
+
+/*! Gets the progress of the saving, the interface reads it and finishes the saving, when the thread ends.
+ * \return Pointer to the progress, NULL if nothing is saved.
+ */
+CProgress * CXML::GetSavingProgress() const {
+    return m_savingProgress;
 }
 
 /********************* "PRINTING" TOOLS *******************************/
 
-/*! Sends the whole tree to GUI.
+/*! Lists the visible rows of the tree, the GUI asks for the texts of the rows it shows.
  */
 void CXML::Show() {
-    if (m_root) {
-        m_root->Print(m_interface, 0);
-        delete m_titlesSearchTree;
-        m_titlesSearchTree = new CSearchTree();
-        m_root->PrepareSearching(m_titlesSearchTree);
+    m_rows->Clear();
+    if (m_root)
+        m_root->ListRows(m_rows, 0);
+}
+
+/*! Expands the node of the row, rows of its newly visible descendants are inserted after it.
+ * \param row Index of the visible row.
+ */
+void CXML::ExpandRow(int row) {
+    CNode * node = m_rows->GetNode(row);
+    if (!node->IsCollapsed())
+        return;
+    //unparsed childs are parsed, the saving thread may be printing them
+    WaitForSnapshot();
+    node->Expand();
+
+    //the row of the node is replaced by the rows of its subtree
+    CRowList rows;
+    node->ListRows(&rows, m_rows->GetDepth(row));
+    m_rows->Remove(row, 1);
+    m_rows->Insert(row, rows);
+    if (node->GetParent())
+        node->GetParent()->ChangeRowCount(rows.GetCount() - 1);
+}
+
+/*! Collapses the node of the row, rows of its descendants are removed.
+ * \param row Index of the visible row.
+ */
+void CXML::CollapseRow(int row) {
+    CNode * node = m_rows->GetNode(row);
+    int removed = m_rows->GetSubtreeEnd(row) - row - 1;
+    node->Collapse();
+    node->ChangeRowCount(-removed);
+    m_rows->Remove(row + 1, removed);
+}
+
+/*! Inserts new node as the last child of the node of the row, its rows are inserted, if they are visible.
+ * \param row Index of the visible row of the parent.
+ * \param node Pointer to the new node.
+ */
+void CXML::InsertNode(int row, CNode * node) {
+    WaitForSnapshot();
+    CNode * parent = m_rows->GetNode(row);
+    parent->InsertNode(node);
+    if (!parent->IsCollapsed()) {
+        CRowList rows;
+        node->ListRows(&rows, m_rows->GetDepth(row) + 1);
+        m_rows->Insert(m_rows->GetSubtreeEnd(row), rows);
+        parent->ChangeRowCount(rows.GetCount());
+    }
+}
+
+/*! Deletes the node of the row with its subtree and removes its rows.
+ * \param row Index of the visible row.
+ */
+void CXML::DeleteRow(int row) {
+    WaitForSnapshot();
+    CNode * node = m_rows->GetNode(row);
+    int end = m_rows->GetSubtreeEnd(row);
+    if (node->GetParent() != NULL) {
+        node->GetParent()->ChangeRowCount(row - end);
+        node->GetParent()->DeleteNode(node->GetID());
+    } else {
+        //deleting root node
+        delete node;
+        m_root = NULL;
     }
+    m_rows->Remove(row, end - row);
 }
 
-/*! Sends the whole tree to the file as an valid XML.
+/*! Finds the row of the node, rows are not visited, only the counts of rows of the childs
+ * in front of the node and its parents are added.
+ * \param node Pointer to the node.
+ * \return Index of the row, -1 if the node is not visible.
  */
-void CXML::Save() const {
-    ofstream file(m_filePath.c_str());
+int CXML::FindRow(CNode * node) const {
+    int row = 0;
+    for (; node->GetParent(); node = node->GetParent()) {
+        if (node->GetParent()->IsCollapsed())
+            return -1;
+        row += 1 + node->GetParent()->CountRowsBefore(node->GetID());
+    }
+    return node == m_root ? row : -1;
+}
 
-    if (m_versionData.length() > 0)
-        file << m_versionData << endl;
-    if (m_root)
-        m_root->XMLPrint(file, 0);
+/*! Makes the node visible, collapsed parents of the node are expanded.
+ * \param node Pointer to the node of this document.
+ * \return Index of the row of the node.
+ */
+int CXML::ShowNode(CNode * node) {
+    CNode * parent = node->GetParent();
+    if (parent == NULL)
+        return 0;
+
+    int row = ShowNode(parent);
+    if (parent->IsCollapsed())
+        ExpandRow(row);
+    return row + 1 + parent->CountRowsBefore(node->GetID());
+}
+
+/*! Finds the node by its path like /catalog/cd[2]/title, number in brackets says which of the childs
+ * with the title is wanted (the first one without brackets).
+ * \param path The path from the root.
+ * \return Pointer to the node, NULL if there is not such node.
+ */
+CNode * CXML::FindPath(const string & path) const {
+    WaitForSnapshot();
+    CNode * node = NULL;
+    size_t pos = 0;
+    string title;
+    int number;
+    while (pos < path.length()) {
+        if (!ReadPathStep(path, pos, title, number))
+            return NULL;
+        int name = m_atoms->Find(title);
+        if (name < 0)
+            return NULL;
+
+        if (node == NULL) {
+            if (m_root == NULL || m_root->GetAtom() != name || number != 1)
+                return NULL;
+            node = m_root;
+        } else if ((node = node->FindChild(name, number)) == NULL)
+            return NULL;
+    }
+    return node;
+}
+
+/*! Gets the count of visible rows.
+ */
+int CXML::GetRowCount() const {
+    return m_rows->GetCount();
+}
+
+/*! Gets the node shown in the row.
+ * \param row Index of the visible row.
+ */
+CNode * CXML::GetRowNode(int row) const {
+    return m_rows->GetNode(row);
+}
+
+/*! Gets the text of the row, nodes keep their texts, until they change.
+ * \param row Index of the visible row.
+ */
+CText CXML::GetRowText(int row) const {
+    return m_rows->GetNode(row)->GetRow(m_rows->GetDepth(row));
+}
+
+/*! Sends the whole tree to the file as an valid XML, the tree is serialized and written in the background.
+ * The saving thread serializes the tree to memory first and the tree must not change until then
+ * (WaitForSnapshot), then the snapshot is written, while the nodes can change.
+ * Only changed nodes are serialized, the rest points to the mapped file. Compressed file is compressed again.
+ */
+void CXML::Save() {
+    //only one snapshot is written at once
+    FinishSaving();
+
+    m_snapshot = new CXMLWriter();
+    //compressed file is compressed again in its format
+    m_snapshot->SetCompression(m_compression);
+    m_savingProgress = new CProgress();
+    m_savingProgress->Lock();
+    m_saving = pthread_create(&m_savingThread, NULL, SavingThread, this) == 0;
+    //if the thread could not be started, the file is written here
+    if (!m_saving)
+        WriteSnapshot();
+}
+
+/*! Prints the whole document to the writer in its format. Source format copies unchanged nodes and everything
+ * around the root from the file, other formats print every node, so unparsed childs are parsed first.
+ * The document must be loaded.
+ * \param writer The writer.
+ */
+void CXML::Print(CXMLWriter & writer) {
+    if (writer.GetFormat() == WRITER_SOURCE && m_root && m_root->GetSource().GetLength()) {
+        //everything around the root is copied from the file too
+        const char * data = m_source->GetData();
+        const char * start = m_root->GetSource().GetData();
+        const char * end = start + m_root->GetSource().GetLength();
+        writer.WriteBlock(CText(data, start - data));
+        m_root->XMLPrint(writer, 0);
+        writer.WriteBlock(CText(end, data + m_source->GetSize() - end));
+        return;
+    }
+
+    if (m_versionData.length() > 0) {
+        writer.Write(m_versionData.data(), m_versionData.length());
+        if (writer.GetFormat() != WRITER_MINIFY)
+            writer.WriteLine();
+    }
+    if (m_root) {
+        if (writer.GetFormat() != WRITER_SOURCE)
+            m_root->LoadAll();
+        m_root->XMLPrint(writer, 0);
+        writer.WriteLine();
+    }
 }
 
 /*! Starts filtering according to the given title.
+ * The titles index is built by the first filtering, because unparsed nodes are parsed for it,
+ * then the nodes keep it up to date, when they are inserted, deleted or renamed.
  * \param title Title of the nodes to be shown.
  */
-void CXML::Filter(string & title) const{
+void CXML::Filter(string & title) {
+    WaitForSnapshot();
+    if (m_titlesIndex == NULL && m_root) {
+        m_titlesIndex = new CTitleIndex();
+        m_arena->SetIndex(m_titlesIndex);
+        try {
+            m_root->PrepareSearching(m_titlesIndex);
+        } catch (const CException & e) {
+            //index of a part of the document would be useless
+            m_arena->SetIndex(NULL);
+            delete m_titlesIndex;
+            m_titlesIndex = NULL;
+            throw;
+        }
+    }
     if (m_root)
         m_root->CollapseAll();
-    m_titlesSearchTree->Filter(title);
+
+    //title, which is not in the document, has no atom
+    int atom = m_atoms->Find(title);
+    if (atom >= 0 && m_titlesIndex)
+        m_titlesIndex->Filter(atom);
 }
 
 /********************* GETTERS / SETTERS *******************************/
 
+/*! Gets the root node, NULL if the document is empty or it is not loaded.
+ */
+CNode * CXML::GetRoot() const {
+    return m_root;
+}
+
 /*! Gets the current file path.
  */
 string CXML::GetFilePath() const {
     return m_filePath;
 }
 
-/*! Sets the root node.
- * \param node Pointer to new root node.
+/*! Gets the size of the file, 0 if it is not loaded.
  */
-void CXML::SetRoot(CNode * node) {
-    m_root = node;
+size_t CXML::GetSize() const {
+    return m_source ? m_source->GetSize() : 0;
 }
 
-/********************* PRIVATE METHODS *******************************/
-
-/********************* PARSING TOOLS *******************************/
-
-
-/*! At start of the file, there can be some version information, this method saves them.
- * \param is File input stream.
+/*! Gets the arena, where new nodes and attributes of the document are allocated.
  */
-void CXML::StoreVersionData(ifstream & is) {
-    IgnoreNextWhitespaces(is);
-    char c = is.get();
-    if (c != 60) // there must be < character
-        throw InvalidXMLFormatException(m_filePath);
-
-    //if the next character is ?, it is the header info and i will save it to the string
-    char d = is.get();
-    if (d == 63) {
-        m_versionData.append(1, c);
-        m_versionData.append(1, d);
-        while (d != 62) {
-            d = is.get();
-            m_versionData.append(1, d);
-        }
-        IgnoreNextWhitespaces(is);
-    } else {
-        is.putback(d);
-        is.putback(c);
-    }
+CArena * CXML::GetArena() const {
+    return m_arena;
 }
 
-/*! Ignores white spaces in the file.
- * \param is File input stream.
+/*! Gets the names of elements and attributes of the document.
  */
-void CXML::IgnoreNextWhitespaces(ifstream & is) const {
-    char c = 32;
-    while (c == 32 || c == 10 || c == 9 || c == 13) { //SPACE, TAB, CR, LF
-        c = is.get();
-    }
-    is.putback(c);
+CAtomTable * CXML::GetAtoms() const {
+    return m_atoms;
 }
 
-/*! Main parsing function, it find out the type of next node and saves the node (content between < > to the I/O variable
- * \param is File input stream.
- * \param tag To this string is saved content of the next tag.
+/*! Sets the root node and lists its rows.
+ * \param node Pointer to new root node.
  */
-int CXML::TellTypeOfNextNode(ifstream& is, string * tag) const {
-    IgnoreNextWhitespaces(is);
-    char c = is.get();
-    if (is.eof())
-        return END_OF_FILE;
-    if (c != 60) // after white spaces, there must be < character
-        throw InvalidXMLFormatException(m_filePath);
+void CXML::SetRoot(CNode * node) {
+    WaitForSnapshot();
+    m_root = node;
+    if (m_root && m_titlesIndex)
+        m_root->PrepareSearching(m_titlesIndex);
+    Show();
+}
 
+/********************* PRIVATE METHODS *******************************/
 
-    while (c != 62) { // looking for > char
-        c = is.get();
-        if (c != 62) 
-            tag->append(1, c); //saving other chars to the tag
-    }
-    
-    //now look what's next
-    
-    IgnoreNextWhitespaces(is);
-    c = is.get();
-    if (is.eof())
-        return END_OF_FILE;
-    if (c == 60) { //it is another tag!
-        is.putback(c);
-        if ((*tag)[0] == 47) //is it end tag?
-            return NEXT_IS_ENDTAG;
-        else if (IsValidSimpleTag(*tag)) {
-            return NEXT_IS_SIMPLE;
-        } else if (IsValidComment(*tag)) {
-            return NEXT_IS_COMMENT;
-        } else {
-            return NEXT_IS_PARENTNODE;
-        }
-    } else { //its some kind of text
-        is.putback(c);
-        return NEXT_IS_TEXTNODE;
-    }
+/********************* LOADING THREAD *******************************/
+
+/*! Thread function, which loads the file of the document.
+ * \param xml Pointer to CXML.
+ */
+void * CXML::LoadingThread(void * xml) {
+    ((CXML *) xml)->Load();
+    return NULL;
 }
 
-/*! Function for parsing attributes, it finds attributes in the string and adds them to the node.
- * \param node Pointer to the node, where attributes will be added.
- * \param x String, from which attributes are parsed.
- * \return The type of next node, specified by constants.
- */
-void CXML::ParseAttributes(CNode * node, const string & x) const {
-    string attr, value;
-    for (unsigned int i = 0; i < x.length(); i++) { //go through the whole string
-        attr.clear();
-        value.clear();
-        if (x[i] == 32) { // after first space come attributes
-            i++;
-            if (i >= x.length())
-                break;
-            i = IgnoreNextWhiteSpaces(x, i);
-            while (x[i] != 61) { //looking for attr separator, which is =
-                if (i >= x.length())
-                    break;
-                if (x[i] == 32) { //there cannot be space without =
-                    throw InvalidXMLFormatException(m_filePath);
-                }
-                attr.append(1, x[i]);
-                i++;
-            }
-            //now there should be " or '
-            i++;
-            if (x[i] == 34 || x[i] == 39) {
-                char quotes = x[i]; // i will be looking for the same quotes as the end tag
-                i++;
-                while (x[i] != quotes) {
-                    if (i >= x.length())
-                        break;
-                    value.append(1, x[i]);
-                    i++;
-                }
+/*! Maps the file and parses it into a tree, the document is owned by this thread meanwhile
+ * (the parser lets the interface in between the nodes). Big file is not parsed, if it has valid image,
+ * otherwise the image is made after the parsing.
+ */
+void CXML::Load() {
+    m_progress->Lock();
+    try {
+        m_source = new CMappedFile(m_filePath);
+        CParser parser(m_source->GetData(), m_source->GetSize(), m_filePath, m_arena);
+        parser.SetProgress(m_progress);
+        //compressed file is decompressed by other thread, while it is parsed (it has no image)
+        m_compression = CDecoder::GetFormat(m_source->GetData(), m_source->GetSize());
+        bool isCompressed = m_compression != DECODER_NONE;
+        //the standard input has no image and images are used only if their directory is set
+        string imagePath = m_filePath != STDIN_PATH ? CImage::GetPath(m_filePath) : string();
+        bool isImaged = !isCompressed && m_source->GetSize() >= IMAGE_MIN_SIZE
+                && m_source->GetSize() <= IMAGE_MAX_SIZE && !imagePath.empty();
+        if (isImaged) {
+            m_image = new CImageReader(m_source->GetData(), m_source->GetSize(), m_source->GetModified());
+            if (!m_image->Open(imagePath)) {
+                delete m_image;
+                m_image = NULL;
             } else
-                throw InvalidXMLFormatException(m_filePath);
-
-            CAttribute * attribute = new CAttribute(attr, value);
-            node->InsertAttribute(attribute);
+                m_arena->SetImage(m_image);
+        }
 
-            i = IgnoreNextWhiteSpaces(x, i);
+        if (isCompressed) {
+            //the decompressed data are not kept, so the memory does not grow with the size of the document
+            CDecoder decoder(m_source->GetData(), m_source->GetSize(), m_filePath);
+            m_root = parser.ParseDecoded(&decoder, m_versionData);
+        } else if (m_image)
+            m_root = parser.ReadImage(m_image, m_versionData);
+        else {
+            m_root = parser.Parse(m_versionData);
+            if (isImaged)
+                WriteImage(imagePath);
         }
+    } catch (const CException & e) {
+        //the exception is thrown again by the interface thread
+        m_loadingError = current_exception();
     }
+    m_progress->Finish();
+    m_progress->Unlock();
 }
 
-/*! Gets the value of text node from file stream.
- * \param is File input stream.
- * \return The text node value.
+/*! Writes the image of the parsed tree to the directory of the images, so the file is not parsed next time.
+ * The tree must be the same as the file, the image is not written, if it was changed meanwhile.
+ * \param imagePath Path of the image.
  */
-string CXML::ExtractTextNodeValue(ifstream & is) const {
-    string ret;
-    char c = is.get();
-    while (c != 60) { //until there is an <
-        ret.append(1, c);
-        c = is.get();
-    }
-    is.putback(c);
-    return ret;
-}
-
-/*! Text node has to have its end tag right after the text value. Extract it out from the stream.
- * \param is File input stream.
- * \param title Title of the text node.
- */
-void CXML::ExtractTextNodeEndTag(ifstream & is, string & title) const {
-    //i know there is a tag - and it must be the end tag of my title
-    string endtag;
-    char c = is.get();
-    if (c != 60)
-        throw InvalidXMLFormatException(m_filePath);
-    c = is.get();
-    if (c != 47) // second character must be /
-        throw InvalidXMLFormatException(m_filePath);
-    c = is.get();
-    while (c != 62) {
-        endtag.append(1, c);
-        c = is.get();
-    }
-    //final comparison
-    if (endtag != title)
-        throw InvalidXMLFormatException(m_filePath);
+void CXML::WriteImage(const string & imagePath) {
+    if (m_root == NULL || m_root->IsDirty())
+        return;
+    CImageWriter image(m_source->GetData(), m_source->GetSize(), m_atoms);
+    if (!m_versionData.empty())
+        image.SetVersionData(CText(m_versionData));
+    m_root->ImagePrint(image);
+    //the image is only a cache, the file is loaded also without it
+    image.WriteFile(imagePath, m_source->GetModified());
 }
 
-/*! Gets the value of comment node from file stream.
- * \param x The comment node text.
- * \return The comment node value.
+/********************* SAVING THREAD *******************************/
+
+/*! Thread function, which writes the snapshot of the document.
+ * \param xml Pointer to CXML.
  */
-string CXML::ExtractCommentNodeValue(const string & x) const {
-    string ret;
-    // first 3 characters of the comment and last 2 are not interesting
-    for (unsigned int i = 4; i < (x.length() - 2); i++) {
-        ret.append(1, x[i]);
+void * CXML::SavingThread(void * xml) {
+    ((CXML *) xml)->WriteSnapshot();
+    return NULL;
+}
+
+/*! Serializes the tree to the snapshot and releases the tree, then the snapshot is written to a temporary file,
+ * which replaces the file, when it is complete (see CXMLWriter). The temporary file is needed also because
+ * the nodes still point to the original one (the mapped original stays valid after it is replaced).
+ */
+void CXML::WriteSnapshot() {
+    bool printed = true;
+    try {
+        Print(*m_snapshot);
+    } catch (const CException & e) {
+        //unparsed childs may be invalid, the file stays as it is
+        printed = false;
     }
-    return ret;
+    m_savingProgress->Unlock();
+
+    m_saved = printed && m_snapshot->WriteFile(m_filePath, m_savingProgress);
+    //the original file stays, when the saving fails, the image of the replaced file is not valid
+    if (m_saved)
+        remove(CImage::GetPath(m_filePath).c_str());
+    m_savingProgress->Finish();
 }
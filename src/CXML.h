@@ -3,11 +3,18 @@
 
 #include <cstdlib>
 #include <string>
+#include <exception>
+#include <pthread.h>
 
+#include "CArena.h"
+#include "CAtomTable.h"
 #include "CNode.h"
-#include "CTagStack.h"
-#include "CGUI.h"
-#include "CSearchTree.h"
+#include "CMappedFile.h"
+#include "CProgress.h"
+#include "CRowList.h"
+#include "CTitleIndex.h"
+#include "CXMLWriter.h"
+#include "CImageReader.h"
 
 using namespace std;
 
@@ -15,43 +22,100 @@ using namespace std;
 
 class CXML {
 public:
-    CXML(string & filePath, CGUI * interface);
+    CXML(string & filePath);
     ~CXML();
 
+    //loading in the background
+    void ShowLoaded();
+    void FinishLoading();
+    CProgress * GetProgress() const;
+
+    //saving in the background
+    bool FinishSaving();
+    void WaitForSnapshot() const;
+    CProgress * GetSavingProgress() const;
+
     // "printing" tools
     void Show();
-    void Save() const;
-    void Filter(string & title) const;
+    void Save();
+    void Print(CXMLWriter & writer);
+    void Filter(string & title);
+
+    //visible rows
+    void ExpandRow(int row);
+    void CollapseRow(int row);
+    void InsertNode(int row, CNode * node);
+    void DeleteRow(int row);
+    int FindRow(CNode * node) const;
+    int ShowNode(CNode * node);
+    CNode * FindPath(const string & path) const;
+    int GetRowCount() const;
+    CNode * GetRowNode(int row) const;
+    CText GetRowText(int row) const;
 
+    CNode * GetRoot() const;
     string GetFilePath() const;
+    size_t GetSize() const;
+    CArena * GetArena() const;
+    CAtomTable * GetAtoms() const;
     void SetRoot(CNode * node);
 protected:
-    //parsing tools
-    void StoreVersionData(ifstream & is);
-    void IgnoreNextWhitespaces(ifstream & is) const;
-    int TellTypeOfNextNode(ifstream & is, string * tag) const;
-    void ParseAttributes(CNode * node, const string & x) const;
-    string ExtractTextNodeValue(ifstream & is) const;
-    void ExtractTextNodeEndTag(ifstream & is, string & title) const;
-    string ExtractCommentNodeValue(const string & x) const;
+    static void * LoadingThread(void * xml);
+    void Load();
+    void WriteImage(const string & imagePath);
+    static void * SavingThread(void * xml);
+    void WriteSnapshot();
 
     ///! Pointer to the root of the tree.
     CNode * m_root;
 
-    ///! Pointer to the titles search tree.
-    CSearchTree * m_titlesSearchTree;
+    ///! Pointer to the titles index.
+    CTitleIndex * m_titlesIndex;
 
-    //pointer to the interface
-    ///! Pointer to the GUI.
-    CGUI * m_interface;
+    ///! Visible rows of the tree.
+    CRowList * m_rows;
 
-    ///! Stack used for XML parsing.
-    CTagStack m_stack;
+    ///! Arena owning all the nodes, attributes and edited texts.
+    CArena * m_arena;
+    ///! Names of elements and attributes of the document.
+    CAtomTable * m_atoms;
+
+    ///! The file mapped to memory, texts of the nodes point to it.
+    CMappedFile * m_source;
+    ///! Compression of the file (DECODER_NONE, DECODER_GZIP, DECODER_ZSTD), it is compressed again, when it is saved
+    int m_compression;
+    ///! Image of the file, from which the tree was built (NULL if the file was parsed), texts may point to it.
+    CImageReader * m_image;
 
     ///! File name.
     string m_filePath;
     ///! Information about XML version (if there are any).
     string m_versionData;
+
+    //loading in the background
+    ///! Progress of the loading, it is shared with the interface.
+    CProgress * m_progress;
+    ///! The loading thread.
+    pthread_t m_loadingThread;
+    ///! Has the loading thread to be joined?
+    bool m_loading;
+    ///! Exception of the loading thread, it is thrown, when the loading is finished.
+    exception_ptr m_loadingError;
+    ///! Count of complete childs of the root, whose rows are listed.
+    int m_cntLoaded;
+
+    //saving in the background
+    ///! Serialized document, which is written by the saving thread (NULL if nothing is saved).
+    CXMLWriter * m_snapshot;
+    ///! Progress of the saving, it is shared with the interface. The saving thread owns the document,
+    ///! until the snapshot is complete.
+    CProgress * m_savingProgress;
+    ///! The saving thread.
+    pthread_t m_savingThread;
+    ///! Has the saving thread to be joined?
+    bool m_saving;
+    ///! Was the snapshot written and renamed to the file?
+    bool m_saved;
 };
 
 #endif	/* CXML_H */
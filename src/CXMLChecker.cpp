@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+
+#include "CXMLChecker.h"
+#include "CXMLReader.h"
+#include "CXMLPushReader.h"
+#include "CException.h"
+
+///! Size of the chunks read from the descriptor
+#define CHECKER_CHUNK_SIZE 65536
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new checker.
+ * \param filePath File name (for exceptions).
+ */
+CXMLChecker::CXMLChecker(const string & filePath) {
+    m_filePath = filePath;
+}
+
+/*! Reads the whole data, the content of every element is read (nothing is skipped).
+ * Errors of titles and attributes are reported as invalid format at the position of their tag.
+ * \param data Pointer to the data (the whole file).
+ * \param size Size of the data.
+ * \throws InvalidXMLFormatException The first error with its line and column.
+ */
+void CXMLChecker::Check(const char * data, size_t size) {
+    CXMLReader reader(data, size, m_filePath, this);
+    try {
+        reader.Read();
+    } catch (InvalidXMLFormatException & e) {
+        e.Locate(data, size);
+        throw;
+    } catch (const CException & e) {
+        InvalidXMLFormatException error(m_filePath, reader.GetTagPosition());
+        error.Locate(data, size);
+        error.SetReason(e.GetMessage());
+        throw error;
+    }
+}
+
+/*! Reads the data from the descriptor until its end, they are given to the push reader in chunks.
+ * \param fd The descriptor (it is not closed).
+ * \throws InvalidFileNameException The descriptor cannot be read.
+ * \throws InvalidXMLFormatException The first error with its line and column.
+ */
+void CXMLChecker::Check(int fd) {
+    CXMLPushReader reader(m_filePath, this);
+    char * chunk = new char [CHECKER_CHUNK_SIZE];
+    try {
+        while (true) {
+            ssize_t count = read(fd, chunk, CHECKER_CHUNK_SIZE);
+            if (count == 0)
+                break;
+            if (count < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw InvalidFileNameException(m_filePath);
+            }
+            reader.Feed(chunk, count);
+        }
+        reader.Finish();
+    } catch (const CException & e) {
+        delete [] chunk;
+        throw;
+    }
+    delete [] chunk;
+}
+
+/*! Reads the data decompressed by the decoder thread, the decompression and the checking run at once.
+ * \param decoder Pointer to the decoder of the data.
+ * \throws InvalidXMLFormatException The compressed data are corrupted, or the first error with its line and column.
+ */
+void CXMLChecker::Check(CDecoder * decoder) {
+    CXMLPushReader reader(m_filePath, this);
+    decoder->Start();
+    const char * data;
+    size_t size;
+    while ((data = decoder->Next(size)) != NULL) {
+        reader.Feed(data, size);
+        decoder->Release();
+    }
+    reader.Finish();
+}
+
+/********************* EVENTS OF THE READER *******************************/
+
+/*! The element is already checked by the reader.
+ * \param title Element title.
+ * \param attributes Element attributes.
+ * \param type NEXT_IS_PARENTNODE, NEXT_IS_TEXTNODE or NEXT_IS_SIMPLE.
+ * \return True, the content is always checked.
+ */
+bool CXMLChecker::StartElement(const CText & title, const CAttributeList & attributes, int type) {
+    return true;
+}
+
+/*! Text is not checked.
+ * \param value The text.
+ */
+void CXMLChecker::Text(const CText & value) {
+}
+
+/*! Comment is not checked.
+ * \param comment Comment text.
+ */
+void CXMLChecker::Comment(const CText & comment) {
+}
+
+/*! The end tag is already matched by the reader.
+ * \param title Element title.
+ */
+void CXMLChecker::EndElement(const CText & title) {
+}
@@ -0,0 +1,36 @@
+#ifndef CXMLCHECKER_H
+#define	CXMLCHECKER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CText.h"
+#include "CXMLHandler.h"
+#include "CDecoder.h"
+
+using namespace std;
+
+///! Class, which checks, that XML data are well-formed, by the rules of the XML reader. It ignores the events,
+///! so no nodes are built, and the first error is reported with its line and column. Data, which cannot be mapped
+///! (like a pipe), are read in chunks by the push reader, so they are not kept in memory.
+
+class CXMLChecker : public CXMLHandler {
+public:
+    CXMLChecker(const string & filePath);
+
+    void Check(const char * data, size_t size);
+    void Check(int fd);
+    void Check(CDecoder * decoder);
+
+    //events of the reader
+    virtual bool StartElement(const CText & title, const CAttributeList & attributes, int type);
+    virtual void Text(const CText & value);
+    virtual void Comment(const CText & comment);
+    virtual void EndElement(const CText & title);
+protected:
+    ///! File name (for exceptions)
+    string m_filePath;
+};
+
+#endif	/* CXMLCHECKER_H */
+
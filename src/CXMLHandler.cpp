@@ -0,0 +1,97 @@
+#include <cstdlib>
+
+#include "CXMLHandler.h"
+
+///! Default size of attribute list.
+#define DEFAULT_LIST_SIZE 8
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates and allocates new empty attribute list.
+ */
+CAttributeList::CAttributeList() {
+    m_names = new CText [DEFAULT_LIST_SIZE];
+    m_values = new CText [DEFAULT_LIST_SIZE];
+    m_size = DEFAULT_LIST_SIZE;
+    m_cnt = 0;
+}
+
+/*! Deallocates the list.
+ */
+CAttributeList::~CAttributeList() {
+    delete [] m_names;
+    delete [] m_values;
+}
+
+/*! Adds new attribute to the end of the list.
+ * \param name Name of the attribute.
+ * \param value Value of the attribute.
+ */
+void CAttributeList::Add(const CText & name, const CText & value) {
+    ReallocList();
+    m_names[m_cnt] = name;
+    m_values[m_cnt] = value;
+    m_cnt++;
+}
+
+/*! Removes all attributes, allocated memory is kept for next element.
+ */
+void CAttributeList::Clear() {
+    m_cnt = 0;
+}
+
+/*! Gets the count of attributes.
+ */
+int CAttributeList::GetCount() const {
+    return m_cnt;
+}
+
+/*! Gets the name of attribute.
+ * \param i Index of the attribute.
+ */
+const CText & CAttributeList::GetName(int i) const {
+    return m_names[i];
+}
+
+/*! Gets the value of attribute.
+ * \param i Index of the attribute.
+ */
+const CText & CAttributeList::GetValue(int i) const {
+    return m_values[i];
+}
+
+/*! Finds out, if there is an attribute with given name.
+ * \param name Name of the attribute.
+ */
+bool CAttributeList::Exists(const CText & name) const {
+    for (int i = 0; i < m_cnt; i++) {
+        if (m_names[i] == name)
+            return true;
+    }
+    return false;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! List memory management.
+ */
+void CAttributeList::ReallocList() {
+    if (m_cnt > m_size - 1) {
+        CText * names = new CText [m_size * REALLOC_CONSTANT];
+        CText * values = new CText [m_size * REALLOC_CONSTANT];
+        for (int i = 0; i < m_cnt; i++) {
+            names[i] = m_names[i];
+            values[i] = m_values[i];
+        }
+
+        delete [] m_names;
+        delete [] m_values;
+        m_names = names;
+        m_values = values;
+        m_size *= REALLOC_CONSTANT;
+    }
+}
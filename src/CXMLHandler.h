@@ -0,0 +1,109 @@
+#ifndef CXMLHANDLER_H
+#define	CXMLHANDLER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CText.h"
+
+using namespace std;
+
+///! Specifies that next node is text node.
+#define NEXT_IS_TEXTNODE 0
+///! Specifies that next node is parent node.
+#define NEXT_IS_PARENTNODE 1
+///! Specifies that next node is comment node.
+#define NEXT_IS_COMMENT 2
+///! Specifies that next node is simple node.
+#define NEXT_IS_SIMPLE 3
+///! Specifies that next node is end node.
+#define NEXT_IS_ENDTAG 4
+///! Specifies that parser reached end of file.
+#define END_OF_FILE -1
+
+///! Class, which holds attributes of one element (names and values point to the data).
+
+class CAttributeList {
+public:
+    CAttributeList();
+    ~CAttributeList();
+
+    void Add(const CText & name, const CText & value);
+    void Clear();
+
+    int GetCount() const;
+    const CText & GetName(int i) const;
+    const CText & GetValue(int i) const;
+    bool Exists(const CText & name) const;
+protected:
+    void ReallocList();
+
+    ///! Array of attribute names
+    CText * m_names;
+    ///! Array of attribute values
+    CText * m_values;
+    ///! Count of attributes
+    int m_cnt;
+    ///! Current max count of attributes
+    int m_size;
+};
+
+///! Abstract class, which receives events of the XML reader (one event per tag or text).
+
+class CXMLHandler {
+public:
+
+    virtual ~CXMLHandler() {
+    };
+
+    /*! Version information from the start of the file (<?xml ... ?>).
+     * \param data The whole version tag.
+     */
+    virtual void VersionData(const CText & data) {
+    };
+
+    /*! Start of an element, its attributes are already checked.
+     * \param title Element title.
+     * \param attributes Element attributes.
+     * \param type NEXT_IS_PARENTNODE, NEXT_IS_TEXTNODE or NEXT_IS_SIMPLE.
+     * \return False, if the content of parent element should be skipped (it is sent by Skipped then).
+     */
+    virtual bool StartElement(const CText & title, const CAttributeList & attributes, int type) = 0;
+
+    /*! Text value of the last started element (only for NEXT_IS_TEXTNODE).
+     * \param value The text.
+     */
+    virtual void Text(const CText & value) = 0;
+
+    /*! Comment between elements.
+     * \param comment Comment text.
+     */
+    virtual void Comment(const CText & comment) = 0;
+
+    /*! Content of parent element, which was not read (only the end tag was found).
+     * \param content All the data between the start tag and the end tag.
+     */
+    virtual void Skipped(const CText & content) {
+    };
+
+    /*! End of an element, it is sent for every started element.
+     * \param title Element title.
+     */
+    virtual void EndElement(const CText & title) = 0;
+
+    /*! The whole markup of the last read tag in the data (a text element with its text and end tag),
+     * it is sent after the other events of the tag.
+     * \param markup The markup (it points to the data).
+     */
+    virtual void Markup(const CText & markup) {
+    };
+
+    /*! Position in the data after a read tag (with its text), it is sent after every tag.
+     * \param pos The position.
+     */
+    virtual void Position(size_t pos) {
+    };
+};
+
+#endif	/* CXMLHANDLER_H */
+
@@ -0,0 +1,297 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "CXMLPushReader.h"
+#include "functions.h"
+
+///! Default size of the kept data
+#define DEFAULT_BUFFER_SIZE 65536
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new reader, which waits for the data.
+ * \param filePath File name (for exceptions).
+ * \param handler Pointer to the receiver of the events, it must read the content of every element.
+ */
+CXMLPushReader::CXMLPushReader(const string & filePath, CXMLHandler * handler)
+: CXMLReader("", 0, filePath, handler) {
+    m_buffer = new char [DEFAULT_BUFFER_SIZE];
+    m_bufferSize = DEFAULT_BUFFER_SIZE;
+    m_data = m_buffer;
+    m_stage = PUSH_VERSION;
+    m_pos = 0;
+    m_scan = 0;
+    m_tagEnd = 0;
+    m_next = 0;
+    m_textEnd = 0;
+    m_rootType = END_OF_FILE;
+    m_offset = 0;
+    m_line = 1;
+    m_lineStart = 0;
+}
+
+/*! Deallocates the kept data.
+ */
+CXMLPushReader::~CXMLPushReader() {
+    delete [] m_buffer;
+}
+
+/*! Reads next part of the document, complete tags are sent to the handler and the rest is kept.
+ * \param data Pointer to the part.
+ * \param size Size of the part (it can end anywhere).
+ * \throws InvalidXMLFormatException The first error with its line and column.
+ */
+void CXMLPushReader::Feed(const char * data, size_t size) {
+    Discard();
+    ReallocBuffer(m_size + size);
+    memcpy(m_buffer + m_size, data, size);
+    m_size += size;
+    m_data = m_buffer;
+    m_scanner = CScanner(m_buffer, m_size);
+    ReadBuffer(false);
+}
+
+/*! Reads the rest of the document, after all the parts were given. The last tag must be the end tag of the root.
+ * \throws InvalidXMLFormatException The first error with its line and column.
+ */
+void CXMLPushReader::Finish() {
+    ReadBuffer(true);
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Reads the complete tags of the buffer, errors get their position in the file.
+ * \param isLast Is it the end of the document?
+ */
+void CXMLPushReader::ReadBuffer(bool isLast) {
+    try {
+        while (ReadToken()) {
+        }
+        if (isLast)
+            ReadLastTag();
+    } catch (InvalidXMLFormatException & e) {
+        Locate(e, e.GetOffset());
+        throw;
+    } catch (const InvalidXMLTitleException & e) {
+        InvalidXMLFormatException error(m_filePath);
+        Locate(error, m_tagPos);
+        error.SetReason(e.GetMessage());
+        throw error;
+    } catch (const AttributeAlreadyExistsException & e) {
+        InvalidXMLFormatException error(m_filePath);
+        Locate(error, m_tagPos);
+        error.SetReason(e.GetMessage());
+        throw error;
+    }
+}
+
+/*! Reads the next tag (with its text), if it is complete in the buffer. The searches continue,
+ * where they stopped for the last time, so no data are scanned twice.
+ * \return False, if more data are needed.
+ */
+bool CXMLPushReader::ReadToken() {
+    if (m_stage == PUSH_VERSION) {
+        //the second character tells, if there is the version data
+        m_pos = m_scanner.SkipWhitespaces(m_pos);
+        if (m_scan < m_pos)
+            m_scan = m_pos;
+        if (m_pos + 1 >= m_size)
+            return false;
+        if (m_data[m_pos] != 60) // there must be < character
+            throw InvalidXMLFormatException(m_filePath, m_pos);
+        if (m_data[m_pos + 1] == 63) {
+            size_t end = m_scanner.FindTagEnd(m_scan);
+            if (end >= m_size) {
+                m_scan = m_size;
+                return false;
+            }
+            m_handler->VersionData(CText(m_data + m_pos, end + 1 - m_pos));
+            m_pos = end + 1;
+        }
+        m_scan = m_pos;
+        m_stage = PUSH_TAG;
+    }
+
+    if (m_stage == PUSH_TAG) {
+        m_pos = m_scanner.SkipWhitespaces(m_pos);
+        if (m_scan < m_pos)
+            m_scan = m_pos;
+        if (m_pos >= m_size)
+            return false;
+        if (m_data[m_pos] != 60) // after white spaces, there must be < character
+            throw InvalidXMLFormatException(m_filePath, m_pos);
+        m_tagPos = m_pos;
+
+        //if root element is not parent, there can be only one element at all
+        if (m_rootType != END_OF_FILE && m_rootType != NEXT_IS_PARENTNODE)
+            throw InvalidXMLFormatException(m_filePath, m_pos);
+
+        m_tagEnd = m_scanner.FindTagEnd(m_scan);
+        if (m_tagEnd >= m_size) {
+            m_scan = m_size;
+            return false;
+        }
+        m_scan = m_tagEnd + 1;
+        m_stage = PUSH_NEXT;
+    }
+
+    if (m_stage == PUSH_NEXT) {
+        //the last tag of the document is known only at its end
+        m_next = m_scanner.SkipWhitespaces(m_scan);
+        if (m_next >= m_size) {
+            m_scan = m_size;
+            return false;
+        }
+        if (m_data[m_next] == 60) { //it is another tag!
+            CText tag(m_data + m_pos + 1, m_tagEnd - (m_pos + 1));
+            int type;
+            if (tag.GetLength() && tag.GetData()[0] == 47) //is it end tag?
+                type = NEXT_IS_ENDTAG;
+            else if (IsValidSimpleTag(tag))
+                type = NEXT_IS_SIMPLE;
+            else if (IsValidComment(tag))
+                type = NEXT_IS_COMMENT;
+            else
+                type = NEXT_IS_PARENTNODE;
+            size_t pos = m_next;
+            ReadTag(type, pos);
+            m_pos = m_scan = pos;
+            m_stage = PUSH_TAG;
+            return true;
+        }
+        m_scan = m_next;
+        m_stage = PUSH_TEXT;
+    }
+
+    if (m_stage == PUSH_TEXT) {
+        m_textEnd = m_scanner.FindTagStart(m_scan);
+        if (m_textEnd >= m_size) {
+            m_scan = m_size;
+            return false;
+        }
+        m_scan = m_textEnd + 1;
+        m_stage = PUSH_END_TAG;
+    }
+
+    //the text node is read (PUSH_END_TAG), when its end tag is complete
+    m_scan = m_scanner.FindTagEnd(m_scan);
+    if (m_scan >= m_size)
+        return false;
+    size_t pos = m_next;
+    ReadTag(NEXT_IS_TEXTNODE, pos);
+    m_pos = m_scan = pos;
+    m_stage = PUSH_TAG;
+    return true;
+}
+
+/*! Checks the complete tag and sends it to the handler.
+ * \param type The type of the node, specified by constants.
+ * \param pos Position in the buffer after the tag (and white spaces), it is moved after the text and end tag.
+ */
+void CXMLPushReader::ReadTag(int type, size_t & pos) {
+    ReadNode(type, CText(m_data + m_pos + 1, m_tagEnd - (m_pos + 1)), pos);
+    m_handler->Position(m_offset + pos);
+
+    //titles of open elements must stay, when the buffer is discarded
+    if (type == NEXT_IS_PARENTNODE)
+        m_stack.Push(CText(m_stack.Pop().GetString()));
+
+    //root end tag won't be read here, so stack cannot be free here
+    if (type == NEXT_IS_ENDTAG && m_stack.GetStackCnt() == 0)
+        throw InvalidXMLFormatException(m_filePath, pos);
+    if (m_rootType == END_OF_FILE)
+        m_rootType = type;
+}
+
+/*! Reads the tag, which was left in the buffer at the end of the document, it must be the end tag of the root.
+ */
+void CXMLPushReader::ReadLastTag() {
+    //the document ended inside a tag, or there is no tag after the root
+    if (m_stage == PUSH_VERSION || m_stage == PUSH_TAG)
+        throw InvalidXMLFormatException(m_filePath, m_pos);
+    if (m_stage == PUSH_TEXT)
+        throw InvalidXMLFormatException(m_filePath, m_next);
+    if (m_stage == PUSH_END_TAG) {
+        //the text node is checked as far as it can be, its end tag is not complete
+        size_t pos = m_next;
+        ReadTag(NEXT_IS_TEXTNODE, pos);
+    }
+
+    //the file has ended, stack must be free (after poping the root...)
+    CText tag(m_data + m_pos + 1, m_tagEnd - (m_pos + 1));
+    CText title = m_stack.Pop();
+    if (tag.Sub(1, tag.GetLength()) != title)
+        throw InvalidXMLFormatException(m_filePath, m_pos);
+    if (m_stack.GetStackCnt() > 0)
+        throw InvalidXMLFormatException(m_filePath, m_size);
+    m_handler->EndElement(title);
+    m_handler->Markup(CText(m_data + m_pos, m_tagEnd + 1 - m_pos));
+    m_pos = m_size;
+    m_stage = PUSH_TAG;
+}
+
+/*! Removes the read data from the buffer, only the incomplete tag is kept.
+ */
+void CXMLPushReader::Discard() {
+    if (m_pos == 0)
+        return;
+    CountLines(m_pos, m_line, m_lineStart);
+    memmove(m_buffer, m_buffer + m_pos, m_size - m_pos);
+    m_size -= m_pos;
+    m_offset += m_pos;
+
+    //positions of the incomplete tag are after its start, the others are set before they are used
+    m_scan -= m_pos;
+    m_tagEnd -= m_pos;
+    m_next -= m_pos;
+    m_textEnd -= m_pos;
+    m_tagPos -= m_pos;
+    m_pos = 0;
+}
+
+/*! Buffer memory management.
+ * \param size Size of the data, which must fit in the buffer.
+ */
+void CXMLPushReader::ReallocBuffer(size_t size) {
+    if (size <= m_bufferSize)
+        return;
+    size_t newSize = m_bufferSize * REALLOC_CONSTANT;
+    if (newSize < size)
+        newSize = size;
+    char * tmp = new char [newSize];
+    memcpy(tmp, m_buffer, m_size);
+    delete [] m_buffer;
+    m_buffer = tmp;
+    m_bufferSize = newSize;
+    m_data = m_buffer;
+}
+
+/*! Counts the lines in the buffer.
+ * \param end Position in the buffer, where the counting ends.
+ * \param line Line at the start of the buffer, it is moved to the line at the end.
+ * \param lineStart Position of the start of the line in the file, it is moved too.
+ */
+void CXMLPushReader::CountLines(size_t end, size_t & line, size_t & lineStart) const {
+    const char * last = m_buffer + end;
+    for (const char * p = m_buffer; (p = (const char *) memchr(p, 10, last - p)) != NULL; p++) {
+        line++;
+        lineStart = m_offset + (p + 1 - m_buffer);
+    }
+}
+
+/*! Sets the position of the error in the file.
+ * \param e The error.
+ * \param pos Position of the error in the buffer.
+ */
+void CXMLPushReader::Locate(InvalidXMLFormatException & e, size_t pos) const {
+    if (pos > m_size)
+        pos = m_size;
+    size_t line = m_line;
+    size_t lineStart = m_lineStart;
+    CountLines(pos, line, lineStart);
+    e.SetPosition(m_offset + pos, line, m_offset + pos - lineStart + 1);
+}
@@ -0,0 +1,74 @@
+#ifndef CXMLPUSHREADER_H
+#define	CXMLPUSHREADER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CText.h"
+#include "CException.h"
+#include "CXMLReader.h"
+#include "CXMLHandler.h"
+
+using namespace std;
+
+///! The reader waits for the version data (or the first tag).
+#define PUSH_VERSION 0
+///! The reader waits for the end of the next tag.
+#define PUSH_TAG 1
+///! The reader waits for the character after the tag (and white spaces), which tells the type of the tag.
+#define PUSH_NEXT 2
+///! The reader waits for the end of the text.
+#define PUSH_TEXT 3
+///! The reader waits for the end tag after the text.
+#define PUSH_END_TAG 4
+
+///! Class, which reads XML data given in chunks of any size (from a pipe, a socket, a decompressor...) by the same
+///! rules as the XML reader. Every tag is sent to the handler, as soon as it is complete, only the incomplete tag
+///! (with its text) is kept, so the memory does not depend on the size of the document. Texts sent to the handler
+///! point to the kept data, so they are valid only during the event, and the content of elements is never skipped.
+
+class CXMLPushReader : protected CXMLReader {
+public:
+    CXMLPushReader(const string & filePath, CXMLHandler * handler);
+    ~CXMLPushReader();
+
+    void Feed(const char * data, size_t size);
+    void Finish();
+protected:
+    void ReadBuffer(bool isLast);
+    bool ReadToken();
+    void ReadTag(int type, size_t & pos);
+    void ReadLastTag();
+    void Discard();
+    void ReallocBuffer(size_t size);
+    void CountLines(size_t end, size_t & line, size_t & lineStart) const;
+    void Locate(InvalidXMLFormatException & e, size_t pos) const;
+
+    ///! The kept data (the incomplete tag and the data after it)
+    char * m_buffer;
+    ///! Current max size of the kept data
+    size_t m_bufferSize;
+    ///! What the reader waits for, specified by constants
+    int m_stage;
+    ///! Position of the incomplete tag in the buffer
+    size_t m_pos;
+    ///! Position in the buffer, where the search continues, when more data come
+    size_t m_scan;
+    ///! Position of the > character of the incomplete tag
+    size_t m_tagEnd;
+    ///! Position of the character after the tag (and white spaces)
+    size_t m_next;
+    ///! Position of the < character after the text
+    size_t m_textEnd;
+    ///! Type of the first node (the root)
+    int m_rootType;
+    ///! Position of the buffer in the file
+    size_t m_offset;
+    ///! Line at the start of the buffer (from 1)
+    size_t m_line;
+    ///! Position of the start of the line in the file
+    size_t m_lineStart;
+};
+
+#endif	/* CXMLPUSHREADER_H */
+
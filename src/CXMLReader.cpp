@@ -0,0 +1,399 @@
+#include <cstdlib>
+
+#include "CXMLReader.h"
+#include "CException.h"
+#include "functions.h"
+
+using namespace std;
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates new reader of given data.
+ * \param data Pointer to the data, texts sent to the handler point to it.
+ * \param size Size of the data.
+ * \param filePath File name (for exceptions).
+ * \param handler Pointer to the receiver of the events.
+ */
+CXMLReader::CXMLReader(const char * data, size_t size, const string & filePath, CXMLHandler * handler)
+: m_scanner(data, size) {
+    m_data = data;
+    m_size = size;
+    m_filePath = filePath;
+    m_handler = handler;
+    m_tagPos = 0;
+}
+
+/*! Reads the whole document, there must be exactly one root element.
+ */
+void CXMLReader::Read() {
+    size_t pos = 0;
+    int rootType = END_OF_FILE;
+
+    //sends version data, if there are any
+    StoreVersionData(pos);
+
+    //starts reading XML
+    CText nextTag;
+    int nextTagType = TellTypeOfNextNode(pos, m_size, nextTag);
+
+    //reading continues until EOF, or when an format error is detected
+    while (nextTagType != END_OF_FILE) {
+        ReadNode(nextTagType, nextTag, pos);
+        m_handler->Position(pos);
+
+        //root end tag won't be read here, so stack cannot be free here
+        //there can be only one root element!
+        if (nextTagType == NEXT_IS_ENDTAG && m_stack.GetStackCnt() == 0)
+            throw InvalidXMLFormatException(m_filePath, pos);
+
+        //was it the first node?
+        if (rootType == END_OF_FILE) {
+            rootType = nextTagType;
+        }
+
+        //continue reading...
+        nextTagType = TellTypeOfNextNode(pos, m_size, nextTag);
+
+        //if root element is not parent, there can be only one element at all
+        if (nextTagType != END_OF_FILE && rootType != NEXT_IS_PARENTNODE)
+            throw InvalidXMLFormatException(m_filePath, m_tagPos);
+    }
+
+    //the file has ended, stack must be free (after poping the root...)
+    CText title = m_stack.Pop();
+    if (nextTag.Sub(1, nextTag.GetLength()) != title)
+        throw InvalidXMLFormatException(m_filePath, m_tagPos);
+    if (m_stack.GetStackCnt() > 0) {
+        throw InvalidXMLFormatException(m_filePath, m_size);
+    }
+    m_handler->EndElement(title);
+    m_handler->Markup(CText(nextTag.GetData() - 1, nextTag.GetLength() + 2));
+}
+
+/*! Reads version data and start tag of the root, the rest of the document can be read by ReadRange.
+ * \return Position after the root start tag, or 0 if the root is not a parent node (nothing is sent then).
+ */
+size_t CXMLReader::ReadRootStart() {
+    size_t pos = 0;
+    StoreVersionData(pos);
+
+    CText nextTag;
+    if (TellTypeOfNextNode(pos, m_size, nextTag) != NEXT_IS_PARENTNODE)
+        return 0;
+    ReadNode(NEXT_IS_PARENTNODE, nextTag, pos);
+    return pos;
+}
+
+/*! Reads sibling elements between given positions, all of them must be closed there.
+ * \param begin Position of the first element.
+ * \param end Position after the last element.
+ */
+void CXMLReader::ReadRange(size_t begin, size_t end) {
+    size_t pos = begin;
+
+    CText nextTag;
+    int nextTagType = TellTypeOfNextNode(pos, end, nextTag);
+    while (nextTagType != END_OF_FILE) {
+        ReadNode(nextTagType, nextTag, pos);
+        m_handler->Position(pos);
+        nextTagType = TellTypeOfNextNode(pos, end, nextTag);
+    }
+
+    //all elements in the range must be closed
+    if (m_stack.GetStackCnt() > 0)
+        throw InvalidXMLFormatException(m_filePath, end);
+}
+
+/*! Position of the last read tag, errors of titles and attributes are there.
+ * \return Position of the < character of the tag.
+ */
+size_t CXMLReader::GetTagPosition() const {
+    return m_tagPos;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Checks the tag (and text after it) and sends it to the handler.
+ * \param type The type of the node, specified by constants.
+ * \param nextTag Content of the tag.
+ * \param pos Position in the data after the tag.
+ */
+void CXMLReader::ReadNode(int type, const CText & nextTag, size_t & pos) {
+    //ncurses has problems with characters outside ASCII table, so remove them
+    CText tag = MakeASCII(nextTag);
+    //the markup is sent as it is in the data (with < and >)
+    CText markup(nextTag.GetData() - 1, nextTag.GetLength() + 2);
+    if (type == NEXT_IS_PARENTNODE) {
+        //get the title
+        CText title = ExtractXMLTitle(tag);
+        CheckTitle(title);
+
+        m_stack.Push(title); //next end tag will have to be at the top of the stack
+
+        //parse attributes of this element
+        ParseAttributes(tag);
+
+        //the handler may not want the content now (it starts right after the tag)
+        bool content = m_handler->StartElement(title, m_attributes, type);
+        m_handler->Markup(markup);
+        if (!content)
+            SkipContent(pos, nextTag.GetData() + nextTag.GetLength() + 1 - m_data);
+    } else if (type == NEXT_IS_TEXTNODE) {
+        //get the title and value (value is made only ASCII)
+        CText title = ExtractXMLTitle(tag);
+        CText value = MakeASCII(ExtractTextNodeValue(pos));
+        CheckTitle(title);
+
+        //parse attributes of this element
+        ParseAttributes(tag);
+
+        m_handler->StartElement(title, m_attributes, type);
+        m_handler->Text(value);
+
+        //extract the end tag of the text element from the data
+        ExtractTextNodeEndTag(pos, title);
+        m_handler->EndElement(title);
+        m_handler->Markup(CText(markup.GetData(), m_data + pos - markup.GetData()));
+    } else if (type == NEXT_IS_COMMENT) {
+        //get the comment text (made only ASCII together with the tag)
+        m_handler->Comment(ExtractCommentNodeValue(tag));
+        m_handler->Markup(markup);
+    } else if (type == NEXT_IS_SIMPLE) {
+        //remove the '/' from the end of tag
+        tag = tag.Sub(0, tag.GetLength() - 1);
+
+        //get the title
+        CText title = ExtractXMLTitle(tag);
+        CheckTitle(title);
+
+        //parse attributes of this element
+        ParseAttributes(tag);
+
+        m_handler->StartElement(title, m_attributes, type);
+        m_handler->EndElement(title);
+        m_handler->Markup(markup);
+    } else if (type == NEXT_IS_ENDTAG) {
+        //this endtag must be on the top of the stack, or it is an error!
+        //Sub removes the '/' from the start of the tag
+        if (m_stack.GetStackCnt() == 0)
+            throw InvalidXMLFormatException(m_filePath, m_tagPos);
+        CText title = m_stack.Pop();
+        if (tag.Sub(1, tag.GetLength()) != title)
+            throw InvalidXMLFormatException(m_filePath, m_tagPos);
+
+        m_handler->EndElement(title);
+        m_handler->Markup(markup);
+    }
+}
+
+/*! Skips the content of the parent element, which was just started. Only tags are counted
+ * to find its end tag, the content is checked when it is read later.
+ * \param pos Position in the data after the start tag, it is moved after the end tag.
+ * \param begin Position of the content (right after the start tag).
+ */
+void CXMLReader::SkipContent(size_t & pos, size_t begin) {
+    size_t start, end;
+    int depth = 1;
+    while (true) {
+        start = m_scanner.FindTagStart(pos);
+        end = m_scanner.FindTagEnd(start + 1);
+        if (end >= m_size) //element is not closed
+            throw InvalidXMLFormatException(m_filePath, m_size);
+        pos = end + 1;
+
+        if (m_data[start + 1] == 47) { //end tag
+            if (--depth == 0)
+                break;
+        } else {
+            bool simple = m_data[end - 1] == 47;
+            bool comment = end - start > 3 && m_data[start + 1] == 33 && m_data[start + 2] == 45 && m_data[start + 3] == 45;
+            if (!simple && !comment)
+                depth++;
+        }
+    }
+
+    //the end tag must match as any other end tag
+    CText tag = MakeASCII(CText(m_data + start + 1, end - (start + 1)));
+    CText title = m_stack.Pop();
+    if (tag.Sub(1, tag.GetLength()) != title)
+        throw InvalidXMLFormatException(m_filePath, start);
+
+    m_handler->Skipped(CText(m_data + begin, start - begin));
+    m_handler->EndElement(title);
+    m_handler->Markup(CText(m_data + start, end + 1 - start));
+}
+
+/********************* PARSING TOOLS *******************************/
+
+/*! At start of the file, there can be some version information, this method sends them to the handler.
+ * \param pos Position in the data.
+ */
+void CXMLReader::StoreVersionData(size_t & pos) {
+    IgnoreNextWhitespaces(pos);
+    if (pos >= m_size || m_data[pos] != 60) // there must be < character
+        throw InvalidXMLFormatException(m_filePath, pos);
+
+    //if the next character is ?, it is the header info
+    if (pos + 1 < m_size && m_data[pos + 1] == 63) {
+        size_t end = m_scanner.FindTagEnd(pos);
+        if (end >= m_size)
+            throw InvalidXMLFormatException(m_filePath, pos);
+        m_handler->VersionData(CText(m_data + pos, end + 1 - pos));
+        pos = end + 1;
+        IgnoreNextWhitespaces(pos);
+    }
+}
+
+/*! Ignores white spaces in the data.
+ * \param pos Position in the data, it is moved after the white spaces.
+ */
+void CXMLReader::IgnoreNextWhitespaces(size_t & pos) {
+    pos = m_scanner.SkipWhitespaces(pos); //SPACE, TAB, CR, LF
+}
+
+/*! Main parsing function, it find out the type of next node and saves the node (content between < > to the I/O variable
+ * \param pos Position in the data.
+ * \param end Position, where the read part ends (no tag can start there).
+ * \param tag To this text is saved content of the next tag (it points to the data).
+ * \return The type of next node, specified by constants.
+ */
+int CXMLReader::TellTypeOfNextNode(size_t & pos, size_t end, CText & tag) {
+    tag = CText();
+    IgnoreNextWhitespaces(pos);
+    if (pos >= end) {
+        m_tagPos = pos; //missing end tag of the root is reported at the end
+        return END_OF_FILE;
+    }
+    if (m_data[pos] != 60) // after white spaces, there must be < character
+        throw InvalidXMLFormatException(m_filePath, pos);
+
+    // looking for > char, other chars are the tag
+    m_tagPos = pos;
+    size_t tagEnd = m_scanner.FindTagEnd(pos);
+    if (tagEnd >= m_size)
+        throw InvalidXMLFormatException(m_filePath, pos);
+    tag = CText(m_data + pos + 1, tagEnd - (pos + 1));
+    pos = tagEnd + 1;
+
+    //now look what's next
+
+    IgnoreNextWhitespaces(pos);
+    if (pos >= m_size)
+        return END_OF_FILE;
+    if (m_data[pos] == 60) { //it is another tag!
+        if (tag.GetLength() && tag.GetData()[0] == 47) //is it end tag?
+            return NEXT_IS_ENDTAG;
+        else if (IsValidSimpleTag(tag)) {
+            return NEXT_IS_SIMPLE;
+        } else if (IsValidComment(tag)) {
+            return NEXT_IS_COMMENT;
+        } else {
+            return NEXT_IS_PARENTNODE;
+        }
+    } else { //its some kind of text
+        return NEXT_IS_TEXTNODE;
+    }
+}
+
+/*! Element titles are checked by the same rules as titles of the nodes.
+ * \param title Element title.
+ */
+void CXMLReader::CheckTitle(const CText & title) const {
+    if (!IsValidTitle(title))
+        throw InvalidXMLTitleException(title.GetString());
+}
+
+/*! Function for parsing attributes, it finds attributes in the text and saves them to the attribute list.
+ * \param x Text, from which attributes are parsed.
+ */
+void CXMLReader::ParseAttributes(const CText & x) {
+    m_attributes.Clear();
+
+    const char * data = x.GetData();
+    size_t length = x.GetLength();
+    for (size_t i = 0; i < length; i++) { //go through the whole text
+        if (data[i] == 32) { // after first space come attributes
+            i++;
+            if (i >= length)
+                break;
+            i = IgnoreNextWhiteSpaces(x, i);
+            size_t attr = i;
+            while (i < length && data[i] != 61) { //looking for attr separator, which is =
+                if (data[i] == 32) { //there cannot be space without =
+                    throw InvalidXMLFormatException(m_filePath, m_tagPos + 1 + i);
+                }
+                i++;
+            }
+            size_t attrLength = i - attr;
+            //now there should be " or '
+            i++;
+            size_t value = i + 1;
+            if (i < length && (data[i] == 34 || data[i] == 39)) {
+                char quotes = data[i]; // i will be looking for the same quotes as the end tag
+                i++;
+                while (i < length && data[i] != quotes) {
+                    i++;
+                }
+            } else
+                throw InvalidXMLFormatException(m_filePath, m_tagPos + 1 + i);
+
+            //same rules as for attributes of the nodes
+            CText name = x.Sub(attr, attrLength);
+            if (!IsValidTitle(name))
+                throw InvalidXMLTitleException(name.GetString());
+            if (m_attributes.Exists(name))
+                throw AttributeAlreadyExistsException(name.GetString());
+            m_attributes.Add(name, x.Sub(value, i - value));
+
+            i = IgnoreNextWhiteSpaces(x, i);
+        }
+    }
+}
+
+/*! Gets the value of text node from the data.
+ * \param pos Position in the data.
+ * \return The text node value (it points to the data).
+ */
+CText CXMLReader::ExtractTextNodeValue(size_t & pos) {
+    //until there is an <
+    size_t end = m_scanner.FindTagStart(pos);
+    if (end >= m_size)
+        throw InvalidXMLFormatException(m_filePath, pos);
+    CText ret(m_data + pos, end - pos);
+    pos = end;
+    return ret;
+}
+
+/*! Text node has to have its end tag right after the text value. Extract it out from the data.
+ * \param pos Position in the data.
+ * \param title Title of the text node.
+ */
+void CXMLReader::ExtractTextNodeEndTag(size_t & pos, const CText & title) {
+    //i know there is a tag - and it must be the end tag of my title
+    if (pos >= m_size || m_data[pos] != 60)
+        throw InvalidXMLFormatException(m_filePath, pos);
+    if (pos + 1 >= m_size || m_data[pos + 1] != 47) // second character must be /
+        throw InvalidXMLFormatException(m_filePath, pos);
+    size_t start = pos;
+    pos += 2;
+    size_t end = m_scanner.FindTagEnd(pos);
+    if (end >= m_size)
+        throw InvalidXMLFormatException(m_filePath, start);
+    CText endtag(m_data + pos, end - pos);
+    pos = end + 1;
+
+    //final comparison
+    if (endtag != title)
+        throw InvalidXMLFormatException(m_filePath, start);
+}
+
+/*! Gets the value of comment node from the comment tag.
+ * \param x The comment node text.
+ * \return The comment node value.
+ */
+CText CXMLReader::ExtractCommentNodeValue(const CText & x) const {
+    // first 3 characters of the comment and last 2 are not interesting
+    if (x.GetLength() < 6)
+        return CText();
+    return x.Sub(4, x.GetLength() - 6);
+}
@@ -0,0 +1,57 @@
+#ifndef CXMLREADER_H
+#define	CXMLREADER_H
+
+#include <cstdlib>
+#include <string>
+
+#include "CText.h"
+#include "CTagStack.h"
+#include "CScanner.h"
+#include "CXMLHandler.h"
+
+using namespace std;
+
+///! Class, which reads XML data (usually mapped file), checks it and sends its elements to a handler, no tree is built.
+
+class CXMLReader {
+public:
+    CXMLReader(const char * data, size_t size, const string & filePath, CXMLHandler * handler);
+
+    void Read();
+    size_t ReadRootStart();
+    void ReadRange(size_t begin, size_t end);
+    size_t GetTagPosition() const;
+protected:
+    void ReadNode(int type, const CText & nextTag, size_t & pos);
+    void SkipContent(size_t & pos, size_t begin);
+
+    //parsing tools
+    void StoreVersionData(size_t & pos);
+    void IgnoreNextWhitespaces(size_t & pos);
+    int TellTypeOfNextNode(size_t & pos, size_t end, CText & tag);
+    void CheckTitle(const CText & title) const;
+    void ParseAttributes(const CText & x);
+    CText ExtractTextNodeValue(size_t & pos);
+    void ExtractTextNodeEndTag(size_t & pos, const CText & title);
+    CText ExtractCommentNodeValue(const CText & x) const;
+
+    ///! Pointer to the read data
+    const char * m_data;
+    ///! Size of the read data
+    size_t m_size;
+    ///! File name (for exceptions)
+    string m_filePath;
+    ///! Receiver of the events
+    CXMLHandler * m_handler;
+    ///! Scanner of structural characters
+    CScanner m_scanner;
+    ///! Stack of open elements
+    CTagStack m_stack;
+    ///! Attributes of the current element
+    CAttributeList m_attributes;
+    ///! Position of the last read tag (for errors)
+    size_t m_tagPos;
+};
+
+#endif	/* CXMLREADER_H */
+
@@ -0,0 +1,490 @@
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "CXMLWriter.h"
+#include "CProgress.h"
+#include "CEncoder.h"
+#include "functions.h"
+
+///! Size of one output buffer
+#define WRITER_BUFFER_SIZE (1024 * 1024)
+///! Smaller blocks are copied to the buffers
+#define WRITER_BLOCK_MIN (64 * 1024)
+///! Maximal count of indentation characters written at once
+#define WRITER_MAX_INDENT 64
+///! When reallocing, how many times will new array will be bigger
+#define REALLOC_CONSTANT 2
+
+using namespace std;
+
+/*! Gets the mask of permissions of new files, it is read before other threads are started.
+ */
+static mode_t GetUmask() {
+    mode_t mask = umask(0);
+    umask(mask);
+    return mask;
+}
+
+///! Mask of permissions of new files
+static const mode_t s_umask = GetUmask();
+
+/********************* PUBLIC METHODS *******************************/
+
+/*! Creates the snapshot writer, the data are kept in memory, until they are written by WriteFile.
+ */
+CXMLWriter::CXMLWriter() {
+    m_fd = -1;
+    m_snapshot = true;
+    m_failed = false;
+    m_format = WRITER_SOURCE;
+    m_isCopying = false;
+    m_encoder = NULL;
+    CreateBuffers();
+}
+
+/*! Creates the file for writing, it replaces the existing file, when it is closed.
+ * \param filePath Specifies the file.
+ */
+CXMLWriter::CXMLWriter(const string & filePath) {
+    m_snapshot = false;
+    Open(filePath);
+    m_format = WRITER_SOURCE;
+    m_isCopying = false;
+    m_encoder = NULL;
+    CreateBuffers();
+}
+
+/*! Creates the writer of an open file (like the standard output), the file stays open after Close.
+ * \param fd Descriptor of the file.
+ */
+CXMLWriter::CXMLWriter(int fd) {
+    m_fd = dup(fd);
+    m_snapshot = false;
+    m_failed = m_fd < 0;
+    m_format = WRITER_SOURCE;
+    m_isCopying = false;
+    m_encoder = NULL;
+    CreateBuffers();
+}
+
+/*! Closes the file (unwritten data are lost, Close writes them, and the replaced file stays) and frees the buffers.
+ */
+CXMLWriter::~CXMLWriter() {
+    if (m_fd >= 0)
+        close(m_fd);
+    if (!m_tmpPath.empty())
+        unlink(m_tmpPath.c_str());
+    delete m_encoder;
+    for (int i = 0; i < m_buffersSize; i++)
+        delete [] m_buffers[i];
+    delete [] m_buffers;
+    delete [] m_parts;
+    for (int i = 0; i < m_cntAppended; i++)
+        delete m_appended[i];
+    delete [] m_appended;
+}
+
+/********************* WRITING *******************************/
+
+/*! Copies the data to the buffers.
+ * \param data Pointer to the data.
+ * \param length Count of bytes.
+ */
+void CXMLWriter::Write(const char * data, size_t length) {
+    while (length > 0) {
+        if (m_used == WRITER_BUFFER_SIZE)
+            NextBuffer();
+        size_t count = WRITER_BUFFER_SIZE - m_used;
+        if (count > length)
+            count = length;
+        memcpy(m_buffers[m_buffer] + m_used, data, count);
+        m_used += count;
+        data += count;
+        length -= count;
+    }
+}
+
+/*! Copies the string to the buffers.
+ * \param str Null terminated string.
+ */
+void CXMLWriter::Write(const char * str) {
+    Write(str, strlen(str));
+}
+
+/*! Copies the text to the buffers.
+ * \param text The text.
+ */
+void CXMLWriter::Write(const CText & text) {
+    Write(text.GetData(), text.GetLength());
+}
+
+/*! Writes big block of data without copying, it must exist until the writer is closed (or it is copied,
+ * if the writer is copying).
+ * \param block The data (usually a part of the mapped file).
+ */
+void CXMLWriter::WriteBlock(const CText & block) {
+    if (block.GetLength() < WRITER_BLOCK_MIN || m_isCopying) {
+        Write(block);
+        return;
+    }
+    //the buffered data go first
+    AddBuffered();
+    AddPart(block.GetData(), block.GetLength());
+}
+
+/*! Writes the indentation of a line.
+ * \param depth Count of tabs.
+ */
+void CXMLWriter::WriteIndent(int depth) {
+    static const char tabs[WRITER_MAX_INDENT + 1] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+            "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    for (; depth > WRITER_MAX_INDENT; depth -= WRITER_MAX_INDENT)
+        Write(tabs, WRITER_MAX_INDENT);
+    Write(tabs, depth);
+}
+
+/*! Ends the line.
+ */
+void CXMLWriter::WriteLine() {
+    if (m_used == WRITER_BUFFER_SIZE)
+        NextBuffer();
+    m_buffers[m_buffer][m_used++] = '\n';
+}
+
+/*! Appends the data of the snapshot writer (written by other thread) without copying.
+ * Copying writer copies them, because they may point to the document.
+ * \param writer The snapshot writer, it is deleted together with this writer (or at once, if it is copied).
+ */
+void CXMLWriter::Append(CXMLWriter * writer) {
+    writer->AddBuffered();
+    if (m_isCopying) {
+        for (int i = 0; i < writer->m_cntParts; i++)
+            Write((const char *) writer->m_parts[i].iov_base, writer->m_parts[i].iov_len);
+        delete writer;
+        return;
+    }
+    AddBuffered();
+    for (int i = 0; i < writer->m_cntParts; i++)
+        AddPart((const char *) writer->m_parts[i].iov_base, writer->m_parts[i].iov_len);
+    writer->m_cntParts = 0;
+
+    //the buffers must exist, until the parts are written
+    if (m_cntAppended == m_appendedSize)
+        ReallocAppended();
+    m_appended[m_cntAppended++] = writer;
+}
+
+/*! Writes all waiting data and closes the file, the written file replaces the original one then.
+ * \return False, if the file could not be opened, or some data could not be written.
+ */
+bool CXMLWriter::Close() {
+    if (m_fd >= 0) {
+        Flush();
+        //the end of the compressed stream
+        if (m_encoder)
+            Compress(NULL, 0, true);
+        //the data have to be on the disk, before the original file is replaced
+        if (!m_tmpPath.empty() && fsync(m_fd) < 0)
+            m_failed = true;
+        if (close(m_fd) < 0)
+            m_failed = true;
+        m_fd = -1;
+    }
+    if (!m_tmpPath.empty()) {
+        if (m_failed || rename(m_tmpPath.c_str(), m_filePath.c_str()) < 0) {
+            unlink(m_tmpPath.c_str());
+            m_failed = true;
+        }
+        m_tmpPath.clear();
+    }
+    return !m_failed;
+}
+
+/********************* SNAPSHOT *******************************/
+
+/*! Writes the whole snapshot to the file, the writer is not used any more then.
+ * It can run in other thread, because the snapshot does not point to the nodes.
+ * \param filePath Specifies the file.
+ * \param progress Counts written bytes (it can be NULL).
+ * \return False, if the file could not be opened, or some data could not be written.
+ */
+bool CXMLWriter::WriteFile(const string & filePath, CProgress * progress) {
+    AddBuffered();
+    size_t size = 0;
+    for (int i = 0; i < m_cntParts; i++)
+        size += m_parts[i].iov_len;
+    if (progress)
+        progress->Start(size);
+
+    //the file is not created, if its compression is not supported
+    if (!m_failed)
+        Open(filePath);
+    for (int i = 0; i < m_cntParts && !m_failed; i += WRITER_PARTS) {
+        int cnt = m_cntParts - i < WRITER_PARTS ? m_cntParts - i : WRITER_PARTS;
+        size_t bytes = 0;
+        for (int j = i; j < i + cnt; j++)
+            bytes += m_parts[j].iov_len;
+        WriteParts(m_parts + i, cnt);
+        if (progress)
+            progress->Add(bytes, 0);
+    }
+    m_cntParts = 0;
+    return Close();
+}
+
+/*! Was the file opened?
+ */
+bool CXMLWriter::IsOpen() const {
+    return m_fd >= 0;
+}
+
+/*! Gets the format, in which the nodes print themselves.
+ */
+int CXMLWriter::GetFormat() const {
+    return m_format;
+}
+
+/*! Sets the format, in which the nodes print themselves (WRITER_SOURCE by default).
+ * \param format WRITER_SOURCE, WRITER_PRETTY or WRITER_MINIFY.
+ */
+void CXMLWriter::SetFormat(int format) {
+    m_format = format;
+}
+
+/*! Sets, if big blocks are copied to the buffers too, so the snapshot does not point to the document
+ * and it can be written after the document is freed.
+ * \param copying Copy the blocks?
+ */
+void CXMLWriter::SetCopying(bool copying) {
+    m_isCopying = copying;
+}
+
+/*! Sets the compression of the written data, it has to be set before anything is written.
+ * \param compression DECODER_NONE, DECODER_GZIP or DECODER_ZSTD (zstd only if it is built with HAVE_ZSTD).
+ * \return False, if the compression is not supported (nothing will be written then).
+ */
+bool CXMLWriter::SetCompression(int compression) {
+    if (compression == DECODER_NONE)
+        return true;
+    m_encoder = new CEncoder(compression);
+    if (m_encoder->IsFailed())
+        m_failed = true;
+    return !m_failed;
+}
+
+/*! Counts the threads printing the childs of the root, each of them gets PRINT_MIN_PART childs at least,
+ * there are not more threads than processors (or than XMLEDITOR_THREADS says).
+ * \param childs Count of childs of the root.
+ * \return Count of threads, 1 if the childs are printed by the calling thread.
+ */
+int CXMLWriter::CountPrintThreads(int childs) {
+    if (childs < PRINT_PARALLEL_MIN_CHILDS)
+        return 1;
+    int threads = CountProcessors();
+    if (threads > childs / PRINT_MIN_PART)
+        threads = childs / PRINT_MIN_PART;
+    if (threads > PRINT_MAX_THREADS)
+        threads = PRINT_MAX_THREADS;
+    return threads > 1 ? threads : 1;
+}
+
+/********************* PRIVATE METHODS *******************************/
+
+/*! Creates the temporary file in the directory of the file (so it can be renamed), the links are resolved,
+ * so the target of a link is replaced. The temporary file gets the permissions of the replaced file.
+ * \param filePath Specifies the file.
+ */
+void CXMLWriter::Open(const string & filePath) {
+    char * resolved = realpath(filePath.c_str(), NULL);
+    m_filePath = resolved ? resolved : filePath;
+    free(resolved);
+
+    struct stat info;
+    mode_t mode = stat(m_filePath.c_str(), &info) == 0 ? info.st_mode & 07777 : 0666 & ~s_umask;
+    size_t slash = m_filePath.rfind('/');
+    string directory = slash == string::npos ? "" : m_filePath.substr(0, slash + 1);
+    string name = slash == string::npos ? m_filePath : m_filePath.substr(slash + 1);
+    string pattern = directory + "." + name + ".XXXXXX";
+
+    char * tmpPath = new char [pattern.length() + 1];
+    memcpy(tmpPath, pattern.c_str(), pattern.length() + 1);
+    m_fd = mkstemp(tmpPath);
+    if (m_fd >= 0)
+        m_tmpPath = tmpPath;
+    delete [] tmpPath;
+    m_failed = m_fd < 0 || fchmod(m_fd, mode) < 0;
+}
+
+/*! Adds the part to the waiting parts, they are written, when there is no place for next part.
+ * \param data Pointer to the data.
+ * \param length Count of bytes (empty parts are ignored).
+ */
+void CXMLWriter::AddPart(const char * data, size_t length) {
+    if (length == 0)
+        return;
+    if (m_cntParts == m_partsSize)
+        ReallocParts();
+    m_parts[m_cntParts].iov_base = (void *) data;
+    m_parts[m_cntParts].iov_len = length;
+    if (++m_cntParts == WRITER_PARTS && !m_snapshot)
+        Flush();
+}
+
+/*! Adds the data of current buffer, which are not in the parts yet, to the waiting parts.
+ */
+void CXMLWriter::AddBuffered() {
+    const char * data = m_buffers[m_buffer] + m_partStart;
+    size_t length = m_used - m_partStart;
+    //the part must not be added again, if the parts are written now
+    m_partStart = m_used;
+    AddPart(data, length);
+}
+
+/*! Moves to the next buffer, when current is full, all buffers are written, when the last is full.
+ * The snapshot only gets new buffer.
+ */
+void CXMLWriter::NextBuffer() {
+    AddBuffered();
+    if (!m_snapshot && (m_cntParts == 0 || m_buffer + 1 == WRITER_BUFFERS)) {
+        //the parts were written, so all buffers are free
+        Flush();
+        return;
+    }
+    if (++m_buffer == m_buffersSize)
+        ReallocBuffers();
+    if (m_buffers[m_buffer] == NULL)
+        m_buffers[m_buffer] = new char [WRITER_BUFFER_SIZE];
+    m_used = 0;
+    m_partStart = 0;
+}
+
+/*! Writes all waiting parts (with the rest of current buffer) by writev, all buffers are free then.
+ */
+void CXMLWriter::Flush() {
+    //there is always place for one part
+    if (m_used > m_partStart) {
+        m_parts[m_cntParts].iov_base = m_buffers[m_buffer] + m_partStart;
+        m_parts[m_cntParts].iov_len = m_used - m_partStart;
+        m_cntParts++;
+    }
+
+    WriteParts(m_parts, m_cntParts);
+
+    m_cntParts = 0;
+    m_buffer = 0;
+    m_used = 0;
+    m_partStart = 0;
+}
+
+/*! Writes the parts to the file, compressed data are written from the buffer of the compression.
+ * \param parts The parts.
+ * \param cnt Count of the parts (at most WRITER_PARTS).
+ */
+void CXMLWriter::WriteParts(struct iovec * parts, int cnt) {
+    if (m_encoder == NULL) {
+        WriteVector(parts, cnt);
+        return;
+    }
+    for (int i = 0; i < cnt && !m_failed; i++)
+        Compress((const char *) parts[i].iov_base, parts[i].iov_len, false);
+}
+
+/*! Writes the parts to the file by writev, the parts are changed by partial writes.
+ * \param parts The parts.
+ * \param cnt Count of the parts (at most WRITER_PARTS).
+ */
+void CXMLWriter::WriteVector(struct iovec * parts, int cnt) {
+    while (cnt > 0 && !m_failed) {
+        ssize_t written = writev(m_fd, parts, cnt);
+        if (written < 0) {
+            if (errno != EINTR)
+                m_failed = true;
+            continue;
+        }
+        //partial write continues from the first unwritten byte
+        while (cnt > 0 && (size_t) written >= parts->iov_len) {
+            written -= parts->iov_len;
+            parts++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            parts->iov_base = (char *) parts->iov_base + written;
+            parts->iov_len -= written;
+        }
+    }
+}
+
+/*! Compresses the data and writes the compressed data, whenever the buffer of the compression is full.
+ * \param data Pointer to the data.
+ * \param length Count of bytes.
+ * \param isLast Is it the end of the file (the rest of the compressed stream is written)?
+ */
+void CXMLWriter::Compress(const char * data, size_t length, bool isLast) {
+    struct iovec part;
+    m_encoder->SetInput(data, length, isLast);
+    while ((part.iov_base = (void *) m_encoder->Next(part.iov_len)) != NULL && !m_failed)
+        WriteVector(&part, part.iov_len > 0 ? 1 : 0);
+    if (m_encoder->IsFailed())
+        m_failed = true;
+}
+
+/********************* MEMORY MANAGEMENT *******************************/
+
+/*! Creates the first buffer and the parts, other buffers are allocated, when they are needed.
+ */
+void CXMLWriter::CreateBuffers() {
+    m_buffersSize = WRITER_BUFFERS;
+    m_buffers = new char * [m_buffersSize];
+    for (int i = 0; i < m_buffersSize; i++)
+        m_buffers[i] = NULL;
+    m_buffers[0] = new char [WRITER_BUFFER_SIZE];
+    m_buffer = 0;
+    m_used = 0;
+    m_partStart = 0;
+    m_partsSize = WRITER_PARTS;
+    m_parts = new struct iovec [m_partsSize];
+    m_cntParts = 0;
+    m_appended = NULL;
+    m_appendedSize = 0;
+    m_cntAppended = 0;
+}
+
+/*! Buffers memory management, new buffers of the snapshot are allocated, when they are needed.
+ */
+void CXMLWriter::ReallocBuffers() {
+    int size = m_buffersSize * REALLOC_CONSTANT;
+    char ** tmp = new char * [size];
+    for (int i = 0; i < size; i++)
+        tmp[i] = i < m_buffersSize ? m_buffers[i] : NULL;
+    delete [] m_buffers;
+    m_buffers = tmp;
+    m_buffersSize = size;
+}
+
+/*! Parts memory management, only the snapshot has more than WRITER_PARTS parts.
+ */
+void CXMLWriter::ReallocParts() {
+    int size = m_partsSize * REALLOC_CONSTANT;
+    struct iovec * tmp = new struct iovec [size];
+    memcpy(tmp, m_parts, m_cntParts * sizeof (struct iovec));
+    delete [] m_parts;
+    m_parts = tmp;
+    m_partsSize = size;
+}
+
+/*! Appended writers memory management, the array is allocated, when the first writer is appended.
+ */
+void CXMLWriter::ReallocAppended() {
+    int size = m_appendedSize ? m_appendedSize * REALLOC_CONSTANT : WRITER_BUFFERS;
+    CXMLWriter ** tmp = new CXMLWriter * [size];
+    for (int i = 0; i < m_cntAppended; i++)
+        tmp[i] = m_appended[i];
+    delete [] m_appended;
+    m_appended = tmp;
+    m_appendedSize = size;
+}
@@ -0,0 +1,123 @@
+#ifndef CXMLWRITER_H
+#define	CXMLWRITER_H
+
+#include <cstdlib>
+#include <string>
+#include <sys/uio.h>
+
+#include "CText.h"
+
+using namespace std;
+
+class CProgress;
+class CEncoder;
+
+///! Count of output buffers, they are written by one system call, when they are full
+#define WRITER_BUFFERS 8
+///! Count of parts written by one system call (parts of the buffers and big blocks)
+#define WRITER_PARTS 64
+
+///! Format of the document, unchanged nodes are copied from the file with their white spaces
+#define WRITER_SOURCE 0
+///! Format of the document, every node is on its own line indented by tabs
+#define WRITER_PRETTY 1
+///! Format of the document, there are no white spaces between the nodes
+#define WRITER_MINIFY 2
+///! Childs of the root are printed by more threads, if there are more of them
+#define PRINT_PARALLEL_MIN_CHILDS 1024
+///! Minimal count of childs printed by one thread
+#define PRINT_MIN_PART 256
+///! Maximal count of printing threads
+#define PRINT_MAX_THREADS 64
+
+///! Class, which writes serialized document to a file. Small texts are copied to big reusable buffers,
+///! which are written at once by writev, big blocks of data (unparsed childs) are written from their place.
+///! The snapshot writer keeps all the data in memory, so the document can change, while they are written.
+///! The data can be compressed in the format of the decoder, before they are written. Files are written to a temporary
+///! file next to them, which replaces the file (or the target of its link), when it is complete.
+
+class CXMLWriter {
+public:
+    CXMLWriter();
+    CXMLWriter(const string & filePath);
+    CXMLWriter(int fd);
+    ~CXMLWriter();
+
+    //writing
+    void Write(const char * data, size_t length);
+    void Write(const char * str);
+    void Write(const CText & text);
+    void WriteBlock(const CText & block);
+    void WriteIndent(int depth);
+    void WriteLine();
+    void Append(CXMLWriter * writer);
+    bool Close();
+
+    //snapshot
+    bool WriteFile(const string & filePath, CProgress * progress);
+
+    bool IsOpen() const;
+    int GetFormat() const;
+    void SetFormat(int format);
+    void SetCopying(bool copying);
+    bool SetCompression(int compression);
+
+    static int CountPrintThreads(int childs);
+protected:
+    void Open(const string & filePath);
+    void AddPart(const char * data, size_t length);
+    void AddBuffered();
+    void NextBuffer();
+    void Flush();
+    void WriteParts(struct iovec * parts, int cnt);
+    void WriteVector(struct iovec * parts, int cnt);
+    void Compress(const char * data, size_t length, bool isLast);
+
+    //memory management
+    void CreateBuffers();
+    void ReallocBuffers();
+    void ReallocParts();
+    void ReallocAppended();
+
+    ///! Descriptor of the file, -1 if it is not open
+    int m_fd;
+    ///! Path of the replaced file with resolved links
+    string m_filePath;
+    ///! Path of the temporary file, which replaces the file, empty if the file is not replaced
+    string m_tmpPath;
+    ///! Are the data kept in memory, until they are written by WriteFile?
+    bool m_snapshot;
+    ///! Did a write fail?
+    bool m_failed;
+    ///! Format of the document (WRITER_SOURCE, WRITER_PRETTY, WRITER_MINIFY)
+    int m_format;
+    ///! Are big blocks copied too (they may not exist, when the data are written)?
+    bool m_isCopying;
+    ///! Encoder of the compressed file (NULL if the data are not compressed)
+    CEncoder * m_encoder;
+    ///! Output buffers (they are allocated, when they are needed first)
+    char ** m_buffers;
+    ///! Count of output buffers (only the snapshot gets more buffers)
+    int m_buffersSize;
+    ///! Index of current buffer
+    int m_buffer;
+    ///! Used bytes of current buffer
+    size_t m_used;
+    ///! Start of the part of current buffer, which is not in the parts yet
+    size_t m_partStart;
+    ///! Parts waiting for the write
+    struct iovec * m_parts;
+    ///! Current max count of parts
+    int m_partsSize;
+    ///! Count of waiting parts
+    int m_cntParts;
+    ///! Appended writers, their buffers are in the parts
+    CXMLWriter ** m_appended;
+    ///! Current max count of appended writers
+    int m_appendedSize;
+    ///! Count of appended writers
+    int m_cntAppended;
+};
+
+#endif	/* CXMLWRITER_H */
+
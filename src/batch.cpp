@@ -0,0 +1,19 @@
+/**
+ *
+ * Simple XML Editor in NCurses - command line without the interface
+ *
+ * @author Adam Kucera (kucerad5)
+ * @version 1.0 ( 5.6.2012 )
+ *
+ */
+
+#include <cstdlib>
+
+#include "CBatch.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    CBatch batch(argv[0]);
+    return batch.Run(argc, argv);
+}
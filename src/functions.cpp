@@ -1,5 +1,8 @@
+#include <unistd.h>
+
 #include "functions.h"
 #include "CXML.h"
+#include "CScanner.h"
 
 ///! Specifies that this title is valid.
 #define IS_VALID_TITLE true;
@@ -21,7 +24,16 @@
  * \return Returns if the string is valid XML title.
  */
 bool IsValidTitle(const string & x) {
-    if (!x.length())
+    return IsValidTitle(CText(x.data(), x.length()));
+}
+
+/*! Checks the validity of an XML title.
+ * \param text Text which is checked as XML title.
+ * \return Returns if the text is valid XML title.
+ */
+bool IsValidTitle(const CText & text) {
+    const char * x = text.GetData();
+    if (!text.GetLength())
         return IS_INVALID_TITLE;
 
     //first character must be a letter, : or _
@@ -29,7 +41,7 @@ bool IsValidTitle(const string & x) {
         return IS_INVALID_TITLE;
 
     //other characters can contain letters, numbers, :, ., _ and -
-    for (unsigned int i = 1; i < x.length(); i++) {
+    for (unsigned int i = 1; i < text.GetLength(); i++) {
         if (x[i] < 45 || x[i] == 47 || (x[i] > 58 && x[i] < 65) || (x[0] > 90 && x[0] < 95) || x[0] == 96 || x[0] > 122)
             return IS_INVALID_TITLE;
     }
@@ -37,15 +49,17 @@ bool IsValidTitle(const string & x) {
 }
 
 /*! Checks the validity of an XML comment.
- * \param x String which is checked as XML comment.
- * \return Returns if the string is valid XML comment.
+ * \param text Text which is checked as XML comment.
+ * \return Returns if the text is valid XML comment.
  */
-bool IsValidComment(const string & x) {
-    if (!x.length())
+bool IsValidComment(const CText & text) {
+    const char * x = text.GetData();
+    size_t length = text.GetLength();
+    if (length < 3)
         return IS_INVALID_COMMENT;
 
     //first characters must be !-- and last --
-    if (x[0] == 33 && x[1] == 45 && x[2] == 45 && x[x.length() - 1 == 45] && x[x.length() - 2 == 45]) {
+    if (x[0] == 33 && x[1] == 45 && x[2] == 45 && x[length - 1 == 45] && x[length - 2 == 45]) {
         return IS_VALID_COMMENT;
     } else {
         return IS_INVALID_COMMENT;
@@ -53,48 +67,55 @@ bool IsValidComment(const string & x) {
 }
 
 /*! Checks, if the given tag is simple tag.
- * \param x String which is checked as simple XML node.
- * \return Returns if the string is simple XML node.
+ * \param x Text which is checked as simple XML node.
+ * \return Returns if the text is simple XML node.
  */
-bool IsValidSimpleTag(const string & x) {
-    if (!x.length())
+bool IsValidSimpleTag(const CText & x) {
+    if (!x.GetLength())
         return IS_INVALID_SIMPLE_NODE;
 
     //last character must be /
-    if (x[x.length() - 1] == 47) {
+    if (x.GetData()[x.GetLength() - 1] == 47) {
         return IS_VALID_SIMPLE_NODE;
     } else {
         return IS_INVALID_SIMPLE_NODE;
     }
 }
 
+/*! Checks, if the text contains only characters, which MakeASCII keeps.
+ * \param x Text which is checked.
+ * \return Returns if MakeASCII would not change the text.
+ */
+bool IsASCII(const CText & x) {
+    const char * data = x.GetData();
+    for (size_t i = 0; i < x.GetLength(); i++) {
+        if (data[i] < 0 || data[i] == 10)
+            return false;
+    }
+    return true;
+}
+
 /********************* PARSING FUNCTIONS *******************************/
 
-/*! Gets the XML title from a string.
- * \param x String, where I will be looking for XML title.
+/*! Gets the XML title from a text.
+ * \param x Text, where I will be looking for XML title.
  * \return Returns the XML title.
  */
-string ExtractXMLTitle(const string & x) {
-    string ret;
-    for (unsigned int i = 0; i < x.length(); i++) {
-        if (x[i] != 32) //everything before first space is title
-            ret.append(1, x[i]);
-        else
-            break;
-    }
-    return ret;
+CText ExtractXMLTitle(const CText & x) {
+    const char * data = x.GetData();
+    size_t i = 0;
+    while (i < x.GetLength() && data[i] != 32) //everything before first space is title
+        i++;
+    return x.Sub(0, i);
 }
 
-/*! Ignores white spaces in a string.
- * \param x String, where I will skip white spaces.
- * \return Position in the string after white spaces.
+/*! Ignores white spaces in a text.
+ * \param x Text, where I will skip white spaces.
+ * \param pos Position, where to start.
+ * \return Position in the text after white spaces.
  */
-int IgnoreNextWhiteSpaces(const string & x, int pos) {
-    int i = pos;
-    while (x[i] == 32 || x[i] == 10 || x[i] == 9 || x[i] == 13) {
-        i++;
-    }
-    return i;
+size_t IgnoreNextWhiteSpaces(const CText & x, size_t pos) {
+    return CScanner::SkipWhitespaces(x.GetData(), x.GetLength(), pos);
 }
 
 /*! Removes unASCII chars from the string.
@@ -112,18 +133,64 @@ string MakeASCII(const string & x) {
     return str;
 }
 
+/*! Removes unASCII chars from the text, the text is copied only if it contains some.
+ * \param x Text, where I will remove unASCII chars.
+ * \return Text with removed characters.
+ */
+CText MakeASCII(const CText & x) {
+    if (IsASCII(x))
+        return x;
+    return CText(MakeASCII(x.GetString()));
+}
+
+/*! Reads one step of a node path like /catalog/cd[2]/title, number in brackets says which of the childs
+ * with the title is wanted (the first one without brackets).
+ * \param path The path.
+ * \param pos Position of the slash in front of the step, it is moved to the next slash (or to the end).
+ * \param title To this string is saved the title of the step.
+ * \param number To this variable is saved the number of the step.
+ * \return False, if the step is not valid.
+ */
+bool ReadPathStep(const string & path, size_t & pos, string & title, int & number) {
+    if (path[pos] != '/')
+        return false;
+    size_t end = path.find('/', pos + 1);
+    if (end == string::npos)
+        end = path.length();
+
+    title = path.substr(pos + 1, end - pos - 1);
+    number = 1;
+    size_t bracket = title.find('[');
+    if (bracket != string::npos) {
+        number = atoi(title.c_str() + bracket + 1);
+        title.erase(bracket);
+    }
+    pos = end;
+    return number >= 1;
+}
 
 /********************* OTHER *******************************/
 
 /*! Opens new xml file.
  * \param xml Pointer to old xml.
  * \param filePath New file address.
- * \param interface Pointer to graphic interface.
- * \return Pointer to new xml file.
+ * \return Pointer to new xml file (it is loaded in the background).
  */
-CXML * OpenFile(CXML * xml, string & filePath, CGUI * interface) {
+CXML * OpenFile(CXML * xml, string & filePath) {
     delete xml;
 
-    xml = new CXML(filePath, interface);
+    xml = new CXML(filePath);
     return xml;
+}
+
+/********************* THREADS *******************************/
+
+/*! Gets the count of threads, which can work on one document, it is set by XMLEDITOR_THREADS
+ * or it is the count of processors.
+ * \return The count of threads (at least 1).
+ */
+int CountProcessors() {
+    const char * variable = getenv(THREADS_VARIABLE);
+    long threads = variable && *variable ? atol(variable) : sysconf(_SC_NPROCESSORS_ONLN);
+    return threads > 1 ? (int) threads : 1;
 }
\ No newline at end of file
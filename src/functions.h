@@ -4,25 +4,36 @@
 #include <cstdlib>
 #include <string>
 
+#include "CText.h"
+
 using namespace std;
 
+///! Environment variable with the count of threads parsing or printing one document (the count of processors by default)
+#define THREADS_VARIABLE "XMLEDITOR_THREADS"
+
 ///other helping functions
 
 class CXML;
-class CGUI;
 
 //parsing validity functions
 bool IsValidTitle(const string & x);
-bool IsValidComment(const string & x);
-bool IsValidSimpleTag(const string & x);
+bool IsValidTitle(const CText & x);
+bool IsValidComment(const CText & x);
+bool IsValidSimpleTag(const CText & x);
+bool IsASCII(const CText & x);
 
 //parsing functions
-string ExtractXMLTitle(const string & x);
-int IgnoreNextWhiteSpaces(const string & x, int pos);
+CText ExtractXMLTitle(const CText & x);
+size_t IgnoreNextWhiteSpaces(const CText & x, size_t pos);
 string MakeASCII(const string & x);
+CText MakeASCII(const CText & x);
+bool ReadPathStep(const string & path, size_t & pos, string & title, int & number);
 
 //function to open the new XML file
-CXML * OpenFile(CXML * xml,string & filePath, CGUI * interface);
+CXML * OpenFile(CXML * xml,string & filePath);
+
+//count of threads for one document
+int CountProcessors();
 
 #endif	/* FUNCTIONS_H */
 
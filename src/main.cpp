@@ -25,21 +25,26 @@ int main(int argc, char** argv) {
     else
         openingXML = false;
 
+    //the file is loaded in the background, while the terminal is set up
+    CXML *xmlFile = NULL;
+    string filePath;
+    if (openingXML) {
+        filePath = argv[argc - 1];
+        xmlFile = new CXML(filePath);
+    }
+
     //init GUI
     CGUI * interface = new CGUI(openingXML);
 
-    CXML *xmlFile = NULL;
     if (openingXML) {
+        interface->AddXML(xmlFile);
         try {
-            string filePath = argv[argc - 1];
-            //open the file and show it
-            xmlFile = new CXML(filePath, interface);
-            xmlFile->Show();
-            interface->TreeInit();
+            //show the progress of the loading, then the tree
+            interface->LoadingHandler();
             interface->TreeHandler();
         } catch (const CException & e) {
             //error handler
-            e.Print(interface);
+            interface->ErrorHandler(e);
         }
     }
 
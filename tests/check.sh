@@ -0,0 +1,434 @@
+#!/bin/sh
+# Checks run by make check: outputs of the command line tool and of the editor driver
+# over the examples and over generated documents.
+#   check.sh BATCH EDITOR
+
+BATCH=$1
+EDITOR=$2
+EXAMPLES=$(dirname "$0")/../examples
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+FAILED=0
+
+ok() {
+    echo "ok      $1"
+}
+
+fail() {
+    echo "FAILED  $1"
+    FAILED=$((FAILED + 1))
+}
+
+# check NAME COMMAND... - the command has to succeed
+check() {
+    name=$1
+    shift
+    if "$@" > "$WORK/out" 2>&1; then
+        ok "$name"
+    else
+        fail "$name"
+        head -5 "$WORK/out"
+    fi
+}
+
+# same NAME FILE1 FILE2 - the files have to be the same
+same() {
+    if cmp -s "$2" "$3"; then
+        ok "$1"
+    else
+        fail "$1"
+        diff "$2" "$3" | head -5
+    fi
+}
+
+# output FILE COMMAND... - writes the standard output, the exit status and the standard error of the command
+# to the file, the count of threads and the time in the summary of the batch are left out
+output() {
+    file=$1
+    shift
+    "$@" > "$file" 2> "$WORK/err"
+    echo "exit $?" >> "$file"
+    sed 's/, [0-9]* threads*, [0-9]* ms$//' "$WORK/err" >> "$file"
+}
+
+# generate ITEMS FILE - writes a feed, its items have different lengths, so the chunks end in all kinds of tokens
+generate() {
+    awk -v items="$1" 'BEGIN {
+        print "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        print "<feed>"
+        for (i = 0; i < items; i++) {
+            pad = substr("abcdefghijklmnopqrstuvwxyz0123456789", 1, i % 37)
+            printf "  <item id=\"%d\" kind=\"k%s\">\n", i, pad
+            printf "    <title>Item %d &amp; %s</title>\n", i, pad
+            printf "    <!-- comment %s -->\n", pad
+            printf "    <link href=\"http://example.com/%d/%s\"/>\n", i, pad
+            if (i % 5 == 0)
+                printf "    <group><entry n=\"%d\">%s</entry><entry/></group>\n", i, pad
+            print "  </item>"
+        }
+        print "</feed>"
+    }' > "$2"
+}
+
+generate 300 "$WORK/small.xml"
+generate 3000 "$WORK/feed.xml"
+
+# the block scanner finds the same characters as a scan by one character, also in the last short block
+awk 'BEGIN {
+    srand(7)
+    split("< > a b = \" / ! - x", chars, " ")
+    for (i = 0; i < 20000; i++) {
+        r = int(rand() * 14)
+        if (r < 10)
+            printf "%s", chars[r + 1]
+        else if (r == 10)
+            printf " "
+        else if (r == 11)
+            printf "\t"
+        else if (r == 12)
+            printf "\r"
+        else
+            printf "\n"
+    }
+}' > "$WORK/random.txt"
+for f in "$EXAMPLES"/*.xml "$WORK/small.xml" "$WORK/random.txt"; do
+    check "scan of $(basename "$f")" "$EDITOR" scan "$f"
+done
+
+# the events of the reader make the same document as the nodes built from them
+for f in "$EXAMPLES"/*.xml "$WORK/feed.xml"; do
+    output "$WORK/events" "$EDITOR" events "$f"
+    output "$WORK/minified" "$BATCH" minify "$f"
+    same "events of $(basename "$f")" "$WORK/minified" "$WORK/events"
+done
+
+# the editor parses the mapped file, texts point to it, so the unchanged document is printed as it is in the file
+for f in "$EXAMPLES"/*.xml "$WORK/small.xml" "$WORK/feed.xml"; do
+    output "$WORK/out" "$EDITOR" print "$f" source
+    echo "exit 0" | cat "$f" - > "$WORK/expected"
+    same "source print of $(basename "$f")" "$WORK/expected" "$WORK/out"
+done
+
+# big files are parsed by more threads, the parts have to make the same tree as one thread, a part
+# with an error is parsed again by one thread, which reports the error
+generate 50000 "$WORK/parallel.xml"
+output "$WORK/one" env XMLEDITOR_THREADS=1 "$EDITOR" print "$WORK/parallel.xml" pretty
+output "$WORK/more" env XMLEDITOR_THREADS=4 "$EDITOR" print "$WORK/parallel.xml" pretty
+same "parallel parse of parallel.xml" "$WORK/one" "$WORK/more"
+sed 's|^  </item>$|  </itex>|; 200000,$!s|^  </itex>$|  </item>|' "$WORK/parallel.xml" > "$WORK/broken.xml"
+output "$WORK/one" env XMLEDITOR_THREADS=1 "$EDITOR" print "$WORK/broken.xml" pretty
+output "$WORK/more" env XMLEDITOR_THREADS=4 "$EDITOR" print "$WORK/broken.xml" pretty
+same "parallel parse of broken.xml" "$WORK/one" "$WORK/more"
+grep -q "^exit 1$" "$WORK/more" && ok "parallel parse of broken.xml fails" || fail "parallel parse of broken.xml fails"
+
+# childs of a big root are printed by more threads in parts, which have to be written in their order
+for command in print minify; do
+    output "$WORK/one" env XMLEDITOR_THREADS=1 "$BATCH" $command "$WORK/parallel.xml"
+    output "$WORK/more" env XMLEDITOR_THREADS=4 "$BATCH" $command "$WORK/parallel.xml"
+    same "parallel $command of the store of parallel.xml" "$WORK/one" "$WORK/more"
+done
+for threads in 1 4; do
+    cp "$WORK/parallel.xml" "$WORK/saved$threads.xml"
+    check "save of parallel.xml ($threads threads)" env XMLEDITOR_THREADS=$threads "$EDITOR" save "$WORK/saved$threads.xml" 100
+done
+same "parallel save of parallel.xml" "$WORK/saved1.xml" "$WORK/saved4.xml"
+same "parallel save of parallel.xml prints the edited document" "$WORK/saved4.xml.edited" "$WORK/saved4.xml.saved"
+rm "$WORK"/saved[14].xml*
+
+# the image of a big file is written, when it is opened first, the next opening reads it instead of parsing,
+# an image of a changed file or a damaged image is not used and it is written again
+mkdir "$WORK/images"
+cp "$WORK/parallel.xml" "$WORK/imaged.xml"
+output "$WORK/expected" "$EDITOR" print "$WORK/imaged.xml" pretty
+output "$WORK/out" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" print "$WORK/imaged.xml" pretty
+same "print of imaged.xml writing its image" "$WORK/expected" "$WORK/out"
+image=$(ls "$WORK"/images/*.image 2>/dev/null)
+[ -n "$image" ] && ok "image of imaged.xml is written" || fail "image of imaged.xml is written"
+touch "$WORK/stamp"
+output "$WORK/out" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" print "$WORK/imaged.xml" pretty
+same "print of imaged.xml from its image" "$WORK/expected" "$WORK/out"
+output "$WORK/out" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" print "$WORK/imaged.xml" source
+echo "exit 0" | cat "$WORK/imaged.xml" - > "$WORK/source"
+same "source print of imaged.xml from its image" "$WORK/source" "$WORK/out"
+check "rows of imaged.xml from its image" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" view "$WORK/imaged.xml"
+[ -z "$(find "$WORK/images" -newer "$WORK/stamp" -type f)" ] && ok "valid image is read" || fail "valid image is read"
+sed '4s/Item 0/Item zero/' "$WORK/parallel.xml" > "$WORK/imaged.xml"
+output "$WORK/expected" "$EDITOR" print "$WORK/imaged.xml" pretty
+output "$WORK/out" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" print "$WORK/imaged.xml" pretty
+same "print of changed imaged.xml" "$WORK/expected" "$WORK/out"
+[ -n "$(find "$WORK/images" -newer "$WORK/stamp" -type f)" ] && ok "image of changed file is written again" \
+    || fail "image of changed file is written again"
+touch "$WORK/stamp"
+dd if=/dev/zero of="$image" bs=4096 seek=100 count=1 conv=notrunc 2>/dev/null
+output "$WORK/out" env XMLEDITOR_IMAGES="$WORK/images" "$EDITOR" print "$WORK/imaged.xml" pretty
+same "print of imaged.xml with damaged image" "$WORK/expected" "$WORK/out"
+[ -n "$(find "$WORK/images" -newer "$WORK/stamp" -type f)" ] && ok "damaged image is written again" \
+    || fail "damaged image is written again"
+rm -r "$WORK/images" "$WORK/imaged.xml"
+
+# the loaded part of a document is browsed, while it is loaded, and the loading can be canceled at once
+for threads in 1 4; do
+    check "loading of parallel.xml ($threads threads)" env XMLEDITOR_THREADS=$threads "$EDITOR" load "$WORK/parallel.xml"
+    check "canceled loading of parallel.xml ($threads threads)" env XMLEDITOR_THREADS=$threads "$EDITOR" cancel "$WORK/parallel.xml"
+done
+check "loading of small.xml" "$EDITOR" load "$WORK/small.xml"
+
+# the flat store of the command line tool prints the same documents as the tree of the editor, texts
+# of compressed files are in the heap of the store
+gzip -c "$WORK/feed.xml" > "$WORK/feed.xml.gz"
+for f in "$EXAMPLES"/*.xml "$WORK/feed.xml" "$WORK/feed.xml.gz" "$WORK/parallel.xml"; do
+    output "$WORK/tree" "$EDITOR" print "$f" pretty
+    output "$WORK/store" "$BATCH" print "$f"
+    same "store print of $(basename "$f")" "$WORK/tree" "$WORK/store"
+    output "$WORK/tree" "$EDITOR" print "$f" minify
+    output "$WORK/store" "$BATCH" minify "$f"
+    same "store minify of $(basename "$f")" "$WORK/tree" "$WORK/store"
+done
+
+# names are atoms of the table of the document, the editor has the same names as the command line tool
+for f in "$EXAMPLES"/*.xml "$WORK/feed.xml"; do
+    output "$WORK/tree" "$EDITOR" names "$f"
+    output "$WORK/store" "$BATCH" stats "$f"
+    sed -n 's/.* \(names=[0-9]*\) .*/\1/p; s/^exit /exit /p' "$WORK/store" > "$WORK/expected"
+    same "names of $(basename "$f")" "$WORK/expected" "$WORK/tree"
+done
+
+# the view shows only the visible rows, all rows of the expanded document are the nodes counted by the command line tool
+for f in "$EXAMPLES"/*.xml "$WORK/small.xml" "$WORK/feed.xml"; do
+    output "$WORK/tree" "$EDITOR" view "$f"
+    output "$WORK/store" "$BATCH" stats "$f"
+    sed -n 's/.* parents=\([0-9]*\) texts=\([0-9]*\) simples=\([0-9]*\) comments=\([0-9]*\) .*/\1 \2 \3 \4/p; s/^exit /exit /p' \
+        "$WORK/store" | awk '/^exit/ { print; next } { print "rows=" $1 + $2 + $3 + $4 }' > "$WORK/expected"
+    same "view of $(basename "$f")" "$WORK/expected" "$WORK/tree"
+done
+
+# rows are cached by the nodes, the setters have to make the text of the row again
+for f in "$EXAMPLES"/*.xml "$WORK/small.xml"; do
+    check "view of edited $(basename "$f")" "$EDITOR" view "$f" 500
+done
+
+# the query of the command line tool finds the same node as the path of the editor and prints it the same way
+# queried FILE PATH - the node is printed as it is in the file, both fail, when there is no node at the path
+# (only the command line tool says why)
+queried() {
+    output "$WORK/tree" "$EDITOR" query "$1" "$2"
+    output "$WORK/store" "$BATCH" query "$2" "$1"
+    sed '/^exit /q' "$WORK/store" > "$WORK/expected"
+    same "query $2 in $(basename "$1")" "$WORK/expected" "$WORK/tree"
+}
+queried "$EXAMPLES/catalog.xml" "/CATALOG/CD[2]/TITLE"
+queried "$EXAMPLES/catalog.xml" "/CATALOG/CD[26]"
+queried "$EXAMPLES/catalog.xml" "/CATALOG/CD[27]"
+queried "$EXAMPLES/czerss.xml" "/rss/channel/item[3]"
+queried "$EXAMPLES/engrss.xml" "/rss/channel/atom:link"
+queried "$EXAMPLES/food.xml" "/breakfast_menu"
+queried "$EXAMPLES/sample.xml" "/bookstore/book[2]/author"
+queried "$WORK/feed.xml" "/feed/item[3000]"
+queried "$WORK/feed.xml" "/feed/item[1501]/group/entry[2]"
+queried "$WORK/feed.xml" "/feed/item/title/nothing"
+queried "$WORK/feed.xml.gz" "/feed/item[42]/link"
+
+# filtered nodes are found by the titles index, they have to be the elements printed by the filter
+# of the command line tool
+# filtered FILE TITLE - the editor has to filter the same count of nodes
+filtered() {
+    output "$WORK/tree" "$EDITOR" filter "$1" "$2"
+    printf "%s=%s\nexit 0\n" "$2" "$("$BATCH" filter "$2" "$1" | grep -c "<$2[ />]")" > "$WORK/expected"
+    same "filter $2 in $(basename "$1")" "$WORK/expected" "$WORK/tree"
+}
+filtered "$EXAMPLES/catalog.xml" CD
+filtered "$EXAMPLES/catalog.xml" TITLE
+filtered "$EXAMPLES/engrss.xml" item
+filtered "$EXAMPLES/food.xml" nothing
+filtered "$WORK/feed.xml" entry
+filtered "$WORK/feed.xml" link
+# nodes are inserted, renamed and deleted between the filters, the index is not built again
+for f in "$EXAMPLES"/*.xml "$WORK/small.xml"; do
+    for title in title item CD; do
+        check "filter $title in edited $(basename "$f")" "$EDITOR" filter "$f" $title 300
+    done
+done
+
+# childs of the root of a file over 64 MB are parsed, when they are expanded or printed, the document has to be
+# the same as the one of the command line tool, which parses everything, and unparsed childs are copied
+generate 300000 "$WORK/lazy.xml"
+output "$WORK/eager" "$BATCH" print "$WORK/lazy.xml"
+output "$WORK/lazy" "$EDITOR" expand "$WORK/lazy.xml" 7 pretty
+same "lazy childs of lazy.xml" "$WORK/eager" "$WORK/lazy"
+output "$WORK/lazy" "$EDITOR" expand "$WORK/lazy.xml" 7 source
+echo "exit 0" | cat "$WORK/lazy.xml" - > "$WORK/expected"
+same "source print of lazy.xml" "$WORK/expected" "$WORK/lazy"
+rm "$WORK/lazy.xml"
+
+# rows of the editor
+for seed in 1 2 3; do
+    check "rows of small.xml (seed $seed)" "$EDITOR" rows "$WORK/small.xml" $seed
+done
+for f in "$EXAMPLES"/*.xml; do
+    check "rows of $(basename "$f")" "$EDITOR" rows "$f" 1
+done
+
+# memory of deleted nodes and texts is used again by the arena
+check "churn of food.xml" "$EDITOR" churn "$EXAMPLES/food.xml" 200000
+
+# incremental save of the editor, unchanged nodes are copied from the file
+for f in "$EXAMPLES"/*.xml; do
+    base=$(basename "$f")
+    cp "$f" "$WORK/$base"
+    check "save of unchanged $base" "$EDITOR" save "$WORK/$base" 0
+    same "save of unchanged $base keeps the file" "$f" "$WORK/$base"
+    check "save of edited $base" "$EDITOR" save "$WORK/$base" 20
+    same "saved $base equals the edited one" "$WORK/$base.edited" "$WORK/$base.saved"
+done
+check "save of edited feed.xml" "$EDITOR" save "$WORK/feed.xml" 200
+same "saved feed.xml equals the edited one" "$WORK/feed.xml.edited" "$WORK/feed.xml.saved"
+# formatting of unchanged nodes is kept, a node inserted into the root adds its line and every other byte stays
+for f in "$EXAMPLES"/*.xml; do
+    base=$(basename "$f" .xml)
+    sed 's/^ */&\t /; s/></>  </g' "$f" > "$WORK/$base.odd.xml"
+    cp "$WORK/$base.odd.xml" "$WORK/$base.formatted.xml"
+    check "save of formatted $base.xml" "$EDITOR" save "$WORK/$base.odd.xml" 1
+    tr '\n' '\r' < "$WORK/$base.odd.xml" | sed 's|\r\t<inserted />||' | tr '\r' '\n' > "$WORK/$base.stripped.xml"
+    same "save of $base.xml keeps its formatting" "$WORK/$base.formatted.xml" "$WORK/$base.stripped.xml"
+done
+# edits made during the saving are saved by the next saving, which copies from the replaced file
+for f in "$EXAMPLES/catalog.xml" "$WORK/feed.xml"; do
+    base=$(basename "$f" .xml)
+    cp "$f" "$WORK/$base.resaved.xml"
+    check "second save of $base.xml" "$EDITOR" resave "$WORK/$base.resaved.xml" 50
+    same "second saved $base.xml equals the edited one" "$WORK/$base.resaved.xml.edited" "$WORK/$base.resaved.xml.saved"
+done
+# the saved file replaces the target of the link with the same permissions
+cp "$EXAMPLES/food.xml" "$WORK/target.xml"
+chmod 600 "$WORK/target.xml"
+ln -s target.xml "$WORK/link.xml"
+check "save through a link" "$EDITOR" save "$WORK/link.xml" 5
+same "saved target equals the edited one" "$WORK/link.xml.edited" "$WORK/link.xml.saved"
+[ -L "$WORK/link.xml" ] && ok "link stays a link" || fail "link stays a link"
+ls -l "$WORK/target.xml" | grep -q "^-rw------- " && ok "saved target keeps its permissions" \
+    || fail "saved target keeps its permissions"
+ls -a "$WORK" | grep -q "^\.target" && fail "temporary file is removed" || ok "temporary file is removed"
+
+# the pool of the batch, outputs have to be in the order of the files with any count of threads
+mkdir "$WORK/pool"
+cp "$EXAMPLES"/*.xml "$WORK/pool"
+i=1
+while [ $i -le 40 ]; do
+    generate $((i * i * 7)) "$WORK/pool/feed$i.xml"
+    i=$((i + 1))
+done
+generate 40000 "$WORK/pool/big.xml"
+head -c 5000 "$WORK/pool/feed20.xml" > "$WORK/pool/invalid.xml"
+gzip -c "$WORK/pool/feed30.xml" > "$WORK/pool/compressed.xml.gz"
+echo "not searched" > "$WORK/pool/notes.txt"
+ls "$WORK/pool"/feed1*.xml > "$WORK/list"
+for command in validate print minify stats "query /feed/item[3]/title" "filter entry"; do
+    output "$WORK/j1" "$BATCH" -j 1 -l "$WORK/list" $command "$WORK/pool"
+    output "$WORK/j4" "$BATCH" -j 4 -l "$WORK/list" $command "$WORK/pool"
+    same "$command with 1 and 4 threads" "$WORK/j1" "$WORK/j4"
+done
+grep -q "^exit 1$" "$WORK/j1" && ok "invalid file fails the pool" || fail "invalid file fails the pool"
+output "$WORK/j1" "$BATCH" validate "$WORK/pool"
+grep -q "compressed.xml.gz: OK$" "$WORK/j1" && ok "directory with gzip file" || fail "directory with gzip file"
+grep -q "notes.txt" "$WORK/j1" && fail "directory without other files" || ok "directory without other files"
+
+# validate, the examples are valid, the first error of the invalid documents is reported with its position,
+# the mapped file, the piped file and the loaded store have to report the same
+for f in "$EXAMPLES"/*.xml; do
+    output "$WORK/out" "$BATCH" validate "$f"
+    grep -q ": OK$" "$WORK/out" && ok "validate $(basename "$f")" || fail "validate $(basename "$f")"
+done
+# invalid DOCUMENT POSITION - the document has to be reported as invalid at the position
+invalid() {
+    printf "$1" > "$WORK/invalid.xml"
+    expected="File $WORK/invalid.xml is not a valid XML document ($2)!"
+    output "$WORK/mapped" "$BATCH" validate "$WORK/invalid.xml"
+    grep -qF "$expected" "$WORK/mapped" && ok "validate reports $2" || fail "validate reports $2"
+    cat "$WORK/invalid.xml" | output "$WORK/piped" "$BATCH" validate
+    sed "s|File - |File $WORK/invalid.xml |" "$WORK/piped" > "$WORK/named"
+    same "piped validate reports $2" "$WORK/mapped" "$WORK/named"
+    output "$WORK/loaded" "$BATCH" stats "$WORK/invalid.xml"
+    grep -qF "$expected" "$WORK/loaded" && ok "stats reports $2" || fail "stats reports $2"
+}
+invalid '<a><b></a>' 'line 1, column 7, byte 6'
+invalid '<a>\n  <b>\n  </a>\n' 'line 3, column 3, byte 12'
+invalid '<?xml version="1.0"?>\n<a>\n  <b x="1" y=2/>\n</a>\n' 'line 3, column 14, byte 39'
+invalid '<a>\n  <!-- ok -->\n  <c>text</c>\n</a>\n<a/>\n' 'line 5, column 1, byte 37'
+invalid '<a>\n  <b></b>\n' 'line 3, column 1, byte 14'
+invalid '<1a/>' 'line 1, column 1, byte 0'
+invalid '<a x="1" x="2"/>' 'line 1, column 1, byte 0'
+invalid '<a>&bogus;</a>' 'line 1, column 15, byte 14'
+invalid '' 'line 1, column 1, byte 0'
+
+# the push reader, pipes are read by chunks of 64 KiB and compressed files by buffers of 1 MiB, so the documents
+# cut at these sizes have to be reported like the mapped ones
+generate 12000 "$WORK/push.xml"
+cat "$WORK/push.xml" | output "$WORK/piped" "$BATCH" validate
+grep -q "^-: OK$" "$WORK/piped" && ok "piped validate of push.xml" || fail "piped validate of push.xml"
+for size in 65536 131072 196608 1048576 2097152; do
+    for delta in -3 -2 -1 0 1 2 3; do
+        head -c $((size + delta)) "$WORK/push.xml" > "$WORK/cut.xml"
+        output "$WORK/mapped" "$BATCH" validate "$WORK/cut.xml"
+        cat "$WORK/cut.xml" | output "$WORK/piped" "$BATCH" validate
+        sed "s|File - |File $WORK/cut.xml |" "$WORK/piped" > "$WORK/named"
+        same "piped validate of push.xml cut at $((size + delta))" "$WORK/mapped" "$WORK/named"
+    done
+done
+gzip -c "$WORK/push.xml" > "$WORK/push.xml.gz"
+output "$WORK/plain" "$BATCH" print "$WORK/push.xml"
+output "$WORK/compressed" "$BATCH" print "$WORK/push.xml.gz"
+same "print of push.xml.gz" "$WORK/plain" "$WORK/compressed"
+for delta in -1 0 1; do
+    head -c $((1048576 + delta)) "$WORK/push.xml" > "$WORK/cut.xml"
+    gzip -c "$WORK/cut.xml" > "$WORK/cut.xml.gz"
+    output "$WORK/mapped" "$BATCH" stats "$WORK/cut.xml"
+    output "$WORK/compressed" "$BATCH" stats "$WORK/cut.xml.gz"
+    sed "s|cut.xml.gz |cut.xml |" "$WORK/compressed" > "$WORK/named"
+    same "stats of push.xml.gz cut at $((1048576 + delta))" "$WORK/mapped" "$WORK/named"
+done
+
+# compressed documents, they are parsed while they are decompressed, saved ones are compressed again
+head -c 1000000 "$WORK/push.xml" | gzip -c > "$WORK/multi.xml.gz"
+tail -c +1000001 "$WORK/push.xml" | gzip -c >> "$WORK/multi.xml.gz"
+output "$WORK/compressed" "$BATCH" print "$WORK/multi.xml.gz"
+same "print of gzip with two members" "$WORK/plain" "$WORK/compressed"
+head -c 100000 "$WORK/push.xml.gz" > "$WORK/cut.xml.gz"
+output "$WORK/compressed" "$BATCH" print "$WORK/cut.xml.gz"
+grep -q "Compressed data are not complete.$" "$WORK/compressed" && ok "cut gzip fails" || fail "cut gzip fails"
+gzip -c "$WORK/pool/big.xml" > "$WORK/big.xml.gz"
+output "$WORK/plain" "$BATCH" print "$WORK/pool/big.xml"
+output "$WORK/compressed" "$BATCH" print "$WORK/big.xml.gz"
+same "print of big.xml.gz" "$WORK/plain" "$WORK/compressed"
+head -c 5000000 "$WORK/pool/big.xml" > "$WORK/cut.xml"
+gzip -c "$WORK/cut.xml" > "$WORK/cut.xml.gz"
+output "$WORK/mapped" "$BATCH" stats "$WORK/cut.xml"
+output "$WORK/compressed" "$BATCH" stats "$WORK/cut.xml.gz"
+sed "s|cut.xml.gz |cut.xml |" "$WORK/compressed" > "$WORK/named"
+same "stats of cut big.xml.gz" "$WORK/mapped" "$WORK/named"
+cp "$WORK/push.xml.gz" "$WORK/saved.xml.gz"
+check "save of edited push.xml.gz" "$EDITOR" save "$WORK/saved.xml.gz" 100
+same "saved push.xml.gz equals the edited one" "$WORK/saved.xml.gz.edited" "$WORK/saved.xml.gz.saved"
+check "saved push.xml.gz is gzip" gzip -t "$WORK/saved.xml.gz"
+
+# zstd is checked, when the batch is built with it and the zstd tool is installed
+echo "<a><b/></a>" > "$WORK/a.xml"
+if command -v zstd > /dev/null && zstd -q "$WORK/a.xml" -o "$WORK/a.xml.zst" \
+        && "$BATCH" validate "$WORK/a.xml.zst" > /dev/null 2>&1; then
+    zstd -q "$WORK/push.xml" -o "$WORK/push.xml.zst"
+    output "$WORK/plain" "$BATCH" print "$WORK/push.xml"
+    output "$WORK/compressed" "$BATCH" print "$WORK/push.xml.zst"
+    same "print of push.xml.zst" "$WORK/plain" "$WORK/compressed"
+    zstd -q "$WORK/pool/big.xml" -o "$WORK/big.xml.zst"
+    output "$WORK/plain" "$BATCH" print "$WORK/pool/big.xml"
+    output "$WORK/compressed" "$BATCH" print "$WORK/big.xml.zst"
+    same "print of big.xml.zst" "$WORK/plain" "$WORK/compressed"
+    cp "$WORK/push.xml.zst" "$WORK/saved.xml.zst"
+    check "save of edited push.xml.zst" "$EDITOR" save "$WORK/saved.xml.zst" 100
+    same "saved push.xml.zst equals the edited one" "$WORK/saved.xml.zst.edited" "$WORK/saved.xml.zst.saved"
+    check "saved push.xml.zst is zstd" zstd -tq "$WORK/saved.xml.zst"
+else
+    echo "skipped zstd"
+fi
+
+echo "$FAILED checks failed"
+[ $FAILED -eq 0 ]
@@ -0,0 +1,789 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/resource.h>
+
+#include "CXML.h"
+#include "CNode.h"
+#include "CException.h"
+#include "CMappedFile.h"
+#include "CScanner.h"
+#include "CXMLHandler.h"
+#include "CXMLReader.h"
+
+///! Count of random edits of the rows check
+#define ROWS_STEPS 2000
+///! Maximal count of nodes, from which ShowNode picks
+#define ROWS_MAX_NODES 100000
+///! Count of edits of the churn check, before the memory is measured
+#define CHURN_WARMUP 20000
+///! Maximal growth of the memory during the churn check (in kB)
+#define CHURN_MAX_GROWTH 4096
+///! Timeout of waiting for the loaded document (in ms)
+#define LOAD_WAIT 10
+
+using namespace std;
+
+/*! Driver of the checks of the editor model (run by make check), the interface is not used.
+ *   editor rows FILE SEED - random expanding, collapsing, inserting and deleting of rows,
+ *                           every row must be found by FindRow, ShowNode must show the node and the spliced
+ *                           rows must be the rows of the expanded nodes
+ *   editor save FILE EDITS   - edits the document and saves it, the document is edited again, while it is saved,
+ *                           the edited document is printed to FILE.edited and the saved one to FILE.saved
+ *   editor resave FILE EDITS - like save, but the document is saved again after the edits made during the saving
+ *   editor print FILE FORMAT - prints the loaded document to the standard output (source, pretty or minify)
+ *   editor query FILE PATH   - prints the node at the path as it is in the file like the command line tool
+ *   editor scan FILE         - the block scanner has to find the same characters as a scan by one character
+ *                           from every position of the file (the file does not have to be XML)
+ *   editor events FILE       - prints the events of the reader to the standard output like the minified document
+ *   editor expand FILE STEP FORMAT - expands every STEP-th child of the root (childs of a huge file are parsed
+ *                           then) and prints the document like print
+ *   editor churn FILE CYCLES - inserts, edits and deletes a node with texts of different lengths, the memory
+ *                           must not grow, when the freed memory is used again
+ *   editor names FILE        - checks the atoms of the titles and of the names of attributes and prints their count
+ *   editor view FILE [EDITS] - the visible rows have to be the expanded nodes printed at their depths, the shown,
+ *                           the whole expanded and the collapsed document is checked, the count of all rows is printed,
+ *                           the edits change titles, attributes, values and collapse rows, their cached texts are checked
+ *   editor load FILE         - the loaded part of the document is shown and checked, while it is loaded
+ *   editor cancel FILE       - cancels the loading at once, the loading has to fail and leave no rows
+ *   editor filter FILE TITLE [EDITS] - filters the nodes with the title, they have to be expanded with their
+ *                           ancestors and subtrees, other nodes have to be collapsed, the edits insert, rename
+ *                           and delete nodes and the nodes are filtered again after every tenth edit
+ */
+
+/*! Checks, that FindRow finds every visible row.
+ * \param xml The document.
+ * \return False, if a row was not found.
+ */
+static bool CheckRows(CXML * xml) {
+    for (int row = 0; row < xml->GetRowCount(); row++) {
+        int found = xml->FindRow(xml->GetRowNode(row));
+        if (found != row) {
+            printf("row %d was found at %d\n", row, found);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! Checks the rows of the visible subtree, every row has to show its node at its depth like the node prints it
+ * and the node has to count the rows of its subtree.
+ * \param xml The shown document.
+ * \param node Root of the subtree.
+ * \param depth Depth of the node.
+ * \param row Row of the node, the row after the subtree is returned in it.
+ * \return False, if a row is wrong.
+ */
+static bool CheckVisible(CXML * xml, CNode * node, int depth, int & row) {
+    int first = row;
+    if (row >= xml->GetRowCount() || xml->GetRowNode(row) != node) {
+        printf("row %d does not show its node\n", row);
+        return false;
+    }
+    string output;
+    node->Print(output, depth);
+    if (xml->GetRowText(row) != CText(output)) {
+        printf("row %d is \"%s\" instead of \"%s\"\n", row, xml->GetRowText(row).GetString().c_str(), output.c_str());
+        return false;
+    }
+    row++;
+    if (!node->IsCollapsed()) {
+        for (int i = 0; i < node->GetChildCount(); i++) {
+            if (!CheckVisible(xml, node->GetChild(i), depth + 1, row))
+                return false;
+        }
+    }
+    if (node->GetRowCount() != row - first) {
+        printf("node of row %d counts %d rows instead of %d\n", first, node->GetRowCount(), row - first);
+        return false;
+    }
+    return true;
+}
+
+/*! Checks, that the visible rows are the expanded part of the tree (in preorder) printed by the nodes.
+ * \param xml The shown document.
+ * \return False, if the rows are wrong.
+ */
+static bool CheckView(CXML * xml) {
+    int row = 0;
+    if (xml->GetRoot() && !CheckVisible(xml, xml->GetRoot(), 0, row))
+        return false;
+    if (row != xml->GetRowCount()) {
+        printf("%d rows instead of %d\n", xml->GetRowCount(), row);
+        return false;
+    }
+    return true;
+}
+
+/*! Collects the nodes of the subtree in preorder.
+ * \param node Root of the subtree.
+ * \param nodes The collected nodes.
+ * \param cnt Count of the collected nodes.
+ */
+static void CollectNodes(CNode * node, CNode ** nodes, int & cnt) {
+    if (cnt == ROWS_MAX_NODES)
+        return;
+    nodes[cnt++] = node;
+    for (int i = 0; i < node->GetChildCount(); i++)
+        CollectNodes(node->GetChild(i), nodes, cnt);
+}
+
+/*! Edits the rows randomly and checks them after every step.
+ * \param xml The loaded document.
+ * \param seed Seed of the random edits.
+ * \return False, if the rows are not right.
+ */
+static bool Rows(CXML * xml, int seed) {
+    CNode ** nodes = new CNode * [ROWS_MAX_NODES];
+    srand(seed);
+    xml->Show();
+    bool isOK = CheckRows(xml) && CheckView(xml);
+    for (int i = 0; i < ROWS_STEPS && isOK && xml->GetRowCount() > 0; i++) {
+        int row = rand() % xml->GetRowCount();
+        CNode * node = xml->GetRowNode(row);
+        switch (rand() % 4) {
+            case 0:
+                if (!node->HasChilds())
+                    break;
+                if (node->IsCollapsed())
+                    xml->ExpandRow(row);
+                else
+                    xml->CollapseRow(row);
+                break;
+            case 1:
+                if (node->HasChilds())
+                    xml->InsertNode(row, new (xml->GetArena()) CSimpleNode(string("inserted")));
+                break;
+            case 2:
+                if (row > 0 && rand() % 8 == 0)
+                    xml->DeleteRow(row);
+                break;
+            default:
+            {
+                int cnt = 0;
+                CollectNodes(xml->GetRoot(), nodes, cnt);
+                node = nodes[rand() % cnt];
+                row = xml->ShowNode(node);
+                if (xml->GetRowNode(row) != node) {
+                    printf("node was shown at wrong row %d\n", row);
+                    isOK = false;
+                }
+            }
+        }
+        //spliced rows have to be the rows of a fresh walk of the tree
+        isOK = isOK && CheckRows(xml) && CheckView(xml);
+    }
+    delete [] nodes;
+    return isOK;
+}
+
+/*! Prints the document with every node on its own line.
+ * \param xml The document.
+ * \param filePath Path of the printed file.
+ * \return False, if the file could not be written.
+ */
+static bool PrintPretty(CXML * xml, const string & filePath) {
+    CXMLWriter writer;
+    writer.SetFormat(WRITER_PRETTY);
+    xml->Print(writer);
+    return writer.WriteFile(filePath, NULL);
+}
+
+/*! Inserts and deletes rows in the whole document, the same edits are made for the same document.
+ * \param xml The shown document.
+ * \param edits Count of the edits.
+ */
+static void Edit(CXML * xml, int edits) {
+    for (int i = 0; i < edits && xml->GetRowCount() > 1; i++) {
+        int row = (int) ((long) i * 7919 % xml->GetRowCount());
+        CNode * node = xml->GetRowNode(row);
+        if (node->HasChilds()) {
+            xml->ExpandRow(row);
+            xml->InsertNode(row, new (xml->GetArena()) CSimpleNode(string("inserted")));
+        } else if (row > 0)
+            xml->DeleteRow(row);
+    }
+}
+
+/*! Edits and saves the document, only the edited nodes are printed again. The saved file is opened again
+ * and printed, it has to be the same as the document before the edits, which were made during the saving.
+ * \param xml The loaded document.
+ * \param filePath Path of the document.
+ * \param edits Count of the edits.
+ * \return False, if the document could not be saved.
+ */
+static bool Save(CXML * xml, string & filePath, int edits) {
+    xml->Show();
+    Edit(xml, edits);
+    if (!PrintPretty(xml, filePath + ".edited"))
+        return false;
+    xml->Save();
+    //the snapshot is serialized first, so these edits are not saved
+    Edit(xml, edits);
+    if (!xml->FinishSaving())
+        return false;
+
+    CXML saved(filePath);
+    saved.FinishLoading();
+    return PrintPretty(&saved, filePath + ".saved");
+}
+
+/*! Saves the edited document twice, the edits made during the first saving have to be saved by the second one,
+ * which copies the unchanged nodes from the file replaced by the first saving.
+ * \param xml The loaded document.
+ * \param filePath Path of the document.
+ * \param edits Count of the edits.
+ * \return False, if the document could not be saved.
+ */
+static bool Resave(CXML * xml, string & filePath, int edits) {
+    xml->Show();
+    Edit(xml, edits);
+    xml->Save();
+    Edit(xml, edits);
+    if (!PrintPretty(xml, filePath + ".edited"))
+        return false;
+    xml->Save();
+    if (!xml->FinishSaving())
+        return false;
+
+    CXML saved(filePath);
+    saved.FinishLoading();
+    return PrintPretty(&saved, filePath + ".saved");
+}
+
+/*! Prints the loaded document to the standard output.
+ * \param xml The document.
+ * \param format Name of the format (source, pretty or minify).
+ * \return False, if the format is unknown or the output could not be written.
+ */
+static bool Print(CXML * xml, const string & format) {
+    CXMLWriter writer(1);
+    if (format == "pretty")
+        writer.SetFormat(WRITER_PRETTY);
+    else if (format == "minify")
+        writer.SetFormat(WRITER_MINIFY);
+    else if (format != "source")
+        return false;
+    xml->Print(writer);
+    return writer.Close();
+}
+
+/*! Prints the node at the path as it is in the file, like the query of the command line tool.
+ * \param xml The loaded document.
+ * \param path The path from the root like /catalog/cd[2]/title.
+ * \return False, if there is not such node or the output could not be written.
+ */
+static bool Query(CXML * xml, const string & path) {
+    CNode * node = xml->FindPath(path);
+    if (node == NULL)
+        return false;
+    int depth = 0;
+    for (CNode * parent = node->GetParent(); parent; parent = parent->GetParent())
+        depth++;
+    CXMLWriter writer(1);
+    node->XMLPrint(writer, depth);
+    writer.WriteLine();
+    return writer.Close();
+}
+
+/*! Expands the rows of some childs of the root and prints the document, childs, which are not expanded,
+ * are parsed by the printing (or copied from the file in the source format).
+ * \param xml The loaded document.
+ * \param step Every step-th child of the root is expanded.
+ * \param format Name of the format (source, pretty or minify).
+ * \return False, if the document could not be printed.
+ */
+static bool Expand(CXML * xml, int step, const string & format) {
+    xml->Show();
+    CNode * root = xml->GetRoot();
+    if (root == NULL || step <= 0)
+        return false;
+    for (int i = 0; i < root->GetChildCount(); i += step) {
+        int row = xml->FindRow(root->GetChild(i));
+        if (row < 0) {
+            printf("child %d has no row\n", i);
+            return false;
+        }
+        xml->ExpandRow(row);
+    }
+    return Print(xml, format);
+}
+
+/*! Gets the maximal memory of the process used so far.
+ * \return The memory in kB.
+ */
+static long GetMaxMemory() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*! Inserts a node with a child and an attribute, renames it, shows its row and deletes it again.
+ * The texts have different lengths, so blocks of all sizes are freed and allocated.
+ * \param xml The shown document.
+ * \param cycles Count of the edits after the warm up.
+ * \return False, if the memory grew.
+ */
+static bool Churn(CXML * xml, int cycles) {
+    xml->Show();
+    if (xml->GetRoot() == NULL || !xml->GetRoot()->HasChilds())
+        return false;
+    xml->ExpandRow(0);
+    long memory = 0;
+    for (int i = 0; i < CHURN_WARMUP + cycles; i++) {
+        if (i == CHURN_WARMUP)
+            memory = GetMaxMemory();
+        string text((size_t) i * 37 % 700 + 1, 'x');
+        CNode * node = new (xml->GetArena()) CParentNode(string("churn"));
+        xml->InsertNode(0, node);
+        int row = xml->FindRow(node);
+        xml->InsertNode(row, new (xml->GetArena()) CTextNode(string("value"), text));
+        node->InsertAttribute(new (xml->GetArena()) CAttribute(string("length"), text));
+        string title = i % 2 ? "renamed" : "churned";
+        node->SetTitle(title);
+        xml->GetRowText(row);
+        xml->DeleteRow(row);
+    }
+    long growth = GetMaxMemory() - memory;
+    if (growth > CHURN_MAX_GROWTH) {
+        printf("memory grew by %ld kB\n", growth);
+        return false;
+    }
+    return true;
+}
+
+/*! Checks, that the atoms of the subtree are the atoms of their names in the table.
+ * \param node Root of the subtree.
+ * \param atoms The atom table of the document.
+ * \return False, if an atom is wrong.
+ */
+static bool CheckNames(CNode * node, const CAtomTable * atoms) {
+    //comments have no title
+    int atom = node->GetAtom();
+    if (atom >= 0 && (atoms->Get(atom).Compare(node->GetTitleText()) != 0 || atoms->Find(node->GetTitleText()) != atom)) {
+        printf("node %s has atom %d\n", node->GetTitle().c_str(), atom);
+        return false;
+    }
+    for (int i = 0; i < node->GetAttributeCount(); i++) {
+        const CAttribute * attribute = node->GetAttribute(i);
+        if (atoms->Get(attribute->GetAtom()).Compare(attribute->GetNameText()) != 0
+                || atoms->Find(attribute->GetNameText()) != attribute->GetAtom()) {
+            printf("attribute %s has atom %d\n", attribute->GetNameText().GetString().c_str(), attribute->GetAtom());
+            return false;
+        }
+    }
+    for (int i = 0; i < node->GetChildCount(); i++) {
+        if (!CheckNames(node->GetChild(i), atoms))
+            return false;
+    }
+    return true;
+}
+
+/*! Checks the atoms of the whole document, renamed nodes get the atoms of their new titles.
+ * \param xml The loaded document.
+ * \return False, if an atom is wrong.
+ */
+static bool Names(CXML * xml) {
+    CNode * root = xml->GetRoot();
+    if (root == NULL)
+        return false;
+    root->LoadAll();
+    if (!CheckNames(root, xml->GetAtoms()))
+        return false;
+    printf("names=%d\n", xml->GetAtoms()->GetCount());
+
+    //new title gets new atom, known title gets the atom of the other nodes
+    string title = "renamed-node";
+    root->SetTitle(title);
+    int renamed = root->GetAtom();
+    CNode * child = NULL;
+    for (int i = 0; i < root->GetChildCount() && child == NULL; i++) {
+        if (root->GetChild(i)->GetAtom() >= 0)
+            child = root->GetChild(i);
+    }
+    if (child == NULL)
+        return renamed == xml->GetAtoms()->GetCount() - 1 && CheckNames(root, xml->GetAtoms());
+    title = child->GetTitle();
+    root->SetTitle(title);
+    return renamed == xml->GetAtoms()->GetCount() - 1 && root->GetAtom() == child->GetAtom()
+            && CheckNames(root, xml->GetAtoms());
+}
+
+/*! Checks, that the filtered nodes are expanded with their ancestors and their subtrees and the other nodes are collapsed.
+ * \param node Root of the subtree.
+ * \param atom Atom of the filtered title, -1 if it is not in the document.
+ * \param isInside Is the subtree inside of a filtered node?
+ * \param cnt Count of the filtered nodes is added here.
+ * \return False, if a node has wrong state.
+ */
+static bool CheckFiltered(CNode * node, int atom, bool isInside, int & cnt) {
+    bool isFiltered = atom >= 0 && node->GetAtom() == atom;
+    int before = cnt;
+    if (isFiltered)
+        cnt++;
+    for (int i = 0; i < node->GetChildCount(); i++) {
+        if (!CheckFiltered(node->GetChild(i), atom, isInside || isFiltered, cnt))
+            return false;
+    }
+    bool isExpanded = isInside || cnt > before;
+    if (node->IsCollapsed() == isExpanded) {
+        printf("node %s is %s\n", node->GetAtom() >= 0 ? node->GetTitle().c_str() : "(comment)",
+                isExpanded ? "collapsed" : "expanded");
+        return false;
+    }
+    return true;
+}
+
+/*! Filters the nodes with the title and checks the rows, the count of the filtered nodes is printed.
+ * \param xml The document.
+ * \param title The filtered title.
+ * \return False, if the rows are wrong.
+ */
+static bool CheckFilter(CXML * xml, string & title) {
+    xml->Filter(title);
+    xml->Show();
+    int cnt = 0;
+    if (xml->GetRoot() && !CheckFiltered(xml->GetRoot(), xml->GetAtoms()->Find(title), false, cnt))
+        return false;
+    printf("%s=%d\n", title.c_str(), cnt);
+    return CheckRows(xml);
+}
+
+/*! Filters the title and edits the filtered rows, the titles index is kept up to date by the nodes.
+ * \param xml The loaded document.
+ * \param title The filtered title.
+ * \param edits Count of the edits.
+ * \return False, if the filtered rows are wrong.
+ */
+static bool Filter(CXML * xml, string & title, int edits) {
+    bool isOK = CheckFilter(xml, title);
+    string other = "renamed";
+    for (int i = 0; i < edits && isOK && xml->GetRowCount() > 1; i++) {
+        int row = (int) ((long) i * 7919 % xml->GetRowCount());
+        CNode * node = xml->GetRowNode(row);
+        switch (i % 4) {
+            case 0:
+                if (node->HasChilds()) {
+                    CNode * inserted = new (xml->GetArena()) CParentNode(title);
+                    xml->ExpandRow(row);
+                    xml->InsertNode(row, inserted);
+                    xml->InsertNode(xml->FindRow(inserted), new (xml->GetArena()) CTextNode(title, string("inserted")));
+                }
+                break;
+            case 1:
+                if (node->GetAtom() >= 0)
+                    node->SetTitle(title);
+                break;
+            case 2:
+                if (node->GetAtom() >= 0 && node->GetTitle() == title)
+                    node->SetTitle(other);
+                break;
+            default:
+                if (row > 0)
+                    xml->DeleteRow(row);
+        }
+        if (i % 10 == 9)
+            isOK = CheckFilter(xml, title);
+    }
+    return isOK && (edits == 0 || CheckFilter(xml, title));
+}
+
+/*! Checks the rows of the shown document, then of the whole expanded document and the collapsed one.
+ * The expanded rows are edited by the setters of the nodes and checked after every edit.
+ * \param xml The loaded document.
+ * \param edits Count of the edits.
+ * \return False, if the rows are wrong.
+ */
+static bool View(CXML * xml, int edits) {
+    xml->Show();
+    if (!CheckView(xml) || xml->GetRoot() == NULL)
+        return false;
+    xml->GetRoot()->ExpandAll();
+    xml->Show();
+    if (!CheckView(xml))
+        return false;
+    printf("rows=%d\n", xml->GetRowCount());
+
+    //the rows are cached now, every edit has to make the text of its row again
+    string edited = "edited";
+    char name[32];
+    for (int i = 0; i < edits; i++) {
+        int row = (int) ((long) i * 7919 % xml->GetRowCount());
+        CNode * node = xml->GetRowNode(row);
+        CTextNode * text = dynamic_cast<CTextNode *> (node);
+        if (node->GetAtom() < 0)
+            continue;
+        switch (i % 5) {
+            case 0:
+                node->SetTitle(edited);
+                break;
+            case 1:
+                sprintf(name, "edited%d", i);
+                node->InsertAttribute(new (xml->GetArena()) CAttribute(string(name), string("value")));
+                break;
+            case 2:
+                if (node->GetAttributeCount() > 0) {
+                    string removed = node->GetAttribute(0)->GetName();
+                    node->RemoveAttribute(removed);
+                }
+                break;
+            case 3:
+                if (text)
+                    text->SetValue(edited);
+                break;
+            default:
+                if (node->IsCollapsed())
+                    xml->ExpandRow(row);
+                else if (node->HasChilds())
+                    xml->CollapseRow(row);
+        }
+        if (!CheckView(xml))
+            return false;
+    }
+    xml->GetRoot()->CollapseAll();
+    xml->Show();
+    return CheckView(xml) && xml->GetRowCount() == 1;
+}
+
+/*! Checks the rows of the childs of the root, which were loaded since the last check.
+ * \param xml The document being loaded, its progress is owned.
+ * \param child Count of the checked childs of the root, the new count is returned in it.
+ * \param row Count of the checked rows, the new count is returned in it.
+ * \return False, if the rows are wrong.
+ */
+static bool CheckLoaded(CXML * xml, int & child, int & row) {
+    CNode * root = xml->GetProgress()->GetRoot();
+    if (root == NULL)
+        return xml->GetRowCount() == 0;
+    if (row == 0) {
+        if (xml->GetRowCount() == 0 || xml->GetRowNode(0) != root) {
+            printf("the root is not the first loaded row\n");
+            return false;
+        }
+        row = 1;
+    }
+    for (; child < xml->GetProgress()->GetComplete(); child++) {
+        if (!CheckVisible(xml, root->GetChild(child), 1, row))
+            return false;
+    }
+    if (row != xml->GetRowCount()) {
+        printf("%d loaded rows instead of %d\n", xml->GetRowCount(), row);
+        return false;
+    }
+    return true;
+}
+
+/*! Shows the loaded part of the document like the interface, while it is loaded, then the whole document.
+ * \param xml The document being loaded.
+ * \return False, if the rows are wrong.
+ */
+static bool Load(CXML * xml) {
+    CProgress * progress = xml->GetProgress();
+    bool isOK = true;
+    int child = 0, row = 0;
+    while (!progress->IsFinished()) {
+        if (!progress->TryLock(LOAD_WAIT))
+            continue;
+        if (!progress->IsFinished()) {
+            xml->ShowLoaded();
+            isOK = isOK && CheckLoaded(xml, child, row);
+        }
+        progress->Unlock();
+    }
+    xml->FinishLoading();
+    return isOK && CheckView(xml);
+}
+
+/*! Cancels the loading at once, the document has to be closed without any rows.
+ * \param xml The document being loaded.
+ * \return False, if the loading was not canceled.
+ */
+static bool Cancel(CXML * xml) {
+    xml->GetProgress()->Cancel();
+    try {
+        xml->FinishLoading();
+    } catch (const LoadingCanceledException & e) {
+        printf("canceled\n");
+        return xml->GetRowCount() == 0;
+    }
+    printf("the loading was not canceled\n");
+    return false;
+}
+
+/*! Is the character a white space for the scanner?
+ * \param c The character.
+ */
+static bool IsSpace(char c) {
+    return c == 32 || c == 10 || c == 9 || c == 13;
+}
+
+/*! Compares the block scanner with a scan by one character, the searches start at every position of the file.
+ * \param filePath Path of the file.
+ * \return False, if a search found other position.
+ */
+static bool Scan(const string & filePath) {
+    CMappedFile file(filePath);
+    const char * data = file.GetData();
+    size_t size = file.GetSize();
+    CScanner scanner(data, size);
+    //the positions are found from the end, the next ones are known then
+    size_t * opens = new size_t [size + 1];
+    size_t * closes = new size_t [size + 1];
+    size_t * texts = new size_t [size + 1];
+    opens[size] = closes[size] = texts[size] = size;
+    for (size_t pos = size; pos-- > 0;) {
+        opens[pos] = data[pos] == 60 ? pos : opens[pos + 1];
+        closes[pos] = data[pos] == 62 ? pos : closes[pos + 1];
+        texts[pos] = IsSpace(data[pos]) ? texts[pos + 1] : pos;
+    }
+
+    bool isOK = true;
+    for (size_t pos = 0; pos <= size && isOK; pos++) {
+        size_t open = scanner.FindTagStart(pos);
+        size_t close = scanner.FindTagEnd(pos);
+        size_t text = scanner.SkipWhitespaces(pos);
+        if (open != opens[pos] || close != closes[pos] || text != texts[pos]
+                || CScanner::SkipWhitespaces(data, size, pos) != texts[pos]) {
+            printf("position %lu: < at %lu (%lu), > at %lu (%lu), text at %lu (%lu)\n", (unsigned long) pos,
+                    (unsigned long) open, (unsigned long) opens[pos], (unsigned long) close, (unsigned long) closes[pos],
+                    (unsigned long) text, (unsigned long) texts[pos]);
+            isOK = false;
+        }
+    }
+    delete [] opens;
+    delete [] closes;
+    delete [] texts;
+    return isOK;
+}
+
+///! Handler, which prints the events of the reader back as the minified document.
+
+class CPrintingHandler : public CXMLHandler {
+public:
+
+    /*! Creates new handler.
+     * \param writer Writer of the document.
+     */
+    CPrintingHandler(CXMLWriter & writer) : m_writer(writer) {
+        m_isSimple = false;
+    };
+
+    virtual void VersionData(const CText & data) {
+        m_writer.Write(data);
+    };
+
+    virtual bool StartElement(const CText & title, const CAttributeList & attributes, int type) {
+        m_writer.Write("<");
+        m_writer.Write(title);
+        for (int i = 0; i < attributes.GetCount(); i++) {
+            m_writer.Write(" ");
+            m_writer.Write(attributes.GetName(i));
+            m_writer.Write("=\"");
+            m_writer.Write(attributes.GetValue(i));
+            m_writer.Write("\"");
+        }
+        m_isSimple = type == NEXT_IS_SIMPLE;
+        m_writer.Write(m_isSimple ? " />" : ">");
+        return true;
+    };
+
+    virtual void Text(const CText & value) {
+        m_writer.Write(value);
+    };
+
+    virtual void Comment(const CText & comment) {
+        m_writer.Write("<!-- ");
+        m_writer.Write(comment);
+        m_writer.Write("-->");
+    };
+
+    virtual void EndElement(const CText & title) {
+        //simple element is ended right after its start
+        if (!m_isSimple) {
+            m_writer.Write("</");
+            m_writer.Write(title);
+            m_writer.Write(">");
+        }
+        m_isSimple = false;
+    };
+protected:
+    ///! Writer of the document
+    CXMLWriter & m_writer;
+    ///! Was the last started element simple?
+    bool m_isSimple;
+};
+
+/*! Reads the file by the reader and prints its events.
+ * \param filePath Path of the file.
+ * \return False, if the output could not be written.
+ */
+static bool Events(const string & filePath) {
+    CMappedFile file(filePath);
+    CXMLWriter writer(1);
+    CPrintingHandler handler(writer);
+    CXMLReader reader(file.GetData(), file.GetSize(), filePath, &handler);
+    reader.Read();
+    writer.WriteLine();
+    return writer.Close();
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s rows FILE SEED\n       %s save FILE EDITS\n       %s resave FILE EDITS\n"
+                "       %s print FILE FORMAT\n       %s query FILE PATH\n       %s scan FILE\n       %s events FILE\n"
+                "       %s expand FILE STEP FORMAT\n"
+                "       %s churn FILE CYCLES\n       %s names FILE\n       %s view FILE [EDITS]\n"
+                "       %s load FILE\n       %s cancel FILE\n       %s filter FILE TITLE [EDITS]\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+                argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    string command = argv[1];
+    string filePath = argv[2];
+    if (command == "scan" || command == "events") {
+        try {
+            return (command == "scan" ? Scan(filePath) : Events(filePath)) ? 0 : 1;
+        } catch (const CException & e) {
+            fprintf(stderr, "%s\n", e.GetMessage().c_str());
+            return 1;
+        }
+    }
+    CXML * xml = new CXML(filePath);
+    bool isOK = false;
+    try {
+        //the loading is checked, while it runs
+        if (command != "load" && command != "cancel")
+            xml->FinishLoading();
+        if (command == "load")
+            isOK = Load(xml);
+        else if (command == "cancel")
+            isOK = Cancel(xml);
+        else if (command == "rows" && argc > 3)
+            isOK = Rows(xml, atoi(argv[3]));
+        else if (command == "save" && argc > 3)
+            isOK = Save(xml, filePath, atoi(argv[3]));
+        else if (command == "resave" && argc > 3)
+            isOK = Resave(xml, filePath, atoi(argv[3]));
+        else if (command == "print" && argc > 3)
+            isOK = Print(xml, argv[3]);
+        else if (command == "query" && argc > 3)
+            isOK = Query(xml, argv[3]);
+        else if (command == "filter" && argc > 3) {
+            string title = argv[3];
+            isOK = Filter(xml, title, argc > 4 ? atoi(argv[4]) : 0);
+        } else if (command == "view")
+            isOK = View(xml, argc > 3 ? atoi(argv[3]) : 0);
+        else if (command == "names")
+            isOK = Names(xml);
+        else if (command == "churn" && argc > 3)
+            isOK = Churn(xml, atoi(argv[3]));
+        else if (command == "expand" && argc > 4)
+            isOK = Expand(xml, atoi(argv[3]), argv[4]);
+        else
+            fprintf(stderr, "Unknown command %s\n", argv[1]);
+    } catch (const CException & e) {
+        fprintf(stderr, "%s\n", e.GetMessage().c_str());
+    }
+    delete xml;
+    return isOK ? 0 : 1;
+}